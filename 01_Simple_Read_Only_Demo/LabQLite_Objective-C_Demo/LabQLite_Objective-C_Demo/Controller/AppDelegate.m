@@ -60,11 +60,11 @@
 
 - (BOOL)setupDatabase {
     NSError *error;
-    return [LabQLiteDatabaseController activateSharedControllerWithFileFromLocalBundle:@"garden.sqlite3"
-                                                      toBeCopiedToAndUsedFromDirectory:@""
-                                                 assumingNSDocumentDirectoryAsRootPath:YES
-                                                                             overwrite:YES
-                                                                                 error:&error];
+    
+    // The demo only reads, so the bundled file is used in
+    // place rather than copied to Documents on every launch.
+    return [LabQLiteDatabaseController activateSharedControllerWithReadOnlyFileFromLocalBundle:@"garden.sqlite3"
+                                                                                         error:&error];
 }
 
 @end
@@ -0,0 +1,112 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+#pragma mark - Error Handling
+
+FOUNDATION_EXPORT NSString *const GardenDataGeneratorErrorDomain;
+
+typedef enum {
+    GardenDataGeneratorErrorSchemaNotReadable = 0,
+    GardenDataGeneratorErrorSchemaNotApplied
+} GardenDataGeneratorError;
+
+FOUNDATION_EXPORT NSString *const GardenDataGeneratorErrorMessageSchemaNotReadable;
+FOUNDATION_EXPORT NSString *const GardenDataGeneratorErrorMessageSchemaNotApplied;
+
+
+
+#pragma mark - GardenDataGenerator Class
+
+/**
+ @abstract Generates a reproducible, realistically skewed garden
+ database (plant, garden, plant_is_in_garden) at a chosen scale.
+
+ @discussion Every value is drawn from a seeded generator, so the
+ same seed and settings always produce the same database. Gardens
+ are picked for plant_is_in_garden rows with a Zipfian distribution
+ (a few gardens hold most plants), and plant.common_type is drawn,
+ also Zipfian, from a small vocabulary so that its values repeat.
+ 
+ Rows are loaded through -[LabQLiteDatabase processStatement:
+ bindableValueRows:affinityTypes:error:], which prepares each
+ INSERT once, inside one transaction on one connection with the
+ journal and syncing switched off for the load.
+ */
+@interface GardenDataGenerator : NSObject
+
+/**
+ @abstract Size of the data set. At 1.0: 1,000 plants, 100 gardens
+ and up to 10,000 plant_is_in_garden rows. Defaults to 1.0.
+ */
+@property (nonatomic) double scaleFactor;
+
+/**
+ @abstract Seed of the generator. Defaults to 1.
+ */
+@property (nonatomic) uint64_t seed;
+
+/**
+ @abstract Zipf exponent of garden popularity; 0 is uniform.
+ Defaults to 1.0.
+ */
+@property (nonatomic) double gardenSkew;
+
+/**
+ @abstract Zipf exponent of common_type frequency; 0 is uniform.
+ Defaults to 1.2.
+ */
+@property (nonatomic) double commonTypeSkew;
+
+/**
+ @abstract Bytes of pseudo-random icon_image payload per plant,
+ or zero to leave icon_image NULL. Defaults to zero.
+ */
+@property (nonatomic) NSUInteger iconImageLength;
+
+/**
+ @abstract Creates a database at the provided path (replacing any
+ file there) from the provided schema script and fills it.
+ 
+ @param databasePath Where to create the database.
+ 
+ @param schemaPath Path of garden_database.sql.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ 
+ @return The number of rows in each table, keyed by table name,
+ or nil on failure.
+ */
+- (NSDictionary *)generateDatabaseAtPath:(NSString *)databasePath
+                        fromSchemaAtPath:(NSString *)schemaPath
+                                   error:(NSError **)error;
+
+@end
@@ -0,0 +1,366 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "GardenDataGenerator.h"
+#import "LabQLiteDatabase.h"
+
+
+
+#pragma mark - Error Handling
+
+NSString *const GardenDataGeneratorErrorDomain = @"GardenDataGeneratorErrorDomain";
+
+NSString *const GardenDataGeneratorErrorMessageSchemaNotReadable = @"The schema script could not be read.";
+NSString *const GardenDataGeneratorErrorMessageSchemaNotApplied = @"The schema script could not be applied to the new database.";
+
+
+
+#pragma mark - Generation Parameters
+
+static NSUInteger const GardenDataGeneratorPlantsPerScaleUnit     = 1000;
+static NSUInteger const GardenDataGeneratorGardensPerScaleUnit    = 100;
+static NSUInteger const GardenDataGeneratorPlacementsPerScaleUnit = 10000;
+
+/**
+ @abstract Rows handed to one bulk insertion call, bounding the
+ memory held by pending values.
+ */
+static NSUInteger const GardenDataGeneratorRowsPerBatch = 10000;
+
+static NSString *const GardenDataGeneratorAdjectives[] = {
+    @"Golden", @"Silver", @"Dwarf", @"Giant", @"Creeping", @"Weeping", @"Wild", @"Sweet",
+    @"Bitter", @"Scarlet", @"Blue", @"White", @"Black", @"Spotted", @"Striped", @"Mountain",
+    @"Desert", @"Marsh", @"Winter", @"Summer"
+};
+
+static NSString *const GardenDataGeneratorNouns[] = {
+    @"Fern", @"Rose", @"Lily", @"Sage", @"Thyme", @"Basil", @"Maple", @"Willow",
+    @"Iris", @"Poppy", @"Violet", @"Aster", @"Clover", @"Mint", @"Laurel", @"Juniper",
+    @"Orchid", @"Tulip", @"Daisy", @"Hosta"
+};
+
+static NSString *const GardenDataGeneratorCommonTypes[] = {
+    @"herb", @"perennial", @"shrub", @"annual", @"tree", @"vine", @"succulent", @"grass",
+    @"bulb", @"fern", @"groundcover", @"cactus", @"aquatic", @"conifer", @"palm", @"moss",
+    @"orchid", @"bamboo", @"carnivorous", @"epiphyte", @"biennial", @"vegetable", @"fruit", @"cereal"
+};
+
+static NSString *const GardenDataGeneratorTowns[] = {
+    @"Springfield", @"Riverside", @"Fairview", @"Greenville", @"Oakdale", @"Lakeside", @"Hillcrest", @"Brookfield"
+};
+
+static NSString *const GardenDataGeneratorStreets[] = {
+    @"Elm St", @"Oak Ave", @"Maple Dr", @"Cedar Ln", @"Pine Rd", @"Birch Way", @"Walnut Ct", @"Chestnut Blvd"
+};
+
+#define GARDEN_DATA_GENERATOR_COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+
+
+#pragma mark - Seeded Randomness
+
+/**
+ @abstract xorshift64* step; state must be non-zero.
+ */
+static uint64_t GardenDataGeneratorNextRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ @abstract A uniformly distributed double in [0, 1).
+ */
+static double GardenDataGeneratorNextUniform(uint64_t *state) {
+    return (GardenDataGeneratorNextRandom(state) >> 11) * 0x1.0p-53;
+}
+
+/**
+ @abstract Cumulative distribution of a Zipf law with the provided
+ exponent over ranks 1...count. The caller frees the result.
+ */
+static double *GardenDataGeneratorCreateZipfDistribution(NSUInteger count, double exponent) {
+    double *cumulative = malloc(sizeof(double) * MAX(count, (NSUInteger)1));
+    double total = 0;
+    for (NSUInteger rank = 0; rank < count; rank++) {
+        total += 1.0 / pow((double)(rank + 1), exponent);
+        cumulative[rank] = total;
+    }
+    for (NSUInteger rank = 0; rank < count; rank++) {
+        cumulative[rank] /= total;
+    }
+    return cumulative;
+}
+
+/**
+ @abstract Draws a rank (zero-based) from a Zipf distribution
+ created by GardenDataGeneratorCreateZipfDistribution.
+ */
+static NSUInteger GardenDataGeneratorSampleZipf(const double *cumulative, NSUInteger count, uint64_t *state) {
+    double u = GardenDataGeneratorNextUniform(state);
+    NSUInteger low = 0;
+    NSUInteger high = count - 1;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (cumulative[middle] < u) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+
+
+#pragma mark - GardenDataGenerator
+
+@interface GardenDataGenerator ()
+
++ (NSString *)plantNameAtIndex:(NSUInteger)index;
+
+- (BOOL)insertRows:(NSMutableArray *)valueRows
+     withStatement:(NSString *)insertionStatement
+     affinityTypes:(NSArray *)affinityTypes
+        ofDatabase:(LabQLiteDatabase *)database
+             error:(NSError **)error;
+
+- (BOOL)fillDatabase:(LabQLiteDatabase *)database
+               error:(NSError **)error;
+
+@end
+
+@implementation GardenDataGenerator
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _scaleFactor = 1.0;
+        _seed = 1;
+        _gardenSkew = 1.0;
+        _commonTypeSkew = 1.2;
+    }
+    return self;
+}
+
++ (NSString *)plantNameAtIndex:(NSUInteger)index {
+    NSUInteger adjectives = GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorAdjectives);
+    NSUInteger nouns = GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorNouns);
+    NSString *name = [NSString stringWithFormat:@"%@ %@",
+                      GardenDataGeneratorAdjectives[index % adjectives],
+                      GardenDataGeneratorNouns[(index / adjectives) % nouns]];
+    NSUInteger variety = index / (adjectives * nouns);
+    if (variety > 0) {
+        name = [name stringByAppendingFormat:@" %lu", (unsigned long)(variety + 1)];
+    }
+    return name;
+}
+
+- (NSDictionary *)generateDatabaseAtPath:(NSString *)databasePath
+                        fromSchemaAtPath:(NSString *)schemaPath
+                                   error:(NSError **)error {
+    NSString *schema = [NSString stringWithContentsOfFile:schemaPath
+                                                 encoding:NSUTF8StringEncoding
+                                                    error:NULL];
+    if (schema == nil) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:GardenDataGeneratorErrorDomain
+                                         code:GardenDataGeneratorErrorSchemaNotReadable
+                                     userInfo:@{@"errorMessage" : GardenDataGeneratorErrorMessageSchemaNotReadable,
+                                                @"errorDetails" : @{@"schemaPath" : schemaPath}}];
+        }
+        return nil;
+    }
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    [fileManager removeItemAtPath:databasePath error:NULL];
+    [fileManager removeItemAtPath:[databasePath stringByAppendingString:@"-journal"] error:NULL];
+    
+    LabQLiteDatabase *database = [[LabQLiteDatabase alloc] initWithPath:databasePath error:error];
+    if (!database || ![database openDatabase:error]) {
+        return nil;
+    }
+    
+    // A freshly generated file has nothing to protect, so the load
+    // runs without a rollback journal or fsyncs.
+    sqlite3_exec([database database], "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF;", NULL, NULL, NULL);
+    
+    char *lowLevelErrorMessage = NULL;
+    if (sqlite3_exec([database database], [schema UTF8String], NULL, NULL, &lowLevelErrorMessage) != SQLITE_OK) {
+        if (error != nil) {
+            NSString *details = lowLevelErrorMessage ? [NSString stringWithUTF8String:lowLevelErrorMessage] : @"";
+            *error = [NSError errorWithDomain:GardenDataGeneratorErrorDomain
+                                         code:GardenDataGeneratorErrorSchemaNotApplied
+                                     userInfo:@{@"errorMessage" : GardenDataGeneratorErrorMessageSchemaNotApplied,
+                                                @"errorDetails" : @{@"lowLevelErrorMessage" : details}}];
+        }
+        sqlite3_free(lowLevelErrorMessage);
+        [database closeDatabase:NULL];
+        return nil;
+    }
+    
+    if (![database processStatement:@"BEGIN TRANSACTION" insulatedly:NO error:error]) {
+        [database closeDatabase:NULL];
+        return nil;
+    }
+    if (![self fillDatabase:database error:error] ||
+        ![database processStatement:@"COMMIT TRANSACTION" insulatedly:NO error:error]) {
+        [database processStatement:@"ROLLBACK TRANSACTION" insulatedly:NO error:NULL];
+        [database closeDatabase:NULL];
+        return nil;
+    }
+    
+    NSMutableDictionary *rowCounts = [NSMutableDictionary new];
+    for (NSString *tableName in @[@"plant", @"garden", @"plant_is_in_garden"]) {
+        NSString *countStatement = [NSString stringWithFormat:@"SELECT count(*) FROM %@", tableName];
+        NSArray *results = [database processStatement:countStatement insulatedly:NO error:error];
+        if (!results) {
+            [database closeDatabase:NULL];
+            return nil;
+        }
+        [rowCounts setObject:[[results firstObject] firstObject] forKey:tableName];
+    }
+    
+    if (![database closeDatabase:error]) {
+        return nil;
+    }
+    return rowCounts;
+}
+
+- (BOOL)insertRows:(NSMutableArray *)valueRows
+     withStatement:(NSString *)insertionStatement
+     affinityTypes:(NSArray *)affinityTypes
+        ofDatabase:(LabQLiteDatabase *)database
+             error:(NSError **)error {
+    BOOL inserted = [database processStatement:insertionStatement
+                             bindableValueRows:valueRows
+                                 affinityTypes:affinityTypes
+                                         error:error];
+    [valueRows removeAllObjects];
+    return inserted;
+}
+
+- (BOOL)fillDatabase:(LabQLiteDatabase *)database
+               error:(NSError **)error {
+    uint64_t state = (_seed ^ 0x9E3779B97F4A7C15ull) | 1;
+    double scaleFactor = MAX(_scaleFactor, 0.0);
+    NSUInteger plantCount = MAX((NSUInteger)llround(GardenDataGeneratorPlantsPerScaleUnit * scaleFactor), (NSUInteger)1);
+    NSUInteger gardenCount = MAX((NSUInteger)llround(GardenDataGeneratorGardensPerScaleUnit * scaleFactor), (NSUInteger)1);
+    NSUInteger placementCount = (NSUInteger)llround(GardenDataGeneratorPlacementsPerScaleUnit * scaleFactor);
+    NSMutableArray *valueRows = [[NSMutableArray alloc] initWithCapacity:GardenDataGeneratorRowsPerBatch];
+    
+    // Plants, with repeating, skewed common types
+    NSUInteger commonTypeCount = GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorCommonTypes);
+    double *commonTypes = GardenDataGeneratorCreateZipfDistribution(commonTypeCount, _commonTypeSkew);
+    NSArray *plantAffinities = @[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_NONE];
+    BOOL filled = YES;
+    for (NSUInteger i = 0; filled && i < plantCount; i++) {
+        @autoreleasepool {
+            NSString *commonType = GardenDataGeneratorCommonTypes[GardenDataGeneratorSampleZipf(commonTypes, commonTypeCount, &state)];
+            id iconImage = [NSNull null];
+            if (_iconImageLength > 0) {
+                NSMutableData *bytes = [NSMutableData dataWithLength:_iconImageLength];
+                uint8_t *buffer = [bytes mutableBytes];
+                for (NSUInteger b = 0; b < _iconImageLength; b += sizeof(uint64_t)) {
+                    uint64_t random = GardenDataGeneratorNextRandom(&state);
+                    memcpy(buffer + b, &random, MIN(sizeof(uint64_t), _iconImageLength - b));
+                }
+                iconImage = bytes;
+            }
+            [valueRows addObject:@[[GardenDataGenerator plantNameAtIndex:i], commonType, iconImage]];
+            if ([valueRows count] == GardenDataGeneratorRowsPerBatch || i == plantCount - 1) {
+                filled = [self insertRows:valueRows
+                            withStatement:@"INSERT INTO plant VALUES (?, ?, ?)"
+                            affinityTypes:plantAffinities
+                               ofDatabase:database
+                                    error:error];
+            }
+        }
+    }
+    free(commonTypes);
+    
+    // Gardens; names repeat across towns, addresses keep them unique
+    NSUInteger townCount = GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorTowns);
+    NSUInteger streetCount = GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorStreets);
+    NSMutableArray *gardenNames = [[NSMutableArray alloc] initWithCapacity:gardenCount];
+    NSMutableArray *gardenAddresses = [[NSMutableArray alloc] initWithCapacity:gardenCount];
+    NSArray *gardenAffinities = @[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_INTEGER];
+    for (NSUInteger g = 0; filled && g < gardenCount; g++) {
+        @autoreleasepool {
+            NSString *gardenName = [NSString stringWithFormat:@"%@ %@ Garden",
+                                    GardenDataGeneratorTowns[g % townCount],
+                                    GardenDataGeneratorNouns[(g / townCount) % GARDEN_DATA_GENERATOR_COUNT_OF(GardenDataGeneratorNouns)]];
+            NSString *address = [NSString stringWithFormat:@"%lu %@, %@",
+                                 (unsigned long)(100 + g),
+                                 GardenDataGeneratorStreets[GardenDataGeneratorNextRandom(&state) % streetCount],
+                                 GardenDataGeneratorTowns[g % townCount]];
+            // Unix epoch seconds, as in the shipped garden.sqlite3,
+            // between 2000-01-01 and 2019-12-31
+            uint64_t second = GardenDataGeneratorNextRandom(&state) % (7305ull * 86400ull);
+            NSNumber *dateAdded = [NSNumber numberWithLongLong:946684800ll + (long long)second];
+            [gardenNames addObject:gardenName];
+            [gardenAddresses addObject:address];
+            [valueRows addObject:@[gardenName, address, dateAdded]];
+            if ([valueRows count] == GardenDataGeneratorRowsPerBatch || g == gardenCount - 1) {
+                filled = [self insertRows:valueRows
+                            withStatement:@"INSERT INTO garden VALUES (?, ?, ?)"
+                            affinityTypes:gardenAffinities
+                               ofDatabase:database
+                                    error:error];
+            }
+        }
+    }
+    
+    // Placements: Zipfian gardens, uniform plants; repeated
+    // (plant, garden) pairs are dropped by the primary key
+    double *gardens = GardenDataGeneratorCreateZipfDistribution(gardenCount, _gardenSkew);
+    NSArray *placementAffinities = @[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_TEXT,
+                                     SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_INTEGER];
+    for (NSUInteger p = 0; filled && p < placementCount; p++) {
+        @autoreleasepool {
+            NSUInteger garden = GardenDataGeneratorSampleZipf(gardens, gardenCount, &state);
+            NSUInteger plant = GardenDataGeneratorNextRandom(&state) % plantCount;
+            NSNumber *countOfPlant = [NSNumber numberWithUnsignedLongLong:(1 + GardenDataGeneratorNextRandom(&state) % 50)];
+            [valueRows addObject:@[[GardenDataGenerator plantNameAtIndex:plant],
+                                   [gardenNames objectAtIndex:garden],
+                                   [gardenAddresses objectAtIndex:garden],
+                                   countOfPlant]];
+            if ([valueRows count] == GardenDataGeneratorRowsPerBatch || p == placementCount - 1) {
+                filled = [self insertRows:valueRows
+                            withStatement:@"INSERT OR IGNORE INTO plant_is_in_garden VALUES (?, ?, ?, ?)"
+                            affinityTypes:placementAffinities
+                               ofDatabase:database
+                                    error:error];
+            }
+        }
+    }
+    free(gardens);
+    
+    return filled;
+}
+
+@end
@@ -26,7 +26,7 @@ For more information, please refer to <http://unlicense.org>
  */
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 @interface LabQLiteConstants : NSObject
 
@@ -42,7 +42,21 @@ extern NSString * const SQLite3LogicalOperatorNOT;
 typedef NSString SQLite3BinaryOperator;
 extern NSString * const SQLite3BinaryOperatorEquals;     
 extern NSString * const SQLite3BinaryOperatorNotEquals;  
-extern NSString * const SQLite3BinaryOperatorLike;       
+/**
+ @discussion On TEXT-affinity stipulations whose pattern is a
+ literal prefix followed by one trailing % (e.g. `Ros%`), the
+ controller emits a `>= ? AND < ?` range instead, with the
+ collation matching LabQLiteDatabase's caseSensitiveLike, if the
+ column is declared TEXT and leads an index of that collation,
+ which the range then seeks. Other patterns and columns stay LIKE.
+ */
+extern NSString * const SQLite3BinaryOperatorLike;
+/**
+ @discussion Full-text MATCH. Only valid against a column of a
+ mappable class that declares +fullTextIndexDefinition; the
+ controller rewrites it into a probe of the table's FTS index.
+ */
+extern NSString * const SQLite3BinaryOperatorMatch;
 
 
 
@@ -101,3 +115,50 @@ extern NSString * const kConstraintFailed;
 
 extern int const LABQLITE_WRAPPER_SELECT_LIMIT_NONE;
 
+/**
+ @discussion The largest number of `?` parameters LabQLite will
+ put into a single generated statement. Matches the default
+ SQLITE_MAX_VARIABLE_NUMBER of the vendored sqlite3 amalgamation.
+ */
+extern int const LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT;
+
+/**
+ @discussion The mmap_size applied to databases opened read-only
+ by LabQLiteDatabaseController; SQLite clamps it to the file size
+ and to its compile-time SQLITE_MAX_MMAP_SIZE.
+ */
+extern long long const LABQLITE_WRAPPER_READ_ONLY_MMAP_SIZE;
+
+/**
+ @discussion How long, in milliseconds, an online backup pauses
+ between steps so that the database's own statements can take
+ their locks.
+ */
+extern int const LABQLITE_WRAPPER_BACKUP_STEP_PAUSE_MILLISECONDS;
+
+/**
+ @discussion How long, in seconds, an online backup keeps retrying
+ steps which find the database busy or locked before it gives up
+ with SQLITE_BUSY or SQLITE_LOCKED. Any step which copies pages
+ starts the wait over.
+ */
+extern NSTimeInterval const LABQLITE_WRAPPER_BACKUP_BUSY_TIMEOUT_SECONDS;
+
+/**
+ @discussion How long, in seconds, an in-memory LabQLiteDatabase
+ with deferred write-through waits after a commit before copying
+ itself to disk.
+ */
+extern NSTimeInterval const LABQLITE_WRAPPER_IN_MEMORY_FLUSH_DELAY_SECONDS;
+
+/**
+ @discussion The fewest rowids a range of a parallel scan should
+ span; smaller tables are not worth the extra connections.
+ */
+extern long long const LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION;
+
+/**
+ @discussion The fewest rows LabQLiteDatabaseController maps to
+ objects on several threads; fewer are mapped on the calling one.
+ */
+extern int const LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS;
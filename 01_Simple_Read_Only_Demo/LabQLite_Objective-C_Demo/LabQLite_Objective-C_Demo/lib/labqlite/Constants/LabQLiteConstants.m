@@ -26,7 +26,7 @@
  */
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "LabQLiteConstants.h"
 
 NSString * const SQLite3LogicalOperatorAND   = @"AND";
@@ -37,6 +37,7 @@ NSString * const SQLite3LogicalOperatorNOT   = @"NOT";
 NSString * const SQLite3BinaryOperatorEquals     = @"=";
 NSString * const SQLite3BinaryOperatorNotEquals  = @"!=";
 NSString * const SQLite3BinaryOperatorLike       = @"LIKE";
+NSString * const SQLite3BinaryOperatorMatch      = @"MATCH";
 
 
 
@@ -130,5 +131,12 @@ NSString * const kConstraintFailed = @"constraint failed";
 
 
 int const LABQLITE_WRAPPER_SELECT_LIMIT_NONE = -1;
+int const LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT = 999;
+long long const LABQLITE_WRAPPER_READ_ONLY_MMAP_SIZE = 256 * 1024 * 1024;
+int const LABQLITE_WRAPPER_BACKUP_STEP_PAUSE_MILLISECONDS = 10;
+NSTimeInterval const LABQLITE_WRAPPER_BACKUP_BUSY_TIMEOUT_SECONDS = 30.0;
+NSTimeInterval const LABQLITE_WRAPPER_IN_MEMORY_FLUSH_DELAY_SECONDS = 1.0;
+long long const LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION = 4096;
+int const LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS = 4096;
 
 
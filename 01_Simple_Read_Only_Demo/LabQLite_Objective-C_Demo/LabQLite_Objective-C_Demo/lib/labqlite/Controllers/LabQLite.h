@@ -26,9 +26,13 @@ For more information, please refer to <http://unlicense.org>
  */
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "LabQLiteDatabaseController.h"
+#import "LabQLiteShardedDatabaseController.h"
 #import "LabQLiteRow.h"
+#import "LabQLiteBlobHandle.h"
+#import "LabQLiteSeedCopier.h"
+#import "LabQLiteFullTextIndexDefinition.h"
 
 
 @interface LabQLite : NSObject
@@ -25,19 +25,64 @@ OTHER DEALINGS IN THE SOFTWARE.
 For more information, please refer to <http://unlicense.org>
  */
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "sqlite3.h"
 
 #import "LabQLiteDatabase.h"
 #import "LabQLiteStipulation.h"
 #import "LabQLiteRowMappable.h"
 #import "LabQLiteRow.h"
+#import "LabQLiteIndexDefinition.h"
+#import "LabQLiteFullTextIndexDefinition.h"
+
+/**
+ @abstract The canonical form of a key value, under which values
+ SQLite stores alike compare equal: @3, @3.0 and @"3" all become
+ @"3". Integral NSNumbers are written as integers, floating-point
+ ones with 17 significant digits; NSData is returned as is, nil
+ and NSNull become the empty string and anything else its
+ description.
+ */
+FOUNDATION_EXPORT id LabQLiteCanonicalKeyValue(id keyValue);
 
 @interface LabQLiteDatabaseController : NSObject {
     LabQLiteDatabase *_database;
     NSString *_databasePath;
 }
 
+/**
+ @abstract The number of rowid ranges large scans are split into,
+ each scanned on its own connection and thread. Zero or one (the
+ default) scans serially.
+ 
+ @discussion Applies to allRows:SQLite3RowSubclass:error: and to
+ rowsFromTable: calls without stipulations, offset or limit which
+ are either unordered or ordered by rowid. Ranges are cut evenly
+ between min(rowid) and max(rowid), and their rows are
+ concatenated in rowid order. Views, WITHOUT ROWID tables, tables
+ of fewer than LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION
+ rows per range and in-memory databases are still scanned
+ serially. A failure to read the rowid bounds fails the scan.
+ 
+ The ranges are read in separate transactions, with no shared
+ snapshot: a write committed during the scan may show in some
+ ranges and not in others. Only split scans of tables which are
+ not being written meanwhile.
+ */
+@property (nonatomic) NSUInteger parallelScanPartitionCount;
+
+/**
+ @abstract Whether large row sets are mapped to objects on several
+ threads at once. Defaults to NO.
+ 
+ @discussion When YES, results of at least
+ LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS rows are mapped by one
+ worker per active core. The -init and the property setters of the
+ mapped LabQLiteRowMappable classes then run concurrently, on
+ different objects, and must be safe to do so.
+ */
+@property (nonatomic) BOOL parallelMappingEnabled;
+
 
 
 #pragma mark - Low-level methods
@@ -186,6 +231,95 @@ For more information, please refer to <http://unlicense.org>
              insulatedly:(BOOL)openingAndClosingOfDatabaseIsAutomatic
               completion:(void (^)(NSArray *, NSError *))completion;
 
+/**
+ @abstract Processes an SQL statement, handing its results to the
+ provided block one row at a time rather than as one array.
+ 
+ @param sqlStatement The SQL statement to be processed.
+ 
+ @param bindableValues Any values that should be bound to `?` placeholders
+ in the SQL statement.
+ 
+ @param affinityTypes The column affinity types for any bindable values
+ that may have been specified.
+ 
+ @param options See LabQLiteRowEnumerationOptions. When borrowing
+ column buffers, TEXT and BLOB values are only valid inside the block.
+ 
+ @param openingAndClosingOfDatabaseIsAutomatic Whether this method should
+ open and close the low-level database automatically.
+ 
+ @param error The standard error capturing double indirection
+ pointer.
+ 
+ @param block Called once per row; set *stop to YES to end early.
+ 
+ @return Whether or not the enumeration completed or was stopped.
+ */
+- (BOOL)enumerateRowsOfStatement:(NSString *)sqlStatement
+                  bindableValues:(NSArray *)bindableValues
+                   affinityTypes:(NSArray *)affinityTypes
+                         options:(LabQLiteRowEnumerationOptions)options
+                     insulatedly:(BOOL)openingAndClosingOfDatabaseIsAutomatic
+                           error:(NSError **)error
+                      usingBlock:(void (^)(NSArray *row, BOOL *stop))block;
+
+/**
+ @abstract Copies the database to the provided path with the SQLite
+ online backup API, a few pages at a time, on a background queue.
+ 
+ @discussion The backup reads through its own connection (see
+ openConnection:error: of LabQLiteDatabase) and pauses
+ LABQLITE_WRAPPER_BACKUP_STEP_PAUSE_MILLISECONDS between steps, so
+ statements processed meanwhile only wait for the step in
+ progress; steps which find the database locked are retried for up
+ to LABQLITE_WRAPPER_BACKUP_BUSY_TIMEOUT_SECONDS, after which the
+ backup fails with SQLITE_BUSY or SQLITE_LOCKED. The
+ result is a consistent snapshot even if the database is in use,
+ unlike copying the file. A write to the database made through
+ another connection while the backup runs restarts it. The file at
+ the destination is only replaced once the backup is complete.
+ In LabQLiteDatabaseOpenModeInMemory the database is flushed to
+ its file (see flushToDisk: of LabQLiteDatabase) before the copy
+ starts, so writes awaiting a deferred write-through are included.
+ 
+ @param destinationPath The path of the backup file.
+ 
+ @param pagesPerStep The number of pages copied per step. Zero or
+ less copies every page in a single step.
+ 
+ @param progress Called on the main queue after each step with the
+ number of pages copied so far, the page count of the database and
+ the throughput so far in bytes per second. May be nil.
+ 
+ @param completion Called on the main queue once the backup
+ finished or failed. May be nil.
+ 
+ @see backupToPath:pagesPerStep:callbackQueue:progress:completion:
+ */
+- (void)backupToPath:(NSString *)destinationPath
+        pagesPerStep:(int)pagesPerStep
+            progress:(void (^)(NSUInteger pagesCopied, NSUInteger pageCount, double bytesPerSecond))progress
+          completion:(void (^)(BOOL success, NSError *error))completion;
+
+/**
+ @abstract Copies the database to the provided path as
+ backupToPath:pagesPerStep:progress:completion: does, calling back
+ on the provided queue.
+ 
+ @discussion Processes without a running main queue, such as
+ command line tools, pass a queue of their own, or nil.
+ 
+ @param callbackQueue The queue progress and completion are called
+ on. If nil, they are called on the backup's background queue as
+ soon as they happen.
+ */
+- (void)backupToPath:(NSString *)destinationPath
+        pagesPerStep:(int)pagesPerStep
+       callbackQueue:(dispatch_queue_t)callbackQueue
+            progress:(void (^)(NSUInteger pagesCopied, NSUInteger pageCount, double bytesPerSecond))progress
+          completion:(void (^)(BOOL success, NSError *error))completion;
+
 
 
 #pragma mark - Singleton Methods
@@ -250,10 +384,126 @@ For more information, please refer to <http://unlicense.org>
 + (BOOL)activateSharedControllerWithDatabasePath:(NSString *)filePath
                                            error:(NSError **)error;
 
+/**
+ @abstract Activates a global singleton shared instance of an
+ LabQLiteDatabaseController which reads the database file in the
+ main bundle in place, without copying it.
+ 
+ @discussion The file is opened immutable and memory-mapped; see
+ initWithReadOnlyDatabasePath:immutable:error:. Writes through the
+ shared controller fail with LabQLiteErrorDatabaseReadOnly, and
+ declared indexes are not created.
+ 
+ @param fileName The name of the sqlite3 database file in the
+ main bundle's resources.
+ 
+ @param error The standard error capturing double indirection
+ pointer.
+ 
+ @return Whether the activation of the shared database controller
+ was indeed successful.
+ */
++ (BOOL)activateSharedControllerWithReadOnlyFileFromLocalBundle:(NSString *)fileName
+                                                          error:(NSError **)error;
+
+/**
+ @abstract Activates a global singleton shared instance of an
+ LabQLiteDatabaseController over a writable copy of a database
+ file in the main bundle, without waiting for the copy.
+ 
+ @discussion See
+ initWithSeedDatabaseAtPath:writableCopyPath:completion:error:.
+ 
+ @param fileName The name of the sqlite3 database file in the
+ main bundle's resources.
+ 
+ @param copyPath The path the writable copy is kept at.
+ 
+ @param completion Called on the main queue once the shared
+ controller uses the writable copy, or failed to make it. May be
+ nil.
+ 
+ @param error The standard error capturing double indirection
+ pointer.
+ 
+ @return Whether the activation of the shared database controller
+ was indeed successful.
+ */
++ (BOOL)activateSharedControllerWithSeedFileFromLocalBundle:(NSString *)fileName
+                                           writableCopyPath:(NSString *)copyPath
+                                                 completion:(void (^)(BOOL success, NSError *error))completion
+                                                      error:(NSError **)error;
+
 
 
 #pragma mark - Initialization
 
+/**
+ @abstract Initializes an LabQLiteDatabaseController which only
+ reads the database at the provided path.
+ 
+ @discussion The file is opened with SQLITE_OPEN_READONLY and
+ memory-mapped up to LABQLITE_WRAPPER_READ_ONLY_MMAP_SIZE bytes.
+ If immutable, the `immutable=1` URI parameter is added too, so
+ SQLite takes no locks and looks for no journal; only pass YES
+ for files nothing will ever modify, such as those in the app
+ bundle.
+ 
+ A read-only controller never creates the indexes declared by
+ LabQLiteRowMappable classes; the file must already have those
+ its queries rely on. Every statement which would write, through
+ the insertion, update and deletion methods as well as
+ processStatement:, fails with LabQLiteErrorDatabaseReadOnly
+ before it runs.
+ 
+ @param databasePath The path to the low-level sqlite3 database file.
+ 
+ @param immutable Whether the file is known never to change.
+ 
+ @param error The standard error capturing double indirection pointer.
+ 
+ @return An initialized LabQLiteDatabaseController object.
+ */
+- (instancetype)initWithReadOnlyDatabasePath:(NSString *)databasePath
+                                   immutable:(BOOL)immutable
+                                       error:(NSError **)error;
+
+/**
+ @abstract Initializes an LabQLiteDatabaseController over a
+ writable copy of a seed database, such as one in the app bundle,
+ without blocking on the copy.
+ 
+ @discussion If the copy at copyPath was made from the seed as it
+ is now (see LabQLiteSeedCopier), it is used straight away and
+ completion is called on the main queue right after. Otherwise
+ the controller starts out reading the seed in place, opened
+ immutable as by initWithReadOnlyDatabasePath:immutable:error:,
+ while the seed is copied on a background queue, where the copy is
+ then opened and given the declared indexes. The controller
+ switches over to it atomically once no connection opened through
+ openDatabase: is left open, so a sequence of statements between
+ openDatabase: and closeDatabase: runs against one database
+ throughout, and then calls completion. Until then every write
+ fails with LabQLiteErrorDatabaseReadOnly, so writers should wait
+ for completion; any row written to an older copy is replaced
+ along with it.
+ 
+ @param seedPath The path to the seed sqlite3 database file.
+ 
+ @param copyPath The path the writable copy is kept at.
+ 
+ @param completion Called on the main queue once the controller
+ uses the writable copy, or failed to make it. May be nil.
+ 
+ @param error The standard error capturing double indirection pointer.
+ 
+ @return An initialized LabQLiteDatabaseController object.
+ */
+- (instancetype)initWithSeedDatabaseAtPath:(NSString *)seedPath
+                          writableCopyPath:(NSString *)copyPath
+                                completion:(void (^)(BOOL success, NSError *error))completion
+                                     error:(NSError **)error;
+
 /**
  @abstract Initializes an LabQLiteDatabaseController and returns it.
  
@@ -300,6 +550,43 @@ For more information, please refer to <http://unlicense.org>
                                     overwrite:(BOOL)overwrite
                                         error:(NSError **)error;
 
+/**
+ @abstract Returns every loaded class which conforms to
+ LabQLiteRowMappable and implements +indexedTableName along with
+ +indexDefinitions or +fullTextIndexDefinition.
+ 
+ @discussion The class list is gathered from the Objective-C
+ runtime once and then cached.
+ */
++ (NSArray *)mappableClassesDeclaringIndexes;
+
+/**
+ @abstract Creates the indexes declared by the provided
+ LabQLiteRowMappable classes that do not yet exist in the
+ database.
+ 
+ @discussion The existing tables and indexes are read from
+ sqlite_master first. Classes whose table does not exist in this
+ database, such as the tables of another schema or shard, are
+ skipped; if nothing is missing, no transaction is started. Missing
+ indexes are created in a single transaction which is rolled back
+ if any of them fails. Missing full-text indexes are created in
+ the same transaction, along with their sync triggers, and then
+ filled from the rows already in their tables. If the linked
+ SQLite lacks a needed full-text module, nothing is created and
+ the error is LabQLiteErrorFullTextModuleUnavailable.
+ 
+ @param classes LabQLiteRowMappable conforming classes which
+ implement +indexedTableName and +indexDefinitions or
+ +fullTextIndexDefinition.
+ 
+ @param error The standard error capturing double indirection pointer.
+ 
+ @return Whether all declared indexes exist afterwards.
+ */
+- (BOOL)createIndexesDeclaredByMappableClasses:(NSArray *)classes
+                                         error:(NSError **)error;
+
 /**
  @abstract Returns the sqlite3 database wrapper object.
  
@@ -359,6 +646,10 @@ For more information, please refer to <http://unlicense.org>
  @abstract Opens the database, processes SELECT statement, then
  closes the database.
  
+ @discussion Only the subclass's columnNames are selected, by
+ name, and each property is filled from the column of the same
+ name; columns the subclass does not map are never read.
+ 
  @param tableName The name of the table from which to extract data.
  
  @param LabQLiteRowSubclass The LabQLiteRow subclass type into which
@@ -387,6 +678,109 @@ For more information, please refer to <http://unlicense.org>
                             error:(NSError **)error;
 
 
+/**
+ @abstract Searches the full-text index of a LabQLiteRowMappable
+ class and returns the matching rows, best match first.
+ 
+ @discussion The query is probed against the index declared by
+ +fullTextIndexDefinition, in SQLite full-text query syntax (e.g.
+ `rose*` or `"climbing rose"`), then joined back to the table by
+ rowid. FTS5 indexes are ranked by bm25; FTS4 ones by the number
+ of matching phrase instances.
+ 
+ @param tableName The name of the indexed table.
+ 
+ @param LabQLiteRowSubclass The LabQLiteRowMappable class declaring
+ the full-text index, into which rows are reconstituted.
+ 
+ @param query The full-text query.
+ 
+ @param maxNumberOfRowsToReturn The maximum number of rows to return,
+ or LABQLITE_WRAPPER_SELECT_LIMIT_NONE.
+ 
+ @param error The standard error capturing double indirection pointer.
+ Set to LabQLiteErrorNoFullTextIndex if the class declares no
+ full-text index, and to LabQLiteErrorFullTextModuleUnavailable if
+ the linked SQLite lacks its module.
+ 
+ @return The matching rows as objects, best match first.
+ */
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+        asSQLite3RowsWithSubclass:(Class)LabQLiteRowSubclass
+            matchingFullTextQuery:(NSString *)query
+          maxNumberOfRowsToReturn:(NSUInteger)maxNumberOfRowsToReturn
+                            error:(NSError **)error;
+
+
+/**
+ @abstract Retrieves every row whose key column value is one of
+ the provided key values.
+
+ @discussion Rather than one SELECT per key, the key values are
+ split into batches of at most
+ LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT and each
+ batch is fetched with a single `key IN (?, ?, ...)` statement.
+ The database is opened once before the first batch and closed
+ once after the last. Keys which match no row are simply absent
+ from the returned dictionary.
+ 
+ Rows are filed under the provided key values themselves, matched
+ to the key column values read back by LabQLiteCanonicalKeyValue:
+ a row found for @3 is returned under @3 even where its key column
+ decodes as @"3", and likewise for @"3" and an integer column.
+
+ @param tableName The name of the table from which to extract data.
+
+ @param keyColumn The (primary) key column to match against.
+
+ @param keyValues The key values to look up.
+
+ @param affinity The column affinity type of the key column.
+
+ @param error The standard error capturing double indirection pointer.
+
+ @return A dictionary mapping each provided key value which was
+ found to its row (an array of column values, as returned by
+ rowsFromTable:withSpecifiedColumns:stipulations:offset:andMaxNumberOfRowsToReturn:orderedBy:error:).
+ If the key column is not unique, the last matching row wins.
+ */
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                         withKeyColumn:(NSString *)keyColumn
+                              inValues:(NSArray *)keyValues
+                              affinity:(NSNumber *)affinity
+                                 error:(NSError **)error;
+
+/**
+ @abstract Retrieves every row whose composite key matches one of
+ the provided key tuples (e.g. `garden(garden_name, address)`).
+
+ @discussion Works like rowsFromTable:withKeyColumn:inValues:affinity:error:
+ but each batch is a single statement of the form
+ `WHERE (a=? AND b=?) OR (a=? AND b=?) ...`, which SQLite answers
+ with one primary key probe per tuple.
+
+ @param tableName The name of the table from which to extract data.
+
+ @param keyColumns The columns which make up the composite key.
+
+ @param keyTuples An array of arrays; each sub-array holds one value
+ per key column, in the order of keyColumns.
+
+ @param affinities The column affinity types of the key columns.
+
+ @param error The standard error capturing double indirection pointer.
+
+ @return A dictionary mapping each provided key tuple (an NSArray)
+ which was found to its row. Key values are matched as by
+ rowsFromTable:withKeyColumn:inValues:affinity:error:.
+ */
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                        withKeyColumns:(NSArray *)keyColumns
+                         inValueTuples:(NSArray *)keyTuples
+                            affinities:(NSArray *)affinities
+                                 error:(NSError **)error;
+
+
 /**
  @abstract Populates the provided mappable object with data from its
  corresponding row in the sqlite3 database.
@@ -25,7 +25,14 @@ OTHER DEALINGS IN THE SOFTWARE.
 For more information, please refer to <http://unlicense.org>
  */
 
+#import <objc/runtime.h>
+#import <stdatomic.h>
 #import "LabQLiteDatabaseController.h"
+#import "LabQLiteMetrics.h"
+#import "LabQLiteFault.h"
+#import "LabQLiteDateCodec.h"
+#import "LabQLiteSeedCopier.h"
+#import "LabQLiteConstants.h"
 
 
 @interface LabQLiteDatabaseController(PrivateMethods)
@@ -33,30 +40,205 @@ For more information, please refer to <http://unlicense.org>
 - (NSString *)appendStipulations:(NSArray *)arrayOfStipulations 
                toSQLString:(NSString *)sqlString;
 
+- (NSString *)appendStipulations:(NSArray *)arrayOfStipulations
+                        forTable:(NSString *)tableName
+                likePrefixBounds:(NSArray *)likePrefixBounds
+                     toSQLString:(NSString *)sqlString;
+
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexDefinitionForTable:(NSString *)tableName;
+
+- (NSDictionary *)likePrefixCollationsForTable:(NSString *)tableName;
+
+- (NSArray *)likePrefixBoundsForStipulation:(LabQLiteStipulation *)stipulation
+                                   forTable:(NSString *)tableName;
+
+// One entry per stipulation: its LIKE prefix bounds, or NSNull.
+// Computed once per statement and shared by the SQL, values and
+// affinities, which must agree on the rewrite.
+- (NSArray *)likePrefixBoundsForStipulations:(NSArray *)stipulations
+                                    forTable:(NSString *)tableName;
+
+- (NSArray *)valuesForBindingFromStipulations:(NSArray *)stipulations
+                             likePrefixBounds:(NSArray *)likePrefixBounds;
+
+- (NSArray *)affinitiesForBindingFromStipulations:(NSArray *)stipulations
+                                 likePrefixBounds:(NSArray *)likePrefixBounds;
+
 - (NSString *)appendOffset:(NSUInteger)offset
          toSQLString:(NSString *)sqlString;
 
 - (NSString *)appendRowsLimitation:(NSUInteger)limit
                  toSQLString:(NSString *)sqlString;
 
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                        withKeyColumns:(NSArray *)keyColumns
+                         inValueTuples:(NSArray *)keyTuples
+                            affinities:(NSArray *)affinities
+                   unwrappingKeyTuples:(BOOL)shouldUnwrapSingleValueTuples
+                                 error:(NSError **)error;
+
+- (NSArray *)selectedColumnsForMappableClass:(Class)cls;
+
+- (NSArray *)rowidRangesForParallelScanOfTable:(NSString *)tableName
+                                         error:(NSError **)error;
+
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+             withSpecifiedColumns:(NSArray *)arrayOfAttributeNames
+                     stipulations:(NSArray *)stipulations
+                    inRowidRanges:(NSArray *)rowidRanges
+                       descending:(BOOL)descending
+                            error:(NSError **)error;
+
+- (NSMutableArray *)objectsOfMappableClass:(Class)cls
+                                  fromRows:(NSArray *)rows
+                           selectedColumns:(NSArray *)selectedColumns;
+
+@end
+
+@interface LabQLiteDatabaseController () {
+    NSUInteger _openDatabaseCount;
+    LabQLiteDatabase *_pendingDatabase;
+    NSString *_pendingDatabasePath;
+    void (^_pendingCompletion)(BOOL, NSError *);
+    NSMutableDictionary *_likePrefixCollationsByTable;
+}
+
+// Atomic, as the seed initializer switches it over from a
+// background queue.
+@property (atomic, strong) LabQLiteDatabase *database;
+
+/**
+ @abstract Switches over to the pending writable copy of a seed
+ database, if any, unless a connection opened by openDatabase:
+ is still open. Must be called within @synchronized (self).
+ */
+- (void)switchToPendingDatabaseIfIdle;
+
 @end
 
 
+id LabQLiteCanonicalKeyValue(id keyValue) {
+    if ([keyValue isKindOfClass:[NSData class]]) {
+        return keyValue;
+    }
+    if ([keyValue isKindOfClass:[NSNumber class]]) {
+        const char *type = [keyValue objCType];
+        return (strcmp(type, @encode(float)) == 0 || strcmp(type, @encode(double)) == 0)
+            ? [NSString stringWithFormat:@"%.17g", [keyValue doubleValue]]
+            : [NSString stringWithFormat:@"%lld", [keyValue longLongValue]];
+    }
+    if (keyValue == nil || keyValue == [NSNull null]) {
+        return @"";
+    }
+    return [keyValue description];
+}
+
+static NSArray *LabQLiteCanonicalKeyTuple(NSArray *keyTuple) {
+    NSMutableArray *canonicalTuple = [[NSMutableArray alloc] initWithCapacity:[keyTuple count]];
+    for (id keyValue in keyTuple) {
+        [canonicalTuple addObject:LabQLiteCanonicalKeyValue(keyValue)];
+    }
+    return canonicalTuple;
+}
+
+
+/**
+ @abstract Maps every raw row with the provided block and returns
+ the objects in row order.
+ 
+ @discussion Unless parallel, or below
+ LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS rows, the rows are
+ mapped on the calling thread. Otherwise one worker
+ per active core claims chunks of rows from a shared atomic cursor
+ until none are left, so that workers which draw cheap rows take
+ over the work others have not reached yet. Chunks are small
+ enough for about 16 per worker, which keeps every core busy when
+ row widths are skewed. Objects are written straight to their row
+ index, so no merge is needed. The block must be safe to call
+ from several threads at once.
+ */
+static NSMutableArray *LabQLiteObjectsFromRows(NSArray *rows, BOOL parallel, id (^mapRow)(NSArray *row)) {
+    NSUInteger rowCount = [rows count];
+    NSUInteger workerCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    if (!parallel || rowCount < (NSUInteger)LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS || workerCount < 2) {
+        NSMutableArray *objects = [[NSMutableArray alloc] initWithCapacity:rowCount];
+        for (NSArray *row in rows) {
+            [objects addObject:mapRow(row)];
+        }
+        return objects;
+    }
+    
+    NSUInteger chunkSize = rowCount / (workerCount * 16);
+    chunkSize = MAX(64, MIN(chunkSize, 4096));
+    NSUInteger chunkCount = (rowCount + chunkSize - 1) / chunkSize;
+    __strong id *objects = (__strong id *)calloc(rowCount, sizeof(id));
+    atomic_size_t nextChunk = 0;
+    atomic_size_t *cursor = &nextChunk;
+    dispatch_apply(workerCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        size_t chunk;
+        while ((chunk = atomic_fetch_add_explicit(cursor, 1, memory_order_relaxed)) < chunkCount) {
+            @autoreleasepool {
+                NSUInteger end = MIN((chunk + 1) * chunkSize, rowCount);
+                for (NSUInteger i = chunk * chunkSize; i < end; i++) {
+                    objects[i] = mapRow([rows objectAtIndex:i]);
+                }
+            }
+        }
+    });
+    NSMutableArray *mappedObjects = [[NSMutableArray alloc] initWithObjects:objects count:rowCount];
+    for (NSUInteger i = 0; i < rowCount; i++) {
+        objects[i] = nil;
+    }
+    free(objects);
+    return mappedObjects;
+}
+
+
 @implementation LabQLiteDatabaseController
 
+@synthesize database = _database;
+
 - (BOOL)openDatabase:(NSError **)error {
-    return [_database openDatabase:error];
+    @synchronized (self) {
+        if (![self.database openDatabase:error]) {
+            return NO;
+        }
+        _openDatabaseCount++;
+        return YES;
+    }
 }
 
 - (void)openDatabaseWithCompletionBlock:(void (^)(BOOL, NSError *))completion {
     NSError *error;
-    BOOL success = [_database openDatabase:&error];
+    BOOL success = [self openDatabase:&error];
     completion(success, error);
 }
 
 - (BOOL)closeDatabase:(NSError **)error {
-    return [_database closeDatabase:error];
+    @synchronized (self) {
+        if (![self.database closeDatabase:error]) {
+            return NO;
+        }
+        if (_openDatabaseCount > 0) _openDatabaseCount--;
+        [self switchToPendingDatabaseIfIdle];
+        return YES;
+    }
+}
 
+- (void)switchToPendingDatabaseIfIdle {
+    if (_pendingDatabase == nil || _openDatabaseCount > 0) return;
+    self.database = _pendingDatabase;
+    _databasePath = _pendingDatabasePath;
+    void (^completion)(BOOL, NSError *) = _pendingCompletion;
+    _pendingDatabase = nil;
+    _pendingDatabasePath = nil;
+    _pendingCompletion = nil;
+    [_likePrefixCollationsByTable removeAllObjects];
+    if (completion) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(YES, nil);
+        });
+    }
 }
 
 - (void)closeDatabaseWithCompletionBlock:(void (^)(BOOL, NSError *))completion {
@@ -84,6 +266,7 @@ For more information, please refer to <http://unlicense.org>
                  affinityTypes:nil
                    insulatedly:NO
                          error:error]) {
+        LabQLiteMetricsAdd(LabQLiteMetricTransactionsBegun, 1);
         return YES;
     }
     return NO;
@@ -105,6 +288,7 @@ For more information, please refer to <http://unlicense.org>
                  affinityTypes:nil
                    insulatedly:NO
                          error:error]) {
+        LabQLiteMetricsAdd(LabQLiteMetricRollbacks, 1);
         return YES;
     }
     return NO;
@@ -143,6 +327,22 @@ For more information, please refer to <http://unlicense.org>
     return results;
 }
 
+- (BOOL)enumerateRowsOfStatement:(NSString *)sqlStatement
+                  bindableValues:(NSArray *)bindableValues
+                   affinityTypes:(NSArray *)affinityTypes
+                         options:(LabQLiteRowEnumerationOptions)options
+                     insulatedly:(BOOL)openingAndClosingOfDatabaseIsAutomatic
+                           error:(NSError **)error
+                      usingBlock:(void (^)(NSArray *row, BOOL *stop))block {
+    return [self.database enumerateRowsOfStatement:sqlStatement
+                                    bindableValues:bindableValues
+                                     affinityTypes:affinityTypes
+                                           options:options
+                                       insulatedly:openingAndClosingOfDatabaseIsAutomatic
+                                             error:error
+                                        usingBlock:block];
+}
+
 - (void)processStatement:(NSString *)sqlStatement
           bindableValues:(NSArray *)bindableValues
            affinityTypes:(NSArray *)affinityTypes
@@ -151,7 +351,7 @@ For more information, please refer to <http://unlicense.org>
     NSError *error;
     NSArray *results;
     if (openingAndClosingOfDatabaseIsAutomatic) {
-        if (![self.database openDatabase:&error]) {
+        if (![self openDatabase:&error]) {
             completion(nil, error);
         }
         else {
@@ -166,7 +366,7 @@ For more information, please refer to <http://unlicense.org>
                 completion(nil, error);
             }
             else {
-                if (![self.database closeDatabase:&error]) {
+                if (![self closeDatabase:&error]) {
                     completion(nil, error);
                 }
                 else completion(results, error);
@@ -184,6 +384,144 @@ For more information, please refer to <http://unlicense.org>
     }
 }
 
+static NSError *LabQLiteBackupError(int errorCode, sqlite3 *connection, NSString *destinationPath) {
+    NSString *errorDetails = [NSString stringWithFormat:@"Backup to %@: %s",
+                              destinationPath,
+                              connection ? sqlite3_errmsg(connection) : sqlite3_errstr(errorCode)];
+    return [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                               code:errorCode
+                           userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:errorCode],
+                                      @"errorDetails" : errorDetails}];
+}
+
+- (void)backupToPath:(NSString *)destinationPath
+        pagesPerStep:(int)pagesPerStep
+            progress:(void (^)(NSUInteger, NSUInteger, double))progress
+          completion:(void (^)(BOOL, NSError *))completion {
+    [self backupToPath:destinationPath
+          pagesPerStep:pagesPerStep
+         callbackQueue:dispatch_get_main_queue()
+              progress:progress
+            completion:completion];
+}
+
+- (void)backupToPath:(NSString *)destinationPath
+        pagesPerStep:(int)pagesPerStep
+       callbackQueue:(dispatch_queue_t)callbackQueue
+            progress:(void (^)(NSUInteger, NSUInteger, double))progress
+          completion:(void (^)(BOOL, NSError *))completion {
+    LabQLiteDatabase *database = self.database;
+    int stepSize = pagesPerStep > 0 ? pagesPerStep : -1;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        NSError *error = nil;
+        sqlite3 *source = NULL;
+        sqlite3 *destination = NULL;
+        int resultCode = SQLITE_OK;
+        
+        // In memory, the file may still lack commits waiting for a
+        // deferred write-through; it is brought up to date first.
+        if (database.openMode == LabQLiteDatabaseOpenModeInMemory && ![database flushToDisk:&error]) {
+            resultCode = (int)[error code];
+        }
+        if (resultCode == SQLITE_OK && ![database openConnection:&source error:&error]) {
+            resultCode = (int)[error code];
+        }
+        if (resultCode == SQLITE_OK) {
+            resultCode = sqlite3_open([destinationPath UTF8String], &destination);
+            if (resultCode != SQLITE_OK) {
+                error = LabQLiteBackupError(resultCode, destination, destinationPath);
+                sqlite3_close(destination);
+                destination = NULL;
+            }
+            else {
+                LabQLiteMetricsAdd(LabQLiteMetricConnectionOpens, 1);
+            }
+        }
+        
+        sqlite3_backup *backup = NULL;
+        if (resultCode == SQLITE_OK) {
+            backup = sqlite3_backup_init(destination, "main", source, "main");
+            if (backup == NULL) {
+                resultCode = sqlite3_errcode(destination);
+                error = LabQLiteBackupError(resultCode, destination, destinationPath);
+            }
+        }
+        
+        if (backup != NULL) {
+            
+            // The page size only serves the throughput figure
+            int pageSize = 0;
+            sqlite3_stmt *pageSizeStatement = NULL;
+            if (sqlite3_prepare_v2(source, "PRAGMA page_size", -1, &pageSizeStatement, NULL) == SQLITE_OK &&
+                sqlite3_step(pageSizeStatement) == SQLITE_ROW) {
+                pageSize = sqlite3_column_int(pageSizeStatement, 0);
+            }
+            sqlite3_finalize(pageSizeStatement);
+            
+            NSDate *start = [NSDate date];
+            NSDate *blockedSince = nil;
+            do {
+                resultCode = sqlite3_backup_step(backup, stepSize);
+                if (resultCode == SQLITE_OK || resultCode == SQLITE_DONE) {
+                    blockedSince = nil;
+                    int pageCount = sqlite3_backup_pagecount(backup);
+                    int pagesCopied = pageCount - sqlite3_backup_remaining(backup);
+                    NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+                    double bytesPerSecond = elapsed > 0 ? (double)pagesCopied * pageSize / elapsed : 0;
+                    if (progress && callbackQueue) {
+                        dispatch_async(callbackQueue, ^{
+                            progress((NSUInteger)pagesCopied, (NSUInteger)pageCount, bytesPerSecond);
+                        });
+                    }
+                    else if (progress) {
+                        progress((NSUInteger)pagesCopied, (NSUInteger)pageCount, bytesPerSecond);
+                    }
+                }
+                else if (resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED) {
+                    if (blockedSince == nil) {
+                        blockedSince = [NSDate date];
+                    }
+                    else if (-[blockedSince timeIntervalSinceNow] >= LABQLITE_WRAPPER_BACKUP_BUSY_TIMEOUT_SECONDS) {
+                        break;
+                    }
+                }
+                if (resultCode == SQLITE_OK || resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED) {
+                    sqlite3_sleep(LABQLITE_WRAPPER_BACKUP_STEP_PAUSE_MILLISECONDS);
+                }
+            } while (resultCode == SQLITE_OK || resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED);
+            
+            int finishCode = sqlite3_backup_finish(backup);
+            if (resultCode == SQLITE_DONE) {
+                resultCode = finishCode;
+            }
+            if (resultCode != SQLITE_OK) {
+                error = LabQLiteBackupError(resultCode, destination, destinationPath);
+            }
+        }
+        
+        if (destination != NULL) {
+            sqlite3_close(destination);
+            LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+        }
+        if (source != NULL) {
+            sqlite3_close(source);
+            LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+        }
+        if (completion) {
+            BOOL succeeded = resultCode == SQLITE_OK;
+            NSError *backupError = succeeded ? nil : error;
+            if (callbackQueue) {
+                dispatch_async(callbackQueue, ^{
+                    completion(succeeded, backupError);
+                });
+            }
+            else {
+                completion(succeeded, backupError);
+            }
+        }
+    });
+}
+
 static LabQLiteDatabaseController *__sharedDatabaseController;
 
 + (LabQLiteDatabaseController *)sharedDatabaseController {
@@ -212,6 +550,111 @@ static LabQLiteDatabaseController *__sharedDatabaseController;
     return NO;
 }
 
++ (BOOL)activateSharedControllerWithReadOnlyFileFromLocalBundle:(NSString *)fileName
+                                                          error:(NSError **)error {
+    NSString *bundlePath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:fileName];
+    if (fileName == nil || ![[NSFileManager defaultManager] fileExistsAtPath:bundlePath]) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorDatabaseDoesNotExistInBundle
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageDatabaseDoesNotExistInBundle}];
+        }
+        return NO;
+    }
+    __sharedDatabaseController = [[LabQLiteDatabaseController alloc] initWithReadOnlyDatabasePath:bundlePath
+                                                                                        immutable:YES
+                                                                                            error:error];
+    if (__sharedDatabaseController != nil) return YES;
+    return NO;
+}
+
+- (instancetype)initWithReadOnlyDatabasePath:(NSString *)databasePath
+                                   immutable:(BOOL)immutable
+                                       error:(NSError **)error {
+    self = [super init];
+    if (self) {
+        _databasePath = databasePath;
+        _database = [[LabQLiteDatabase alloc] initWithPath:databasePath
+                                                  openMode:(immutable ? LabQLiteDatabaseOpenModeImmutable : LabQLiteDatabaseOpenModeReadOnly)
+                                                     error:error];
+        if (!_database) return nil;
+        _database.mmapSize = LABQLITE_WRAPPER_READ_ONLY_MMAP_SIZE;
+    }
+    return self;
+}
+
++ (BOOL)activateSharedControllerWithSeedFileFromLocalBundle:(NSString *)fileName
+                                           writableCopyPath:(NSString *)copyPath
+                                                 completion:(void (^)(BOOL, NSError *))completion
+                                                      error:(NSError **)error {
+    NSString *bundlePath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:fileName];
+    if (fileName == nil || ![[NSFileManager defaultManager] fileExistsAtPath:bundlePath]) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorDatabaseDoesNotExistInBundle
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageDatabaseDoesNotExistInBundle}];
+        }
+        return NO;
+    }
+    __sharedDatabaseController = [[LabQLiteDatabaseController alloc] initWithSeedDatabaseAtPath:bundlePath
+                                                                                writableCopyPath:copyPath
+                                                                                      completion:completion
+                                                                                           error:error];
+    if (__sharedDatabaseController != nil) return YES;
+    return NO;
+}
+
+- (instancetype)initWithSeedDatabaseAtPath:(NSString *)seedPath
+                          writableCopyPath:(NSString *)copyPath
+                                completion:(void (^)(BOOL, NSError *))completion
+                                     error:(NSError **)error {
+    if ([LabQLiteSeedCopier isCopyAtPath:copyPath currentWithSeedAtPath:seedPath]) {
+        self = [self initWithDatabasePath:copyPath error:error];
+        if (self && completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(YES, nil);
+            });
+        }
+        return self;
+    }
+    
+    // Serve reads from the seed until the copy is in place
+    self = [self initWithReadOnlyDatabasePath:seedPath immutable:YES error:error];
+    if (!self) return nil;
+    
+    __weak LabQLiteDatabaseController *weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        NSError *copyError = nil;
+        
+        // The copy is opened and indexed before it is switched
+        // to, so no statement ever sees it half ready.
+        LabQLiteDatabaseController *writableController = nil;
+        if ([LabQLiteSeedCopier copySeedAtPath:seedPath toPath:copyPath error:&copyError]) {
+            writableController = [[LabQLiteDatabaseController alloc] initWithDatabasePath:copyPath
+                                                                                    error:&copyError];
+        }
+        LabQLiteDatabaseController *strongSelf = weakSelf;
+        if (!writableController || !strongSelf) {
+            if (completion) {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    completion(NO, copyError);
+                });
+            }
+            return;
+        }
+        
+        // Statements opened through openDatabase: keep the seed
+        // until they close it; the switch then happens there.
+        @synchronized (strongSelf) {
+            strongSelf->_pendingDatabase = writableController.database;
+            strongSelf->_pendingDatabasePath = copyPath;
+            strongSelf->_pendingCompletion = completion;
+            [strongSelf switchToPendingDatabaseIfIdle];
+        }
+    });
+    return self;
+}
+
 - (instancetype)initWithDatabasePath:(NSString *)databasePath
                                error:(NSError **)error {
     self = [super init];
@@ -219,6 +662,10 @@ static LabQLiteDatabaseController *__sharedDatabaseController;
         _databasePath = databasePath;
         _database = [[LabQLiteDatabase alloc] initWithPath:databasePath error:error];
         if (!_database) return nil;
+        if (![self createIndexesDeclaredByMappableClasses:[LabQLiteDatabaseController mappableClassesDeclaringIndexes]
+                                                    error:error]) {
+            return nil;
+        }
     }
     return self;
 }
@@ -337,6 +784,10 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
             return nil;
         }
         
+        if (![self createIndexesDeclaredByMappableClasses:[LabQLiteDatabaseController mappableClassesDeclaringIndexes]
+                                                    error:error]) {
+            return nil;
+        }
     }
     return self;
 }
@@ -453,39 +904,200 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                     return nil;
                 }
             } // End of fileExists vs. overwrite condition handling
+            
+            // Bring the declared indexes of mappable classes up to date.
+            if (![self createIndexesDeclaredByMappableClasses:[LabQLiteDatabaseController mappableClassesDeclaringIndexes]
+                                                        error:error]) {
+                return nil;
+            }
         } // End of check for does database exist in bundle
     } // End of check for self not being nil.
     return self;
 }
 
-- (LabQLiteDatabase *)database {
-    return _database;
++ (NSArray *)mappableClassesDeclaringIndexes {
+    static NSArray *__mappableClassesDeclaringIndexes;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableArray *classes = [NSMutableArray new];
+        unsigned int classCount = 0;
+        Class *classList = objc_copyClassList(&classCount);
+        for (unsigned int i = 0; i < classCount; i++) {
+            Class cls = classList[i];
+            
+            // Walk the superclass chain with the runtime functions
+            // rather than messaging classes which might not be
+            // NSObject descendants.
+            BOOL conforms = NO;
+            for (Class c = cls; c != Nil && !conforms; c = class_getSuperclass(c)) {
+                conforms = class_conformsToProtocol(c, @protocol(LabQLiteRowMappable));
+            }
+            if (conforms &&
+                class_getClassMethod(cls, @selector(indexedTableName)) != NULL &&
+                (class_getClassMethod(cls, @selector(indexDefinitions)) != NULL ||
+                 class_getClassMethod(cls, @selector(fullTextIndexDefinition)) != NULL)) {
+                [classes addObject:cls];
+            }
+        }
+        free(classList);
+        __mappableClassesDeclaringIndexes = [NSArray arrayWithArray:classes];
+    });
+    return __mappableClassesDeclaringIndexes;
+}
+
+- (BOOL)createIndexesDeclaredByMappableClasses:(NSArray *)classes
+                                         error:(NSError **)error {
+    if ([classes count] == 0) return YES;
+    
+    if (![self openDatabase:error]) {
+        return NO;
+    }
+    
+    // Tables of other schemas (shards, other files) are not in
+    // this database; their classes are skipped.
+    NSArray *schemaObjects = [self processStatement:@"SELECT type, name FROM sqlite_master WHERE type IN ('index', 'table')"
+                                     bindableValues:nil
+                                      affinityTypes:nil
+                                        insulatedly:NO
+                                              error:error];
+    if (!schemaObjects) {
+        [self closeDatabase:NULL];
+        return NO;
+    }
+    NSMutableSet *existingTables = [NSMutableSet new];
+    NSMutableSet *existingNames = [NSMutableSet new];
+    for (NSArray *schemaObject in schemaObjects) {
+        NSString *name = [schemaObject objectAtIndex:1];
+        [existingNames addObject:name];
+        if ([[schemaObject objectAtIndex:0] isEqualToString:@"table"]) {
+            [existingTables addObject:name];
+        }
+    }
+    
+    // Gather the creation statements of the declared indexes
+    // which do not exist yet
+    NSMutableDictionary *statementsByIndexName = [NSMutableDictionary new];
+    NSMutableDictionary *statementsByFullTextTableName = [NSMutableDictionary new];
+    for (Class cls in classes) {
+        if (![cls conformsToProtocol:@protocol(LabQLiteRowMappable)] ||
+            ![cls respondsToSelector:@selector(indexedTableName)]) {
+            continue;
+        }
+        NSString *tableName = [cls indexedTableName];
+        if (![existingTables containsObject:tableName]) {
+            continue;
+        }
+        if ([cls respondsToSelector:@selector(indexDefinitions)]) {
+            for (LabQLiteIndexDefinition *indexDefinition in [cls indexDefinitions]) {
+                NSString *indexName = [indexDefinition indexNameForTable:tableName];
+                if ([existingNames containsObject:indexName]) continue;
+                [statementsByIndexName setObject:[indexDefinition creationStatementForTable:tableName]
+                                          forKey:indexName];
+            }
+        }
+        if ([cls respondsToSelector:@selector(fullTextIndexDefinition)]) {
+            LabQLiteFullTextIndexDefinition *fullTextIndexDefinition = [cls fullTextIndexDefinition];
+            NSString *fullTextTableName = [fullTextIndexDefinition fullTextTableNameForTable:tableName];
+            if (fullTextIndexDefinition != nil && ![existingNames containsObject:fullTextTableName]) {
+                if (![LabQLiteFullTextIndexDefinition isModuleAvailable:fullTextIndexDefinition.module]) {
+                    if (error != NULL) {
+                        *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                                     code:LabQLiteErrorFullTextModuleUnavailable
+                                                 userInfo:@{@"errorMessage" : LabQLiteErrorMessageFullTextModuleUnavailable,
+                                                            @"errorDetails" : fullTextTableName}];
+                    }
+                    [self closeDatabase:NULL];
+                    return NO;
+                }
+                [statementsByFullTextTableName setObject:[fullTextIndexDefinition creationStatementsForTable:tableName]
+                                                  forKey:fullTextTableName];
+            }
+        }
+    }
+    
+    // Create the missing ones in a single transaction. Full-text
+    // tables come with their triggers and a rebuild, in order.
+    NSMutableArray *creationStatements = [NSMutableArray arrayWithArray:[statementsByIndexName allValues]];
+    for (NSArray *fullTextStatements in [statementsByFullTextTableName allValues]) {
+        [creationStatements addObjectsFromArray:fullTextStatements];
+    }
+    BOOL creationSucceeded = YES;
+    if ([creationStatements count] > 0) {
+        creationSucceeded = [self processStatement:@"BEGIN TRANSACTION"
+                                    bindableValues:nil
+                                     affinityTypes:nil
+                                       insulatedly:NO
+                                             error:error] != nil;
+        if (creationSucceeded) {
+            LabQLiteMetricsAdd(LabQLiteMetricTransactionsBegun, 1);
+            for (NSString *creationStatement in creationStatements) {
+                if (![self processStatement:creationStatement
+                             bindableValues:nil
+                              affinityTypes:nil
+                                insulatedly:NO
+                                      error:error]) {
+                    creationSucceeded = NO;
+                    break;
+                }
+            }
+            NSString *endOfTransaction = creationSucceeded ? @"COMMIT TRANSACTION" : @"ROLLBACK TRANSACTION";
+            if (![self processStatement:endOfTransaction
+                         bindableValues:nil
+                          affinityTypes:nil
+                            insulatedly:NO
+                                  error:(creationSucceeded ? error : NULL)]) {
+                creationSucceeded = NO;
+            }
+            else if ([endOfTransaction isEqualToString:@"ROLLBACK TRANSACTION"]) {
+                LabQLiteMetricsAdd(LabQLiteMetricRollbacks, 1);
+            }
+        }
+    }
+    
+    @synchronized (self) {
+        [_likePrefixCollationsByTable removeAllObjects];
+    }
+    if (![self closeDatabase:(creationSucceeded ? error : NULL)]) {
+        return NO;
+    }
+    return creationSucceeded;
 }
 
 - (NSMutableArray *)allRows:(NSString *)tableName
          SQLite3RowSubclass:(Class)cls
                       error:(NSError **)error {
     
-    NSString *q = [NSString stringWithFormat:@"SELECT * FROM %@", tableName];
+    NSArray *selectedColumns = [self selectedColumnsForMappableClass:cls];
+    NSString *selection = selectedColumns != nil ? [selectedColumns componentsJoinedByString:@", "] : @"*";
+    NSString *q = [NSString stringWithFormat:@"SELECT %@ FROM %@", selection, tableName];
     NSMutableArray *rows;
     
-    rows = [NSMutableArray arrayWithArray:[self processStatement:q
-                                                  bindableValues:nil
-                                                   affinityTypes:nil
-                                                     insulatedly:YES
-                                                           error:error]];
+    NSError *rangeError = nil;
+    NSArray *rowidRanges = [self rowidRangesForParallelScanOfTable:tableName error:&rangeError];
+    if (rangeError != nil) {
+        if (error != NULL) *error = rangeError;
+        return nil;
+    }
+    if (rowidRanges != nil) {
+        rows = [self rowsFromTable:tableName
+              withSpecifiedColumns:selectedColumns
+                      stipulations:nil
+                     inRowidRanges:rowidRanges
+                        descending:NO
+                             error:error];
+    }
+    else {
+        rows = [NSMutableArray arrayWithArray:[self processStatement:q
+                                                      bindableValues:nil
+                                                       affinityTypes:nil
+                                                         insulatedly:YES
+                                                               error:error]];
+    }
     if (rows != nil && cls != nil) {
         if ([cls conformsToProtocol:@protocol(LabQLiteRowMappable)]) {
-            NSMutableArray *normalizedRows = [NSMutableArray new];
-            for (NSArray *array in rows) {
-                id <LabQLiteRowMappable> newRow = [[cls alloc] init];
-                for (NSString *key in [newRow propertyKeysMatchingAttributeColumns]) {
-                    [(NSObject *)newRow setValue:[array objectAtIndex:[[newRow propertyKeysMatchingAttributeColumns] indexOfObject:key]]
-                                   forKey:key];
-                }
-                [normalizedRows addObject:newRow];
-            }
-            return normalizedRows;
+            return [self objectsOfMappableClass:cls
+                                       fromRows:rows
+                                selectedColumns:selectedColumns];
         }
     }
     return rows;
@@ -500,6 +1112,32 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                             error:(NSError **)error {
     if (tableName == nil) return nil;
     else {
+        // Whole scans, unordered or in rowid order, may be split.
+        // Stipulated reads stay serial: they may seek an index,
+        // and their plan is captured, on the database's connection.
+        NSString *ordering = [[orderingAttribute stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+        BOOL orderedByRowid = [ordering isEqualToString:@"rowid"] || [ordering isEqualToString:@"rowid asc"];
+        BOOL orderedByRowidDescending = [ordering isEqualToString:@"rowid desc"];
+        if ([stipulations count] == 0 &&
+            offset == 0 &&
+            maxNumberOfRowsToReturn == (NSUInteger)LABQLITE_WRAPPER_SELECT_LIMIT_NONE &&
+            (orderingAttribute == nil || orderedByRowid || orderedByRowidDescending)) {
+            NSError *rangeError = nil;
+            NSArray *rowidRanges = [self rowidRangesForParallelScanOfTable:tableName error:&rangeError];
+            if (rangeError != nil) {
+                if (error != NULL) *error = rangeError;
+                return nil;
+            }
+            if (rowidRanges != nil) {
+                return [self rowsFromTable:tableName
+                      withSpecifiedColumns:arrayOfAttributeNames
+                              stipulations:stipulations
+                             inRowidRanges:rowidRanges
+                                descending:orderedByRowidDescending
+                                     error:error];
+            }
+        }
+        
         NSMutableArray *rows = nil;
         NSString *q = @"SELECT";
         if (arrayOfAttributeNames == nil) {
@@ -517,14 +1155,20 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
             }
         }
         q = [q stringByAppendingFormat:@" FROM %@", tableName];
-        q = [self appendStipulations:stipulations toSQLString:q];
+        NSArray *likePrefixBounds = [self likePrefixBoundsForStipulations:stipulations forTable:tableName];
+        q = [self appendStipulations:stipulations forTable:tableName likePrefixBounds:likePrefixBounds toSQLString:q];
         if (orderingAttribute) q = [q stringByAppendingFormat:@" ORDER BY %@", orderingAttribute];
         q = [self appendRowsLimitation:maxNumberOfRowsToReturn toSQLString:q];
         q = [self appendOffset:offset toSQLString:q];
         
-        NSArray *values = [LabQLiteStipulation valuesForBindingFromStipulations:stipulations];
-        NSArray *affinities = [LabQLiteStipulation affinitiesForBindingFromStipulations:stipulations];
+        NSArray *values = [self valuesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
+        NSArray *affinities = [self affinitiesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
         
+        [self.database captureQueryPlanForStatement:q
+                                          table:tableName
+                                   stipulations:stipulations
+                                 orderingColumn:orderingAttribute
+                                    insulatedly:YES];
         
         NSArray *processedStatementArray = [self processStatement:q
                                                    bindableValues:values
@@ -546,8 +1190,9 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                         orderedBy:(NSString *)orderingAttribute
                             error:(NSError **)error {
     
+    NSArray *selectedColumns = [self selectedColumnsForMappableClass:SQLite3RowMappableConformingClass];
     NSMutableArray *rows = [self rowsFromTable:tableName
-                          withSpecifiedColumns:nil
+                          withSpecifiedColumns:selectedColumns
                                   stipulations:stipulations
                                         offset:offset
                     andMaxNumberOfRowsToReturn:maxNumberOfRowsToReturn
@@ -558,21 +1203,99 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
     }
     if (SQLite3RowMappableConformingClass != nil) {
         if ([SQLite3RowMappableConformingClass conformsToProtocol:@protocol(LabQLiteRowMappable)]) {
-            NSMutableArray *normalizedRows = [NSMutableArray new];
-            for (NSArray *array in rows) {
-                id <LabQLiteRowMappable> newRow = [[SQLite3RowMappableConformingClass alloc] init];
-                for (NSString *key in [newRow propertyKeysMatchingAttributeColumns]) {
-                    [(NSObject *)newRow setValue:[array objectAtIndex:[[newRow propertyKeysMatchingAttributeColumns] indexOfObject:key]]
-                              forKey:key];
-                }
-                [normalizedRows addObject:newRow];
-            }
-            return normalizedRows;
+            return [self objectsOfMappableClass:SQLite3RowMappableConformingClass
+                                       fromRows:rows
+                                selectedColumns:selectedColumns];
         }
     }
     return nil;
 }
 
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+        asSQLite3RowsWithSubclass:(Class)SQLite3RowMappableConformingClass
+            matchingFullTextQuery:(NSString *)query
+          maxNumberOfRowsToReturn:(NSUInteger)maxNumberOfRowsToReturn
+                            error:(NSError **)error {
+    LabQLiteFullTextIndexDefinition *fullTextIndexDefinition = nil;
+    if ([SQLite3RowMappableConformingClass conformsToProtocol:@protocol(LabQLiteRowMappable)] &&
+        [SQLite3RowMappableConformingClass respondsToSelector:@selector(fullTextIndexDefinition)]) {
+        fullTextIndexDefinition = [SQLite3RowMappableConformingClass fullTextIndexDefinition];
+    }
+    if (tableName == nil || query == nil || fullTextIndexDefinition == nil) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorNoFullTextIndex
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageNoFullTextIndex}];
+        }
+        return nil;
+    }
+    if (![LabQLiteFullTextIndexDefinition isModuleAvailable:fullTextIndexDefinition.module]) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorFullTextModuleUnavailable
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageFullTextModuleUnavailable}];
+        }
+        return nil;
+    }
+    
+    // The table's own columns are qualified; the FTS table
+    // shares the names of the indexed ones.
+    NSArray *selectedColumns = [self selectedColumnsForMappableClass:SQLite3RowMappableConformingClass];
+    NSMutableArray *qualifiedColumns = [NSMutableArray new];
+    for (NSString *column in selectedColumns) {
+        [qualifiedColumns addObject:[NSString stringWithFormat:@"%@.%@", tableName, column]];
+    }
+    NSString *selection = [qualifiedColumns count] > 0 ? [qualifiedColumns componentsJoinedByString:@", "] : [tableName stringByAppendingString:@".*"];
+    NSString *ftsTable = [fullTextIndexDefinition fullTextTableNameForTable:tableName];
+    NSString *q = [NSString stringWithFormat:@"SELECT %@ FROM %@ JOIN %@ ON %@.rowid = %@.rowid WHERE %@ MATCH ? ORDER BY %@",
+                   selection, ftsTable, tableName, tableName, ftsTable, ftsTable,
+                   [fullTextIndexDefinition rankingExpressionForTable:tableName]];
+    q = [self appendRowsLimitation:maxNumberOfRowsToReturn toSQLString:q];
+    
+    NSArray *rows = [self processStatement:q
+                            bindableValues:@[query]
+                             affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT]
+                               insulatedly:YES
+                                     error:error];
+    if (!rows) {
+        return nil;
+    }
+    return [self objectsOfMappableClass:SQLite3RowMappableConformingClass
+                               fromRows:rows
+                        selectedColumns:selectedColumns];
+}
+
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                         withKeyColumn:(NSString *)keyColumn
+                              inValues:(NSArray *)keyValues
+                              affinity:(NSNumber *)affinity
+                                 error:(NSError **)error {
+    if (keyColumn == nil || affinity == nil) return nil;
+    NSMutableArray *keyTuples = [[NSMutableArray alloc] initWithCapacity:[keyValues count]];
+    for (id keyValue in keyValues) {
+        [keyTuples addObject:@[keyValue]];
+    }
+    return [self rowsFromTable:tableName
+                withKeyColumns:@[keyColumn]
+                 inValueTuples:keyTuples
+                    affinities:@[affinity]
+           unwrappingKeyTuples:YES
+                         error:error];
+}
+
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                        withKeyColumns:(NSArray *)keyColumns
+                         inValueTuples:(NSArray *)keyTuples
+                            affinities:(NSArray *)affinities
+                                 error:(NSError **)error {
+    return [self rowsFromTable:tableName
+                withKeyColumns:keyColumns
+                 inValueTuples:keyTuples
+                    affinities:affinities
+           unwrappingKeyTuples:NO
+                         error:error];
+}
+
 - (BOOL)populateMappableObject:(id <LabQLiteRowMappable>)mappableObject
                          error:(NSError **)error {
     NSArray *rowData = [self rowsFromTable:[mappableObject tableName]
@@ -621,13 +1344,16 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
 - (BOOL)insertRow:(id <LabQLiteRowMappable>)row
             error:(NSError **)error {
     NSMutableArray *bindableValues = [row valuesMatchingAttributeColumns];
-    NSString *insertionStatement = [_database insertionStatementFromSQLite3RowMappable:row];
+    NSString *insertionStatement = [self.database insertionStatementFromSQLite3RowMappable:row];
     NSArray *affinityTypes = [row columnTypesForAttributeColumns];
     BOOL processingSucceeded = [self processStatement:insertionStatement
                                        bindableValues:bindableValues
                                         affinityTypes:affinityTypes
                                           insulatedly:YES
                                                 error:error];
+    if (processingSucceeded) {
+        LabQLiteMetricsAdd(LabQLiteMetricRowsInserted, 1);
+    }
     return processingSucceeded;
 }
 
@@ -635,7 +1361,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
   completionBlock:(void(^)(BOOL success, NSError *error))completion {
     NSError *err = nil;
     NSMutableArray *bindableValues = [row valuesMatchingAttributeColumns];
-    NSString *insertionStatement = [_database insertionStatementFromSQLite3RowMappable:row];
+    NSString *insertionStatement = [self.database insertionStatementFromSQLite3RowMappable:row];
     NSArray *affinityTypes = [row columnTypesForAttributeColumns];
     BOOL processingSucceeded = [self processStatement:insertionStatement
                                        bindableValues:bindableValues
@@ -643,6 +1369,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                                           insulatedly:YES
                                                 error:&err];
     if (processingSucceeded) {
+        LabQLiteMetricsAdd(LabQLiteMetricRowsInserted, 1);
         completion(YES, err);
         NSLog(@"Error within insertRowCompletionBlock: %@", err);
         return;
@@ -675,7 +1402,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
         else {
             if ([self openDatabase:error]) {
                 for (id <LabQLiteRowMappable> row in rows) {
-                    NSString *insertionStatementFromRow = [_database insertionStatementFromSQLite3RowMappable:row];
+                    NSString *insertionStatementFromRow = [self.database insertionStatementFromSQLite3RowMappable:row];
                     
                     // Get property values based on property name as string
                     // using KVC
@@ -690,6 +1417,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                                           error:error]) {
                         return NO;
                     }
+                    LabQLiteMetricsAdd(LabQLiteMetricRowsInserted, 1);
                 }                    
                 if ([self closeDatabase:error]) {
                     return YES;
@@ -731,7 +1459,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
             
             if (assumedToBeOpen) {
                 for (id <LabQLiteRowMappable> row in rows) {
-                    NSString *insertionStatementFromRow = [_database insertionStatementFromSQLite3RowMappable:row];
+                    NSString *insertionStatementFromRow = [self.database insertionStatementFromSQLite3RowMappable:row];
                     NSArray *bindableValues = [LabQLiteStipulation valuesForBindingFromStipulations:[row SQLiteStipulationsForMapping]];
                     NSArray *affinities = [LabQLiteStipulation affinitiesForBindingFromStipulations:[row SQLiteStipulationsForMapping]];
                     if (![self processStatement:insertionStatementFromRow
@@ -741,6 +1469,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                                           error:error]) {
                         return NO;
                     }
+                    LabQLiteMetricsAdd(LabQLiteMetricRowsInserted, 1);
                 }
             }
             
@@ -817,6 +1546,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                 [errors addObject:savePointError];
             }
             else {
+                LabQLiteMetricsAdd(LabQLiteMetricTransactionsBegun, 1);
                 // For every mappable conformist, attempt
                 // to insert it into its table.
                 for (id <LabQLiteRowMappable>row in SQLite3Rows) {
@@ -825,7 +1555,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                     NSError *singleRowInsertionError;
                     
                     // Gather data needed for insertion from delegate methods
-                    NSString *insertionStatementFromRow = [_database insertionStatementFromSQLite3RowMappable:row];
+                    NSString *insertionStatementFromRow = [self.database insertionStatementFromSQLite3RowMappable:row];
                     
                     // ...extract information from stipulations for mapping
                     // on the current row:
@@ -851,6 +1581,7 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
                         [errors addObject:singleRowInsertionError];
                         break;
                     }
+                    LabQLiteMetricsAdd(LabQLiteMetricRowsInserted, 1);
                 }
                 
                 // If everything is a success so far, commit.
@@ -900,9 +1631,15 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
     }
     else {
         NSString *q = [NSString stringWithFormat:@"DELETE FROM %@", tableName];
-        q = [self appendStipulations:stipulations toSQLString:q];
-        NSArray *bindableValues = [LabQLiteStipulation valuesForBindingFromStipulations:stipulations];
-        NSArray *affinities = [LabQLiteStipulation affinitiesForBindingFromStipulations:stipulations];
+        NSArray *likePrefixBounds = [self likePrefixBoundsForStipulations:stipulations forTable:tableName];
+        q = [self appendStipulations:stipulations forTable:tableName likePrefixBounds:likePrefixBounds toSQLString:q];
+        NSArray *bindableValues = [self valuesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
+        NSArray *affinities = [self affinitiesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
+        [self.database captureQueryPlanForStatement:q
+                                          table:tableName
+                                   stipulations:stipulations
+                                 orderingColumn:nil
+                                    insulatedly:YES];
         if([self processStatement:q
                    bindableValues:bindableValues
                     affinityTypes:affinities
@@ -968,25 +1705,35 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
     // for this update query
     [bindableValues addObjectsFromArray:values];
     
-    for (LabQLiteStipulation *s in stipulations) {
-        [bindableValues addObject:s.value];
-    }
+    NSArray *likePrefixBounds = [self likePrefixBoundsForStipulations:stipulations
+                                                             forTable:[rowObject tableName]];
+    [bindableValues addObjectsFromArray:[self valuesForBindingFromStipulations:stipulations
+                                                              likePrefixBounds:likePrefixBounds]];
     
     // Whew! Finally... all values are in the list to
     // be bound to SQLite parameters in the query
     q = [self appendStipulations:stipulations
+                        forTable:[rowObject tableName]
+                likePrefixBounds:likePrefixBounds
                      toSQLString:q];
     
     // Get affinities so that bindables may be bound
     // by the low-level library
     
     NSArray *columnAffinities = [newRowObject columnTypesForAttributeColumns];
-    NSArray *stipulationAffinities = [LabQLiteStipulation affinitiesForBindingFromStipulations:stipulations];
+    NSArray *stipulationAffinities = [self affinitiesForBindingFromStipulations:stipulations
+                                                               likePrefixBounds:likePrefixBounds];
     
     NSMutableArray *affinities = [NSMutableArray new];
     [affinities addObjectsFromArray:columnAffinities];
     [affinities addObjectsFromArray:stipulationAffinities];
     
+    [self.database captureQueryPlanForStatement:q
+                                      table:[rowObject tableName]
+                               stipulations:stipulations
+                             orderingColumn:nil
+                                insulatedly:YES];
+    
     // Ready to process the update!
     [self processStatement:q
             bindableValues:bindableValues
@@ -1002,6 +1749,20 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
 #pragma Private Methods
          
 - (NSString *)appendStipulations:(NSArray *)stipulations toSQLString:(NSString *)sqlString {
+    return [self appendStipulations:stipulations
+                           forTable:nil
+                   likePrefixBounds:[self likePrefixBoundsForStipulations:stipulations forTable:nil]
+                        toSQLString:sqlString];
+}
+
+- (NSString *)appendStipulations:(NSArray *)stipulations
+                        forTable:(NSString *)tableName
+                likePrefixBounds:(NSArray *)likePrefixBounds
+                     toSQLString:(NSString *)sqlString {
+    LabQLiteFullTextIndexDefinition *fullTextIndexDefinition = nil;
+    if (tableName != nil) {
+        fullTextIndexDefinition = [LabQLiteDatabaseController fullTextIndexDefinitionForTable:tableName];
+    }
     if (stipulations != nil) {
         for (int i = 0; i < [stipulations count]; i++) {
             
@@ -1023,7 +1784,23 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
             else {
                 sqlString = [sqlString stringByAppendingFormat:@" %@", precedingLogicalOperator];
             }
-            if ([binaryOperator compare:SQLite3BinaryOperatorLike] == NSOrderedSame) {
+            if ([likePrefixBounds objectAtIndex:i] != [NSNull null]) {
+                // A range over the prefix can seek an index whose
+                // collation matches the case sensitivity of LIKE.
+                NSString *collation = self.database.caseSensitiveLike ? @"BINARY" : @"NOCASE";
+                sqlString = [sqlString stringByAppendingFormat:@" (%@ >= ? COLLATE %@ AND %@ < ? COLLATE %@)",
+                             attribute, collation, attribute, collation];
+            }
+            else if ([binaryOperator compare:SQLite3BinaryOperatorMatch] == NSOrderedSame &&
+                     fullTextIndexDefinition != nil) {
+                // Probe the full-text index instead of the table. An
+                // attribute naming the table matches any indexed column.
+                NSString *ftsTable = [fullTextIndexDefinition fullTextTableNameForTable:tableName];
+                NSString *matchedColumn = [attribute isEqualToString:tableName] ? ftsTable : attribute;
+                sqlString = [sqlString stringByAppendingFormat:@" rowid IN (SELECT rowid FROM %@ WHERE %@ MATCH ?)", ftsTable, matchedColumn];
+            }
+            else if ([binaryOperator compare:SQLite3BinaryOperatorLike] == NSOrderedSame ||
+                     [binaryOperator compare:SQLite3BinaryOperatorMatch] == NSOrderedSame) {
                 sqlString = [sqlString stringByAppendingFormat:@" %@ %@ ?", attribute, binaryOperator];
             }
             else {
@@ -1034,6 +1811,441 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
     return sqlString;
 }
 
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexDefinitionForTable:(NSString *)tableName {
+    static NSDictionary *__fullTextIndexDefinitionsByTable;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableDictionary *definitions = [NSMutableDictionary new];
+        for (Class cls in [LabQLiteDatabaseController mappableClassesDeclaringIndexes]) {
+            if (![cls respondsToSelector:@selector(fullTextIndexDefinition)]) continue;
+            LabQLiteFullTextIndexDefinition *fullTextIndexDefinition = [cls fullTextIndexDefinition];
+            if (fullTextIndexDefinition != nil) {
+                [definitions setObject:fullTextIndexDefinition
+                                forKey:[cls indexedTableName]];
+            }
+        }
+        __fullTextIndexDefinitionsByTable = [NSDictionary dictionaryWithDictionary:definitions];
+    });
+    return [__fullTextIndexDefinitionsByTable objectForKey:tableName];
+}
+
+// The rows of a PRAGMA, every column read as text (or NSNull);
+// nil if it fails.
+static NSArray *LabQLitePragmaRows(sqlite3 *connection, NSString *pragma) {
+    sqlite3_stmt *statement = NULL;
+    if (sqlite3_prepare_v2(connection, [pragma UTF8String], -1, &statement, NULL) != SQLITE_OK) {
+        sqlite3_finalize(statement);
+        return nil;
+    }
+    NSMutableArray *rows = [NSMutableArray new];
+    int resultCode;
+    while ((resultCode = sqlite3_step(statement)) == SQLITE_ROW) {
+        int columnCount = sqlite3_column_count(statement);
+        NSMutableArray *row = [[NSMutableArray alloc] initWithCapacity:columnCount];
+        for (int i = 0; i < columnCount; i++) {
+            const unsigned char *text = sqlite3_column_text(statement, i);
+            [row addObject:(text != NULL ? [NSString stringWithUTF8String:(const char *)text] : [NSNull null])];
+        }
+        [rows addObject:row];
+    }
+    sqlite3_finalize(statement);
+    return resultCode == SQLITE_DONE ? rows : nil;
+}
+
+/**
+ @abstract The collations of the indexes which a LIKE prefix
+ range on each column of a table could seek.
+ 
+ @discussion Keyed by lower-cased column name; only columns of
+ declared TEXT affinity appear, each with the upper-cased
+ collations of the non-partial indexes it leads. Read over a
+ connection of its own, since the database may be open already,
+ and cached per table until the database is switched or declared
+ indexes are created.
+ */
+- (NSDictionary *)likePrefixCollationsForTable:(NSString *)tableName {
+    @synchronized (self) {
+        NSDictionary *collations = [_likePrefixCollationsByTable objectForKey:tableName];
+        if (collations != nil) return collations;
+    }
+    
+    sqlite3 *connection = NULL;
+    if (![self.database openConnection:&connection error:NULL]) {
+        return nil;
+    }
+    NSArray *columns = LabQLitePragmaRows(connection, [NSString stringWithFormat:@"PRAGMA table_info(%@)", tableName]);
+    NSArray *indexes = LabQLitePragmaRows(connection, [NSString stringWithFormat:@"PRAGMA index_list(%@)", tableName]);
+    BOOL complete = columns != nil && indexes != nil;
+    
+    // The declared-type rules of SQLite: INT wins over the TEXT
+    // ones, so e.g. a NUMERIC or INTEGER column never qualifies.
+    NSMutableSet *textColumns = [NSMutableSet new];
+    for (NSArray *column in columns) {
+        id declaredType = [column objectAtIndex:2];
+        if (declaredType == [NSNull null]) continue;
+        NSString *type = [declaredType uppercaseString];
+        if ([type rangeOfString:@"INT"].location == NSNotFound &&
+            ([type rangeOfString:@"CHAR"].location != NSNotFound ||
+             [type rangeOfString:@"CLOB"].location != NSNotFound ||
+             [type rangeOfString:@"TEXT"].location != NSNotFound)) {
+            [textColumns addObject:[[column objectAtIndex:1] lowercaseString]];
+        }
+    }
+    
+    NSMutableDictionary *collations = [NSMutableDictionary new];
+    for (NSArray *index in indexes) {
+        if ([[index objectAtIndex:4] isEqual:@"1"]) continue;
+        NSString *indexName = [[index objectAtIndex:1] stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""];
+        NSArray *keys = LabQLitePragmaRows(connection, [NSString stringWithFormat:@"PRAGMA index_xinfo(\"%@\")", indexName]);
+        if (keys == nil) {
+            complete = NO;
+            break;
+        }
+        // Expression keys have no column name
+        NSArray *leadingKey = [keys firstObject];
+        if (leadingKey == nil || [leadingKey objectAtIndex:2] == [NSNull null]) continue;
+        NSString *column = [[leadingKey objectAtIndex:2] lowercaseString];
+        if (![textColumns containsObject:column]) continue;
+        NSMutableSet *columnCollations = [collations objectForKey:column];
+        if (columnCollations == nil) {
+            columnCollations = [NSMutableSet new];
+            [collations setObject:columnCollations forKey:column];
+        }
+        [columnCollations addObject:[[leadingKey objectAtIndex:4] uppercaseString]];
+    }
+    sqlite3_close(connection);
+    LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+    
+    if (complete) {
+        @synchronized (self) {
+            if (_likePrefixCollationsByTable == nil) {
+                _likePrefixCollationsByTable = [NSMutableDictionary new];
+            }
+            [_likePrefixCollationsByTable setObject:collations forKey:tableName];
+        }
+    }
+    return collations;
+}
+
+- (NSArray *)likePrefixBoundsForStipulation:(LabQLiteStipulation *)stipulation
+                                   forTable:(NSString *)tableName {
+    if (tableName == nil ||
+        ![stipulation.binaryOperator isEqualToString:SQLite3BinaryOperatorLike] ||
+        ![stipulation.affinity isEqualToNumber:SQLITE_AFFINITY_TYPE_TEXT] ||
+        ![stipulation.value isKindOfClass:[NSString class]]) {
+        return nil;
+    }
+    
+    // The range only pays off, and only matches what LIKE
+    // matches, on a TEXT column which an index of the collation
+    // in use can serve; otherwise LIKE stays.
+    NSString *collation = self.database.caseSensitiveLike ? @"BINARY" : @"NOCASE";
+    NSSet *columnCollations = [[self likePrefixCollationsForTable:tableName] objectForKey:[stipulation.attribute lowercaseString]];
+    if (![columnCollations containsObject:collation]) {
+        return nil;
+    }
+    
+    // Only a literal prefix followed by a single trailing %
+    // qualifies; leading or inner wildcards fall back to LIKE.
+    NSString *pattern = stipulation.value;
+    if ([pattern length] < 2 || ![pattern hasSuffix:@"%"]) return nil;
+    NSString *prefix = [pattern substringToIndex:[pattern length] - 1];
+    if ([prefix rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@"%_"]].location != NSNotFound) {
+        return nil;
+    }
+    
+    // Case-insensitive LIKE, like NOCASE, folds ASCII letters
+    // only; the bounds are compared folded to lower case.
+    NSUInteger length = [prefix length];
+    unichar *characters = malloc(length * sizeof(unichar));
+    [prefix getCharacters:characters range:NSMakeRange(0, length)];
+    if (!self.database.caseSensitiveLike) {
+        for (NSUInteger i = 0; i < length; i++) {
+            if (characters[i] >= 'A' && characters[i] <= 'Z') characters[i] += 'a' - 'A';
+        }
+    }
+    NSString *lowerBound = [NSString stringWithCharacters:characters length:length];
+    
+    // The upper bound is the prefix with its last character
+    // bumped to the next code point; UTF-8 sorts by code point.
+    unichar last = characters[length - 1];
+    BOOL bumpable = (last < 0xD800 || last > 0xDFFF) && last != 0xFFFF;
+    characters[length - 1] = (last == 0xD7FF) ? 0xE000 : last + 1;
+    if (!self.database.caseSensitiveLike && characters[length - 1] >= 'A' && characters[length - 1] <= 'Z') {
+        bumpable = NO;
+    }
+    NSString *upperBound = [NSString stringWithCharacters:characters length:length];
+    free(characters);
+    if (!bumpable) return nil;
+    return @[lowerBound, upperBound];
+}
+
+- (NSArray *)likePrefixBoundsForStipulations:(NSArray *)stipulations
+                                    forTable:(NSString *)tableName {
+    NSMutableArray *likePrefixBounds = [[NSMutableArray alloc] initWithCapacity:[stipulations count]];
+    for (LabQLiteStipulation *s in stipulations) {
+        NSArray *bounds = [self likePrefixBoundsForStipulation:s forTable:tableName];
+        [likePrefixBounds addObject:(bounds != nil ? bounds : [NSNull null])];
+    }
+    return likePrefixBounds;
+}
+
+- (NSArray *)valuesForBindingFromStipulations:(NSArray *)stipulations
+                             likePrefixBounds:(NSArray *)likePrefixBounds {
+    NSMutableArray *values = [[NSMutableArray alloc] initWithCapacity:[stipulations count]];
+    for (NSUInteger i = 0; i < [stipulations count]; i++) {
+        LabQLiteStipulation *s = [stipulations objectAtIndex:i];
+        id bounds = [likePrefixBounds objectAtIndex:i];
+        if (bounds != [NSNull null]) {
+            [values addObjectsFromArray:bounds];
+        }
+        else {
+            [values addObject:(s.value != nil ? s.value : [NSNull null])];
+        }
+    }
+    return values;
+}
+
+- (NSArray *)affinitiesForBindingFromStipulations:(NSArray *)stipulations
+                                 likePrefixBounds:(NSArray *)likePrefixBounds {
+    NSMutableArray *affinities = [[NSMutableArray alloc] initWithCapacity:[stipulations count]];
+    for (NSUInteger i = 0; i < [stipulations count]; i++) {
+        LabQLiteStipulation *s = [stipulations objectAtIndex:i];
+        [affinities addObject:s.affinity];
+        if ([likePrefixBounds objectAtIndex:i] != [NSNull null]) {
+            [affinities addObject:s.affinity];
+        }
+    }
+    return affinities;
+}
+
+- (NSArray *)selectedColumnsForMappableClass:(Class)cls {
+    if (cls == nil || ![cls conformsToProtocol:@protocol(LabQLiteRowMappable)]) {
+        return nil;
+    }
+    id <LabQLiteRowMappable> prototype = [[cls alloc] init];
+    NSArray *columnNames = [prototype columnNames];
+    if ([columnNames count] == 0) return nil;
+    
+    NSArray *lazyColumns = nil;
+    if ([cls respondsToSelector:@selector(lazilyLoadedColumnNames)]) {
+        lazyColumns = [cls lazilyLoadedColumnNames];
+    }
+    if ([lazyColumns count] == 0) return columnNames;
+    
+    // The rowid leads the selection; it is what the
+    // faults of the lazy columns load by.
+    NSMutableArray *selectedColumns = [NSMutableArray arrayWithObject:@"rowid"];
+    for (NSString *columnName in columnNames) {
+        if (![lazyColumns containsObject:columnName]) {
+            [selectedColumns addObject:columnName];
+        }
+    }
+    return selectedColumns;
+}
+
+- (NSMutableArray *)objectsOfMappableClass:(Class)cls
+                                  fromRows:(NSArray *)rows
+                           selectedColumns:(NSArray *)selectedColumns {
+    if (selectedColumns == nil) {
+        NSMutableArray *normalizedRows = LabQLiteObjectsFromRows(rows, self.parallelMappingEnabled, ^id(NSArray *array) {
+            id <LabQLiteRowMappable> newRow = [[cls alloc] init];
+            for (NSString *key in [newRow propertyKeysMatchingAttributeColumns]) {
+                [(NSObject *)newRow setValue:[array objectAtIndex:[[newRow propertyKeysMatchingAttributeColumns] indexOfObject:key]]
+                                      forKey:key];
+            }
+            return newRow;
+        });
+        LabQLiteMetricsAdd(LabQLiteMetricObjectsMapped, [normalizedRows count]);
+        return normalizedRows;
+    }
+    
+    // Each property is filled from the result column of the same
+    // name. Columns left out of the selection get one fault batch
+    // each, shared by every object mapped here.
+    id <LabQLiteRowMappable> prototype = [[cls alloc] init];
+    NSArray *columnNames = [prototype columnNames];
+    NSArray *propertyKeys = [prototype propertyKeysMatchingAttributeColumns];
+    NSUInteger columnCount = MIN([columnNames count], [propertyKeys count]);
+    NSUInteger selectedIndexes[columnCount > 0 ? columnCount : 1];
+    NSMutableDictionary *faultBatches = [NSMutableDictionary new];
+    NSDictionary *dateStorages = nil;
+    if ([cls respondsToSelector:@selector(dateStorageForColumns)]) {
+        dateStorages = [cls dateStorageForColumns];
+    }
+    NSMutableArray *dateStorageOfColumns = [[NSMutableArray alloc] initWithCapacity:columnCount];
+    for (NSUInteger i = 0; i < columnCount; i++) {
+        NSString *columnName = [columnNames objectAtIndex:i];
+        id dateStorage = [dateStorages objectForKey:columnName];
+        [dateStorageOfColumns addObject:(dateStorage != nil ? dateStorage : [NSNull null])];
+        selectedIndexes[i] = [selectedColumns indexOfObject:columnName];
+        if (selectedIndexes[i] == NSNotFound) {
+            [faultBatches setObject:[[LabQLiteFaultBatch alloc] initWithController:self
+                                                                         tableName:[prototype tableName]
+                                                                        columnName:columnName]
+                             forKey:columnName];
+        }
+    }
+    
+    // Blocks cannot capture C arrays, only pointers to them; the
+    // storages are objects, so they go in an NSArray the block keeps.
+    const NSUInteger *selectedIndexOfColumn = selectedIndexes;
+    NSNull *null = [NSNull null];
+    NSMutableArray *normalizedRows = LabQLiteObjectsFromRows(rows, self.parallelMappingEnabled, ^id(NSArray *array) {
+        id <LabQLiteRowMappable> newRow = [[cls alloc] init];
+        for (NSUInteger i = 0; i < columnCount; i++) {
+            if (selectedIndexOfColumn[i] == NSNotFound) continue;
+            id value = [array objectAtIndex:selectedIndexOfColumn[i]];
+            id dateStorage = [dateStorageOfColumns objectAtIndex:i];
+            if (dateStorage != null && value != null) {
+                NSDate *date = [LabQLiteDateCodec dateFromStorageValue:value
+                                                               storage:(LabQLiteDateStorage)[dateStorage intValue]];
+                if (date != nil) value = date;
+            }
+            [(NSObject *)newRow setValue:value
+                                  forKey:[propertyKeys objectAtIndex:i]];
+        }
+        return newRow;
+    });
+    
+    // Faults are handed out afterwards, on this thread and in row
+    // order, so that each window of a batch holds neighbouring rows.
+    if ([faultBatches count] > 0) {
+        for (NSUInteger r = 0; r < [rows count]; r++) {
+            NSObject *newRow = [normalizedRows objectAtIndex:r];
+            NSNumber *rowID = [[rows objectAtIndex:r] objectAtIndex:0];
+            for (NSUInteger i = 0; i < columnCount; i++) {
+                if (selectedIndexes[i] != NSNotFound) continue;
+                [newRow setValue:[[faultBatches objectForKey:[columnNames objectAtIndex:i]] faultForRowID:rowID]
+                          forKey:[propertyKeys objectAtIndex:i]];
+            }
+        }
+    }
+    LabQLiteMetricsAdd(LabQLiteMetricObjectsMapped, [normalizedRows count]);
+    return normalizedRows;
+}
+
+- (NSArray *)rowidRangesForParallelScanOfTable:(NSString *)tableName
+                                         error:(NSError **)error {
+    NSUInteger partitionCount = self.parallelScanPartitionCount;
+    if (partitionCount < 2 || self.database.openMode == LabQLiteDatabaseOpenModeInMemory) {
+        return nil;
+    }
+    
+    // Views and WITHOUT ROWID tables have no rowid b-tree to
+    // split; they are scanned serially.
+    NSArray *definitions = [self.database processStatement:@"SELECT sql FROM sqlite_master WHERE type='table' AND name=?"
+                                           insulatedly:YES
+                                        bindableValues:@[tableName]
+                                         affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT]
+                                                 error:error];
+    if (!definitions) return nil;
+    id definition = [[definitions firstObject] firstObject];
+    if (![definition isKindOfClass:[NSString class]] ||
+        [[definition uppercaseString] rangeOfString:@"WITHOUT ROWID"].location != NSNotFound) {
+        return nil;
+    }
+    
+    // Both ends come straight from the rowid b-tree. Expression
+    // columns have no declared type and decode as NUMERIC, so the
+    // bounds may be NSStrings; both answer -longLongValue.
+    NSString *q = [NSString stringWithFormat:@"SELECT min(rowid), max(rowid) FROM %@", tableName];
+    NSArray *rows = [self.database processStatement:q insulatedly:YES error:error];
+    if (!rows) return nil;
+    NSArray *bounds = [rows firstObject];
+    if ([bounds count] != 2 ||
+        [bounds objectAtIndex:0] == [NSNull null] ||
+        [bounds objectAtIndex:1] == [NSNull null]) {
+        return nil;
+    }
+    long long minRowid = [[bounds objectAtIndex:0] longLongValue];
+    long long maxRowid = [[bounds objectAtIndex:1] longLongValue];
+    
+    // Computed in double: the span of rowids may exceed long long
+    double span = (double)maxRowid - (double)minRowid + 1;
+    double maxPartitions = span / LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION;
+    if (maxPartitions < partitionCount) partitionCount = (NSUInteger)maxPartitions;
+    if (partitionCount < 2) {
+        return nil;
+    }
+    NSMutableArray *ranges = [[NSMutableArray alloc] initWithCapacity:partitionCount];
+    long long lowerBound = minRowid;
+    for (NSUInteger i = 1; i <= partitionCount; i++) {
+        long long upperBound = i == partitionCount ? maxRowid : minRowid + (long long)(span * i / partitionCount) - 1;
+        [ranges addObject:@[@(lowerBound), @(upperBound)]];
+        lowerBound = upperBound + 1;
+    }
+    return ranges;
+}
+
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+             withSpecifiedColumns:(NSArray *)arrayOfAttributeNames
+                     stipulations:(NSArray *)stipulations
+                    inRowidRanges:(NSArray *)rowidRanges
+                       descending:(BOOL)descending
+                            error:(NSError **)error {
+    NSString *selection = [arrayOfAttributeNames count] > 0 ? [arrayOfAttributeNames componentsJoinedByString:@", "] : @"*";
+    NSString *q = [NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE rowid BETWEEN ? AND ?", selection, tableName];
+    NSArray *likePrefixBounds = [self likePrefixBoundsForStipulations:stipulations forTable:tableName];
+    NSString *stipulationClause = [self appendStipulations:stipulations
+                                                  forTable:tableName
+                                          likePrefixBounds:likePrefixBounds
+                                               toSQLString:@""];
+    if ([stipulationClause hasPrefix:@" WHERE"]) {
+        q = [q stringByAppendingFormat:@" AND (%@)", [stipulationClause substringFromIndex:[@" WHERE" length]]];
+    }
+    q = [q stringByAppendingString:(descending ? @" ORDER BY rowid DESC" : @" ORDER BY rowid")];
+    NSArray *values = [self valuesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
+    NSArray *affinities = [self affinitiesForBindingFromStipulations:stipulations likePrefixBounds:likePrefixBounds];
+    NSArray *rangeAffinities = [@[SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER] arrayByAddingObjectsFromArray:affinities];
+    
+    // Each range gets a LabQLiteDatabase, and so connections, of
+    // its own; the controller's one runs a statement at a time.
+    NSUInteger rangeCount = [rowidRanges count];
+    NSMutableArray *rowsOfRanges = [[NSMutableArray alloc] initWithCapacity:rangeCount];
+    for (NSUInteger i = 0; i < rangeCount; i++) {
+        [rowsOfRanges addObject:[NSNull null]];
+    }
+    __block NSError *firstError = nil;
+    NSLock *lock = [NSLock new];
+    LabQLiteDatabase *database = self.database;
+    dispatch_apply(rangeCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        NSError *rangeError = nil;
+        NSArray *rangeRows = nil;
+        LabQLiteDatabase *rangeDatabase = [[LabQLiteDatabase alloc] initWithPath:database.databasePath
+                                                                        openMode:database.openMode
+                                                                           error:&rangeError];
+        if (rangeDatabase) {
+            rangeDatabase.busyTimeout = database.busyTimeout;
+            rangeDatabase.mmapSize = database.mmapSize;
+            rangeDatabase.caseSensitiveLike = database.caseSensitiveLike;
+            rangeRows = [rangeDatabase processStatement:q
+                                            insulatedly:YES
+                                         bindableValues:[[rowidRanges objectAtIndex:i] arrayByAddingObjectsFromArray:values]
+                                          affinityTypes:rangeAffinities
+                                                  error:&rangeError];
+        }
+        [lock lock];
+        if (rangeRows != nil) {
+            [rowsOfRanges replaceObjectAtIndex:i withObject:rangeRows];
+        }
+        else if (firstError == nil) {
+            firstError = rangeError;
+        }
+        [lock unlock];
+    });
+    
+    NSMutableArray *rows = [NSMutableArray new];
+    for (id rangeRows in (descending ? [rowsOfRanges reverseObjectEnumerator] : [rowsOfRanges objectEnumerator])) {
+        if (rangeRows == [NSNull null]) {
+            if (error != NULL) *error = firstError;
+            return nil;
+        }
+        [rows addObjectsFromArray:rangeRows];
+    }
+    return rows;
+}
+
 - (NSString *)appendOffset:(NSUInteger)offset
          toSQLString:(NSString *)sqlString {
     sqlString = [sqlString stringByAppendingFormat:@" OFFSET %lu", (unsigned long)offset];
@@ -1042,10 +2254,148 @@ assumingNSDocumentDirectoryAsRootPath:(BOOL)assumedNSDocumentDirectoryAsRootPath
 
 - (NSString *)appendRowsLimitation:(NSUInteger)limit
                  toSQLString:(NSString *)sqlString {
+    
+    // NSUInteger cannot hold LABQLITE_WRAPPER_SELECT_LIMIT_NONE,
+    // and SQLite rejects a LIMIT above the 64-bit signed range.
+    if (limit == (NSUInteger)LABQLITE_WRAPPER_SELECT_LIMIT_NONE) {
+        return [sqlString stringByAppendingString:@" LIMIT -1"];
+    }
     sqlString = [sqlString stringByAppendingFormat:@" LIMIT %lu", (unsigned long)limit];
     return sqlString;
 }
 
+- (NSMutableDictionary *)rowsFromTable:(NSString *)tableName
+                        withKeyColumns:(NSArray *)keyColumns
+                         inValueTuples:(NSArray *)keyTuples
+                            affinities:(NSArray *)affinities
+                   unwrappingKeyTuples:(BOOL)shouldUnwrapSingleValueTuples
+                                 error:(NSError **)error {
+    if (tableName == nil) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorTableNameNotSpecified
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageLabQLiteErrorTableNameNotSpecified}];
+        }
+        return nil;
+    }
+
+    NSUInteger keyColumnsCount = [keyColumns count];
+    if (keyColumnsCount == 0 || [affinities count] != keyColumnsCount) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorBindableValuesCountDidNotMatchColumnAffinityTypesCount
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageBindableValuesCountDidNotMatchColumnAffinityTypesCount}];
+        }
+        return nil;
+    }
+    for (NSArray *keyTuple in keyTuples) {
+        if ([keyTuple count] != keyColumnsCount) {
+            if (error != NULL) {
+                *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                             code:LabQLiteErrorKeyColumnsCountDidNotMatchKeyValuesCount
+                                         userInfo:@{@"errorMessage" : LabQLiteErrorMessageKeyColumnsCountDidNotMatchKeyValuesCount,
+                                                    @"errorDetails" : [NSString stringWithFormat:@"Key tuple: %@", keyTuple]}];
+            }
+            return nil;
+        }
+    }
+
+    NSMutableDictionary *rowsByKey = [NSMutableDictionary new];
+    if ([keyTuples count] == 0) return rowsByKey;
+
+    // Decoded key values need not be of the class of the provided
+    // ones (@"3" for @3), so rows are filed under the provided key
+    // tuple of the same canonical form.
+    NSMutableDictionary *keyTuplesByCanonicalTuple = [[NSMutableDictionary alloc] initWithCapacity:[keyTuples count]];
+    for (NSArray *keyTuple in keyTuples) {
+        [keyTuplesByCanonicalTuple setObject:keyTuple forKey:LabQLiteCanonicalKeyTuple(keyTuple)];
+    }
+
+    // The key columns are selected ahead of the row itself so
+    // that each result can be filed under its key without
+    // knowing where the key columns sit in the table.
+    NSString *selection = [NSString stringWithFormat:@"SELECT %@, * FROM %@ WHERE",
+                           [keyColumns componentsJoinedByString:@", "],
+                           tableName];
+
+    // A single key column is matched with an IN list; a composite
+    // key is matched with OR-ed equality groups, each of which is
+    // answered by a probe into the primary key index.
+    NSString *tupleCondition;
+    NSString *tupleSeparator;
+    if (keyColumnsCount == 1) {
+        tupleCondition = @"?";
+        tupleSeparator = @", ";
+    }
+    else {
+        NSMutableArray *equalities = [[NSMutableArray alloc] initWithCapacity:keyColumnsCount];
+        for (NSString *keyColumn in keyColumns) {
+            [equalities addObject:[NSString stringWithFormat:@"%@=?", keyColumn]];
+        }
+        tupleCondition = [NSString stringWithFormat:@"(%@)", [equalities componentsJoinedByString:@" AND "]];
+        tupleSeparator = @" OR ";
+    }
+
+    NSUInteger tuplesPerBatch = MAX(1, LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT / keyColumnsCount);
+
+    if (![self openDatabase:error]) {
+        return nil;
+    }
+
+    for (NSUInteger batchStart = 0; batchStart < [keyTuples count]; batchStart += tuplesPerBatch) {
+        NSUInteger batchLength = MIN(tuplesPerBatch, [keyTuples count] - batchStart);
+        NSArray *batch = [keyTuples subarrayWithRange:NSMakeRange(batchStart, batchLength)];
+
+        NSMutableArray *conditions = [[NSMutableArray alloc] initWithCapacity:batchLength];
+        NSMutableArray *bindableValues = [[NSMutableArray alloc] initWithCapacity:batchLength * keyColumnsCount];
+        NSMutableArray *batchAffinities = [[NSMutableArray alloc] initWithCapacity:batchLength * keyColumnsCount];
+        for (NSArray *keyTuple in batch) {
+            [conditions addObject:tupleCondition];
+            [bindableValues addObjectsFromArray:keyTuple];
+            [batchAffinities addObjectsFromArray:affinities];
+        }
+
+        NSString *q;
+        if (keyColumnsCount == 1) {
+            q = [selection stringByAppendingFormat:@" %@ IN (%@)",
+                 [keyColumns firstObject],
+                 [conditions componentsJoinedByString:tupleSeparator]];
+        }
+        else {
+            q = [selection stringByAppendingFormat:@" %@",
+                 [conditions componentsJoinedByString:tupleSeparator]];
+        }
+
+        NSArray *results = [self processStatement:q
+                                   bindableValues:bindableValues
+                                    affinityTypes:batchAffinities
+                                      insulatedly:NO
+                                            error:error];
+        if (!results) {
+            [self closeDatabase:NULL];
+            return nil;
+        }
+
+        for (NSArray *result in results) {
+            NSArray *key = [result subarrayWithRange:NSMakeRange(0, keyColumnsCount)];
+            NSArray *providedKey = [keyTuplesByCanonicalTuple objectForKey:LabQLiteCanonicalKeyTuple(key)];
+            if (providedKey != nil) key = providedKey;
+            NSArray *row = [result subarrayWithRange:NSMakeRange(keyColumnsCount, [result count] - keyColumnsCount)];
+            if (shouldUnwrapSingleValueTuples) {
+                [rowsByKey setObject:row forKey:[key firstObject]];
+            }
+            else {
+                [rowsByKey setObject:row forKey:key];
+            }
+        }
+    }
+
+    if (![self closeDatabase:error]) {
+        return nil;
+    }
+    return rowsByKey;
+}
+
 
 @end
 
@@ -0,0 +1,128 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+#pragma mark - LabQLite Metrics
+
+/**
+ @abstract The library-level operation counters.
+ */
+typedef enum {
+    LabQLiteMetricConnectionOpens = 0,
+    LabQLiteMetricConnectionCloses,
+    LabQLiteMetricStatementsPrepared,
+    LabQLiteMetricRowsStepped,
+    LabQLiteMetricNullCellsDecoded,
+    LabQLiteMetricIntegerCellsDecoded,
+    LabQLiteMetricRealCellsDecoded,
+    LabQLiteMetricTextCellsDecoded,
+    LabQLiteMetricBlobCellsDecoded,
+    LabQLiteMetricNumericCellsDecoded,
+    LabQLiteMetricTextBytesMaterialized,
+    LabQLiteMetricBlobBytesMaterialized,
+    LabQLiteMetricObjectsMapped,
+    LabQLiteMetricRowsInserted,
+    LabQLiteMetricTransactionsBegun,
+    LabQLiteMetricRollbacks,
+    LabQLiteMetricSchemaValidations,
+    LabQLiteMetricSchemaValidationNanoseconds,
+    LabQLiteMetricCount
+} LabQLiteMetric;
+
+/**
+ @abstract Adds the provided amount to a counter. Lock-free and
+ safe to call from any thread.
+ */
+FOUNDATION_EXPORT void LabQLiteMetricsAdd(LabQLiteMetric metric, uint64_t amount);
+
+/**
+ @abstract Low-overhead, process-wide counters for the LabQLite
+ stack: connections, statements, rows, decoded cells, materialized
+ bytes, mapped objects, transactions and the time spent validating
+ database files.
+
+ @discussion Counters are relaxed atomics which are only ever
+ incremented; readers get a snapshot which is consistent per
+ counter but not across counters.
+ */
+@interface LabQLiteMetrics : NSObject
+
+/**
+ @abstract Returns the current value of every counter.
+
+ @return A dictionary mapping each counter's Prometheus name
+ (e.g. `labqlite_connection_opens_total`) to an NSNumber.
+ */
++ (NSDictionary *)snapshot;
+
+/**
+ @abstract Returns the current value of a single counter.
+ */
++ (uint64_t)valueForMetric:(LabQLiteMetric)metric;
+
+/**
+ @abstract Renders every counter in the Prometheus text
+ exposition format.
+ */
++ (NSString *)prometheusText;
+
+/**
+ @abstract Atomically writes prometheusText to the provided path.
+
+ @param path The metrics file path.
+
+ @param error Standard error-capturing double
+ indirection pointer.
+
+ @return Whether the file was written.
+ */
++ (BOOL)writePrometheusTextToPath:(NSString *)path
+                            error:(NSError **)error;
+
+/**
+ @abstract Starts rewriting the metrics file at the provided path
+ every interval seconds on a background queue. Replaces any
+ previously started writer.
+ */
++ (void)startWritingPrometheusTextToPath:(NSString *)path
+                                interval:(NSTimeInterval)interval;
+
+/**
+ @abstract Stops the periodic metrics file writer.
+ */
++ (void)stopWritingPrometheusText;
+
+/**
+ @abstract Sets every counter back to zero.
+ */
++ (void)reset;
+
+
+@end
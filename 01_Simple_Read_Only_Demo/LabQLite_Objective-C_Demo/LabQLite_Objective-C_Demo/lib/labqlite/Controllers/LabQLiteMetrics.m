@@ -0,0 +1,137 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <stdatomic.h>
+#import "LabQLiteMetrics.h"
+
+
+static _Atomic(uint64_t) LabQLiteMetricsCounters[LabQLiteMetricCount];
+
+static NSString *const LabQLiteMetricsNames[LabQLiteMetricCount] = {
+    @"labqlite_connection_opens_total",
+    @"labqlite_connection_closes_total",
+    @"labqlite_statements_prepared_total",
+    @"labqlite_rows_stepped_total",
+    @"labqlite_null_cells_decoded_total",
+    @"labqlite_integer_cells_decoded_total",
+    @"labqlite_real_cells_decoded_total",
+    @"labqlite_text_cells_decoded_total",
+    @"labqlite_blob_cells_decoded_total",
+    @"labqlite_numeric_cells_decoded_total",
+    @"labqlite_text_bytes_materialized_total",
+    @"labqlite_blob_bytes_materialized_total",
+    @"labqlite_objects_mapped_total",
+    @"labqlite_rows_inserted_total",
+    @"labqlite_transactions_begun_total",
+    @"labqlite_rollbacks_total",
+    @"labqlite_schema_validations_total",
+    @"labqlite_schema_validation_nanoseconds_total"
+};
+
+void LabQLiteMetricsAdd(LabQLiteMetric metric, uint64_t amount) {
+    atomic_fetch_add_explicit(&LabQLiteMetricsCounters[metric], amount, memory_order_relaxed);
+}
+
+
+@implementation LabQLiteMetrics
+
+static dispatch_source_t __metricsWriterTimer;
+
++ (uint64_t)valueForMetric:(LabQLiteMetric)metric {
+    return atomic_load_explicit(&LabQLiteMetricsCounters[metric], memory_order_relaxed);
+}
+
++ (NSDictionary *)snapshot {
+    NSMutableDictionary *snapshot = [[NSMutableDictionary alloc] initWithCapacity:LabQLiteMetricCount];
+    for (int i = 0; i < LabQLiteMetricCount; i++) {
+        [snapshot setObject:@([LabQLiteMetrics valueForMetric:(LabQLiteMetric)i])
+                     forKey:LabQLiteMetricsNames[i]];
+    }
+    return snapshot;
+}
+
++ (NSString *)prometheusText {
+    NSMutableString *text = [NSMutableString new];
+    for (int i = 0; i < LabQLiteMetricCount; i++) {
+        [text appendFormat:@"# TYPE %@ counter\n%@ %llu\n",
+         LabQLiteMetricsNames[i],
+         LabQLiteMetricsNames[i],
+         (unsigned long long)[LabQLiteMetrics valueForMetric:(LabQLiteMetric)i]];
+    }
+    return text;
+}
+
++ (BOOL)writePrometheusTextToPath:(NSString *)path
+                            error:(NSError **)error {
+    return [[LabQLiteMetrics prometheusText] writeToFile:path
+                                              atomically:YES
+                                                encoding:NSUTF8StringEncoding
+                                                   error:error];
+}
+
++ (void)startWritingPrometheusTextToPath:(NSString *)path
+                                interval:(NSTimeInterval)interval {
+    @synchronized (self) {
+        [LabQLiteMetrics stopWritingPrometheusText];
+        if (path == nil || interval <= 0) return;
+        
+        dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0);
+        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+        uint64_t intervalInNanoseconds = (uint64_t)(interval * NSEC_PER_SEC);
+        dispatch_source_set_timer(timer,
+                                  dispatch_time(DISPATCH_TIME_NOW, (int64_t)intervalInNanoseconds),
+                                  intervalInNanoseconds,
+                                  intervalInNanoseconds / 10);
+        NSString *metricsPath = [path copy];
+        dispatch_source_set_event_handler(timer, ^{
+            NSError *error;
+            if (![LabQLiteMetrics writePrometheusTextToPath:metricsPath error:&error]) {
+                NSLog(@"LabQLite could not write metrics to %@: %@", metricsPath, error);
+            }
+        });
+        __metricsWriterTimer = timer;
+        dispatch_resume(timer);
+    }
+}
+
++ (void)stopWritingPrometheusText {
+    @synchronized (self) {
+        if (__metricsWriterTimer != nil) {
+            dispatch_source_cancel(__metricsWriterTimer);
+            __metricsWriterTimer = nil;
+        }
+    }
+}
+
++ (void)reset {
+    for (int i = 0; i < LabQLiteMetricCount; i++) {
+        atomic_store_explicit(&LabQLiteMetricsCounters[i], 0, memory_order_relaxed);
+    }
+}
+
+
+@end
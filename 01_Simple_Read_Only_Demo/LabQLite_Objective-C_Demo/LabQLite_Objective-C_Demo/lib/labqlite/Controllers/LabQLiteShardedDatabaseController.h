@@ -0,0 +1,181 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "LabQLiteDatabaseController.h"
+
+
+
+#pragma mark - LabQLiteShardedDatabaseController Class
+
+/**
+ @abstract Spreads tables over several database files, each behind
+ its own LabQLiteDatabaseController, so that they can be written to
+ and scanned in parallel.
+
+ @discussion A table lives either on a single shard (see
+ placeTable:onShardAtIndex:, shard 0 by default) or is partitioned
+ over every shard by the hash of one key column (see
+ partitionTable:byKeyColumn:); every shard file then holds a table
+ of that name with the rows whose key hashes to it. The hash is a
+ 64-bit FNV-1a of the key value, so rows keep their shard across
+ launches as long as the number of shards does not change.
+
+ Writes go to the shard owning the row. Scans and counts of
+ partitioned tables run on every shard at once, one thread per
+ shard, and are merged in shard order. Each shard processes one
+ statement at a time, so calls into a sharded controller must not
+ overlap.
+
+ The routing set up by placeTable:onShardAtIndex: and
+ partitionTable:byKeyColumn: is not synchronized: declare it
+ before the controller is used, never while reads or writes may
+ be running on another thread.
+ */
+@interface LabQLiteShardedDatabaseController : NSObject
+
+/**
+ @abstract The LabQLiteDatabaseController of each shard, in shard
+ order.
+ */
+@property (nonatomic, readonly) NSArray *shards;
+
+/**
+ @abstract Initializes a controller over the database files at the
+ provided paths, one shard per path.
+
+ @param databasePaths The paths to the shard database files.
+
+ @param error The standard error capturing double indirection pointer.
+
+ @return An initialized LabQLiteShardedDatabaseController object, or
+ nil if any shard failed to initialize, or with
+ LabQLiteErrorNoShards if no path was provided.
+ */
+- (instancetype)initWithDatabasePaths:(NSArray *)databasePaths
+                                error:(NSError **)error;
+
+/**
+ @abstract Keeps every row of the table on one shard. Not
+ thread safe; see the class discussion.
+ */
+- (void)placeTable:(NSString *)tableName
+    onShardAtIndex:(NSUInteger)shardIndex;
+
+/**
+ @abstract Spreads the rows of the table over every shard by the
+ value of the provided column. Not thread safe; see the class
+ discussion.
+ */
+- (void)partitionTable:(NSString *)tableName
+           byKeyColumn:(NSString *)keyColumn;
+
+/**
+ @abstract The index of the shard holding the row of the table
+ with the provided key value. The key value is ignored for tables
+ which are not partitioned.
+ */
+- (NSUInteger)shardIndexForTable:(NSString *)tableName
+                        keyValue:(id)keyValue;
+
+/**
+ @abstract The controller of the shard owning the provided row.
+ */
+- (LabQLiteDatabaseController *)shardForMappableObject:(id <LabQLiteRowMappable>)mappableObject;
+
+/**
+ @abstract Retrieves every row of the table, from every shard it
+ is spread over.
+
+ @see -[LabQLiteDatabaseController allRows:SQLite3RowSubclass:error:]
+ */
+- (NSMutableArray *)allRows:(NSString *)tableName
+         SQLite3RowSubclass:(Class)cls
+                      error:(NSError **)error;
+
+/**
+ @abstract Retrieves the rows of the table matching the provided
+ stipulations, from every shard it is spread over. Rows are in
+ shard order; order them afterwards if need be.
+
+ @see -[LabQLiteDatabaseController rowsFromTable:asSQLite3RowsWithSubclass:stipulations:offset:andMaxNumberOfRowsToReturn:orderedBy:error:]
+ */
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+        asSQLite3RowsWithSubclass:(Class)LabQLiteRowSubclass
+                     stipulations:(NSArray *)stipulations
+                            error:(NSError **)error;
+
+/**
+ @abstract Counts the rows of the table over every shard it is
+ spread over.
+ */
+- (NSUInteger)numberOfRowsInTable:(NSString *)tableName
+                            error:(NSError **)error;
+
+/**
+ @abstract Inserts the row into the shard owning it.
+ */
+- (BOOL)insertRow:(id <LabQLiteRowMappable>)row
+            error:(NSError **)error;
+
+/**
+ @abstract Inserts the rows, each into the shard owning it. Shards
+ are written to in parallel, each in a single pass; a failure on
+ one shard does not undo the rows inserted into the others.
+ */
+- (BOOL)insertRows:(NSArray *)rows
+         intoTable:(NSString *)tableName
+             error:(NSError **)error;
+
+/**
+ @abstract Deletes the rows of the table matching the provided
+ stipulations on every shard it is spread over.
+ */
+- (BOOL)deleteRowsFromTable:(NSString *)tableName
+           withStipulations:(NSArray *)stipulations
+                      error:(NSError **)error;
+
+/**
+ @abstract Deletes the row from the shard owning it.
+ */
+- (BOOL)deleteMappableObject:(id <LabQLiteRowMappable>)mappableObject
+                       error:(NSError **)error;
+
+/**
+ @abstract Updates the row on the shard owning it.
+
+ @discussion Fails with LabQLiteErrorShardKeyChanged if the new
+ values would place the row on another shard; delete and insert it
+ instead.
+ */
+- (BOOL)updateRow:(id <LabQLiteRowMappable>)rowObject
+               to:(id <LabQLiteRowMappable>)newRowObject
+            where:(NSArray *)stipulations
+            error:(NSError **)error;
+
+
+@end
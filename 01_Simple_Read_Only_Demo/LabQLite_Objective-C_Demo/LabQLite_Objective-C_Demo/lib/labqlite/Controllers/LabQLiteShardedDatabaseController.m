@@ -0,0 +1,321 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteShardedDatabaseController.h"
+#import "LabQLiteConstants.h"
+
+
+/**
+ @abstract 64-bit FNV-1a; stable across processes, unlike -hash.
+ */
+static uint64_t LabQLiteShardHashBytes(const void *bytes, NSUInteger length) {
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char *byte = bytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        hash ^= byte[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ @abstract Hashes a key value by its canonical form (see
+ LabQLiteCanonicalKeyValue), so that e.g. @3 and @"3" land on the
+ same shard as the integer 3 stored by SQLite.
+ */
+static uint64_t LabQLiteShardHashKeyValue(id keyValue) {
+    id canonicalValue = LabQLiteCanonicalKeyValue(keyValue);
+    if ([canonicalValue isKindOfClass:[NSData class]]) {
+        return LabQLiteShardHashBytes([canonicalValue bytes], [canonicalValue length]);
+    }
+    const char *bytes = [canonicalValue UTF8String];
+    return LabQLiteShardHashBytes(bytes, strlen(bytes));
+}
+
+
+@implementation LabQLiteShardedDatabaseController {
+    NSMutableDictionary *_shardIndexesByTable;
+    NSMutableDictionary *_keyColumnsByTable;
+}
+
+
+
+#pragma mark - Initialization
+
+- (instancetype)initWithDatabasePaths:(NSArray *)databasePaths
+                                error:(NSError **)error {
+    if ([databasePaths count] == 0) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorNoShards
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageNoShards}];
+        }
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        NSMutableArray *shards = [[NSMutableArray alloc] initWithCapacity:[databasePaths count]];
+        for (NSString *databasePath in databasePaths) {
+            LabQLiteDatabaseController *shard = [[LabQLiteDatabaseController alloc] initWithDatabasePath:databasePath
+                                                                                                  error:error];
+            if (!shard) return nil;
+            [shards addObject:shard];
+        }
+        _shards = [NSArray arrayWithArray:shards];
+        _shardIndexesByTable = [NSMutableDictionary new];
+        _keyColumnsByTable = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+
+
+#pragma mark - Routing
+
+- (void)placeTable:(NSString *)tableName
+    onShardAtIndex:(NSUInteger)shardIndex {
+    [_keyColumnsByTable removeObjectForKey:tableName];
+    [_shardIndexesByTable setObject:@(shardIndex % [_shards count]) forKey:tableName];
+}
+
+- (void)partitionTable:(NSString *)tableName
+           byKeyColumn:(NSString *)keyColumn {
+    [_shardIndexesByTable removeObjectForKey:tableName];
+    [_keyColumnsByTable setObject:keyColumn forKey:tableName];
+}
+
+- (NSUInteger)shardIndexForTable:(NSString *)tableName
+                        keyValue:(id)keyValue {
+    if ([_keyColumnsByTable objectForKey:tableName] == nil) {
+        return [[_shardIndexesByTable objectForKey:tableName] unsignedIntegerValue];
+    }
+    return (NSUInteger)(LabQLiteShardHashKeyValue(keyValue) % [_shards count]);
+}
+
+- (NSUInteger)shardIndexForMappableObject:(id <LabQLiteRowMappable>)mappableObject {
+    NSString *tableName = [mappableObject tableName];
+    NSString *keyColumn = [_keyColumnsByTable objectForKey:tableName];
+    id keyValue = nil;
+    if (keyColumn != nil) {
+        NSUInteger keyIndex = [[mappableObject columnNames] indexOfObject:keyColumn];
+        NSArray *values = [mappableObject valuesMatchingAttributeColumns];
+        if (keyIndex != NSNotFound && keyIndex < [values count]) {
+            keyValue = [values objectAtIndex:keyIndex];
+        }
+    }
+    return [self shardIndexForTable:tableName keyValue:keyValue];
+}
+
+- (LabQLiteDatabaseController *)shardForMappableObject:(id <LabQLiteRowMappable>)mappableObject {
+    return [_shards objectAtIndex:[self shardIndexForMappableObject:mappableObject]];
+}
+
+/**
+ @abstract The shards the table is spread over.
+ */
+- (NSArray *)shardsOfTable:(NSString *)tableName {
+    if ([_keyColumnsByTable objectForKey:tableName] != nil) {
+        return _shards;
+    }
+    return @[[_shards objectAtIndex:[self shardIndexForTable:tableName keyValue:nil]]];
+}
+
+/**
+ @abstract Runs the block once per shard, all shards at once, and
+ returns the results in shard order. A nil result is a failure;
+ every shard still runs, and the first error reported is kept.
+ */
+- (NSArray *)resultsFromShards:(NSArray *)shards
+                         error:(NSError **)error
+                    usingBlock:(id (^)(LabQLiteDatabaseController *shard, NSError **shardError))block {
+    NSUInteger count = [shards count];
+    NSMutableArray *results = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [results addObject:[NSNull null]];
+    }
+    __block BOOL failed = NO;
+    __block NSError *firstError = nil;
+    NSLock *lock = [NSLock new];
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        NSError *shardError = nil;
+        id result = block([shards objectAtIndex:i], &shardError);
+        [lock lock];
+        if (result != nil) {
+            [results replaceObjectAtIndex:i withObject:result];
+        }
+        else {
+            failed = YES;
+        }
+        if (shardError != nil && firstError == nil) {
+            firstError = shardError;
+        }
+        [lock unlock];
+    });
+    if (failed || firstError != nil) {
+        if (error != NULL) *error = firstError;
+        return nil;
+    }
+    return results;
+}
+
+
+
+#pragma mark - Reads
+
+- (NSMutableArray *)allRows:(NSString *)tableName
+         SQLite3RowSubclass:(Class)cls
+                      error:(NSError **)error {
+    NSArray *results = [self resultsFromShards:[self shardsOfTable:tableName]
+                                         error:error
+                                    usingBlock:^id(LabQLiteDatabaseController *shard, NSError **shardError) {
+        return [shard allRows:tableName SQLite3RowSubclass:cls error:shardError];
+    }];
+    if (!results) return nil;
+    NSMutableArray *rows = [NSMutableArray new];
+    for (NSArray *shardRows in results) {
+        [rows addObjectsFromArray:shardRows];
+    }
+    return rows;
+}
+
+- (NSMutableArray *)rowsFromTable:(NSString *)tableName
+        asSQLite3RowsWithSubclass:(Class)LabQLiteRowSubclass
+                     stipulations:(NSArray *)stipulations
+                            error:(NSError **)error {
+    NSArray *results = [self resultsFromShards:[self shardsOfTable:tableName]
+                                         error:error
+                                    usingBlock:^id(LabQLiteDatabaseController *shard, NSError **shardError) {
+        return [shard rowsFromTable:tableName
+          asSQLite3RowsWithSubclass:LabQLiteRowSubclass
+                       stipulations:stipulations
+                             offset:0
+         andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                          orderedBy:nil
+                              error:shardError];
+    }];
+    if (!results) return nil;
+    NSMutableArray *rows = [NSMutableArray new];
+    for (NSArray *shardRows in results) {
+        [rows addObjectsFromArray:shardRows];
+    }
+    return rows;
+}
+
+- (NSUInteger)numberOfRowsInTable:(NSString *)tableName
+                            error:(NSError **)error {
+    NSArray *results = [self resultsFromShards:[self shardsOfTable:tableName]
+                                         error:error
+                                    usingBlock:^id(LabQLiteDatabaseController *shard, NSError **shardError) {
+        return @([shard numberOfRowsInTable:tableName error:shardError]);
+    }];
+    NSUInteger rowCount = 0;
+    for (NSNumber *shardRowCount in results) {
+        rowCount += [shardRowCount unsignedIntegerValue];
+    }
+    return rowCount;
+}
+
+
+
+#pragma mark - Writes
+
+- (BOOL)insertRow:(id <LabQLiteRowMappable>)row
+            error:(NSError **)error {
+    return [[self shardForMappableObject:row] insertRow:row error:error];
+}
+
+- (BOOL)insertRows:(NSArray *)rows
+         intoTable:(NSString *)tableName
+             error:(NSError **)error {
+    NSMutableArray *rowsOfShards = [[NSMutableArray alloc] initWithCapacity:[_shards count]];
+    for (NSUInteger i = 0; i < [_shards count]; i++) {
+        [rowsOfShards addObject:[NSMutableArray new]];
+    }
+    for (id row in rows) {
+        if (![row conformsToProtocol:@protocol(LabQLiteRowMappable)]) {
+            if (error != NULL) {
+                *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                             code:LabQLiteErrorCollectionContainedNonSQLiteRowObject
+                                         userInfo:@{@"errorMessage" : LabQLiteErrorMessageCollectionContainedNonSQLiteRowObject}];
+            }
+            return NO;
+        }
+        [[rowsOfShards objectAtIndex:[self shardIndexForMappableObject:row]] addObject:row];
+    }
+    
+    // Only the shards receiving rows take part
+    NSMutableArray *shards = [NSMutableArray new];
+    NSMutableArray *shardRows = [NSMutableArray new];
+    for (NSUInteger i = 0; i < [_shards count]; i++) {
+        if ([[rowsOfShards objectAtIndex:i] count] == 0) continue;
+        [shards addObject:[_shards objectAtIndex:i]];
+        [shardRows addObject:[rowsOfShards objectAtIndex:i]];
+    }
+    return [self resultsFromShards:shards
+                             error:error
+                        usingBlock:^id(LabQLiteDatabaseController *shard, NSError **shardError) {
+        NSArray *rowsOfShard = [shardRows objectAtIndex:[shards indexOfObjectIdenticalTo:shard]];
+        return [shard insertRows:rowsOfShard intoTable:tableName error:shardError] ? @YES : nil;
+    }] != nil;
+}
+
+- (BOOL)deleteRowsFromTable:(NSString *)tableName
+           withStipulations:(NSArray *)stipulations
+                      error:(NSError **)error {
+    return [self resultsFromShards:[self shardsOfTable:tableName]
+                             error:error
+                        usingBlock:^id(LabQLiteDatabaseController *shard, NSError **shardError) {
+        return [shard deleteRowsFromTable:tableName withStipulations:stipulations error:shardError] ? @YES : nil;
+    }] != nil;
+}
+
+- (BOOL)deleteMappableObject:(id <LabQLiteRowMappable>)mappableObject
+                       error:(NSError **)error {
+    return [[self shardForMappableObject:mappableObject] deleteMappableObject:mappableObject error:error];
+}
+
+- (BOOL)updateRow:(id <LabQLiteRowMappable>)rowObject
+               to:(id <LabQLiteRowMappable>)newRowObject
+            where:(NSArray *)stipulations
+            error:(NSError **)error {
+    NSUInteger shardIndex = [self shardIndexForMappableObject:rowObject];
+    if ([self shardIndexForMappableObject:newRowObject] != shardIndex) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorShardKeyChanged
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageShardKeyChanged}];
+        }
+        return NO;
+    }
+    return [[_shards objectAtIndex:shardIndex] updateRow:rowObject
+                                                      to:newRowObject
+                                                   where:stipulations
+                                                   error:error];
+}
+
+
+@end
@@ -25,7 +25,7 @@ OTHER DEALINGS IN THE SOFTWARE.
 For more information, please refer to <http://unlicense.org>
  */
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "LabQLiteConstants.h"
 
@@ -30,7 +30,7 @@ For more information, please refer to <http://unlicense.org>
 @implementation LabQLiteValidationController
 
 + (BOOL)isValidSQLiteBinaryOperator:(NSString *)optr {
-    NSArray *operators = @[SQLite3BinaryOperatorEquals, SQLite3BinaryOperatorNotEquals, SQLite3BinaryOperatorLike];
+    NSArray *operators = @[SQLite3BinaryOperatorEquals, SQLite3BinaryOperatorNotEquals, SQLite3BinaryOperatorLike, SQLite3BinaryOperatorMatch];
     
     for (NSString *o in operators) {
         if ([optr compare:o] == NSOrderedSame) {
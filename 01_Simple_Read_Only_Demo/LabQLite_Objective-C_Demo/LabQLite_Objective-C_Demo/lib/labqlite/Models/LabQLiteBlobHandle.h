@@ -0,0 +1,173 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "sqlite3.h"
+
+@class LabQLiteDatabase;
+
+
+
+#pragma mark - LabQLiteZeroBlob Class
+
+/**
+ @abstract A bindable placeholder for a BLOB of the provided
+ length filled with zeros. Bound with sqlite3_bind_zeroblob, so
+ the space is reserved without building the bytes in memory;
+ the content is then written with a LabQLiteBlobHandle.
+
+    [database processStatement:@"INSERT INTO plant (common_name, icon_image) VALUES (?, ?)"
+                bindableValues:@[name, [LabQLiteZeroBlob zeroBlobWithLength:imageLength]]
+                 affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_NONE]
+                  openDatabase:NO
+                 closeDatabase:NO
+                         error:&error];
+ */
+@interface LabQLiteZeroBlob : NSObject
+
+/**
+ @abstract The number of bytes to reserve.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
++ (LabQLiteZeroBlob *)zeroBlobWithLength:(NSUInteger)length;
+
+@end
+
+
+
+#pragma mark - LabQLiteBlobHandle Class
+
+/**
+ @abstract Incremental access to a single BLOB cell through
+ sqlite3_blob_open, so large values can be read and written in
+ chunks instead of being loaded whole.
+
+ @discussion The handle borrows the connection of the provided
+ LabQLiteDatabase, which must be open (i.e. used with
+ insulatedly:NO) for as long as the handle is. Writes cannot
+ change the size of a BLOB; reserve the size first with
+ LabQLiteZeroBlob. A handle becomes invalid (SQLITE_ABORT) when
+ its row is changed by anything other than the handle itself.
+ */
+@interface LabQLiteBlobHandle : NSObject
+
+/**
+ @abstract The table, column and row the handle points at.
+ */
+@property (nonatomic, readonly) NSString *tableName;
+@property (nonatomic, readonly) NSString *columnName;
+@property (nonatomic, readonly) sqlite3_int64 rowID;
+
+/**
+ @abstract Whether the handle was opened for writing.
+ */
+@property (nonatomic, readonly, getter=isWritable) BOOL writable;
+
+/**
+ @abstract The size of the BLOB in bytes; zero once closed.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
+/**
+ @abstract Opens a handle on the provided cell.
+
+ @param database An open LabQLiteDatabase.
+
+ @param tableName The table holding the BLOB.
+
+ @param columnName The BLOB column.
+
+ @param rowID The rowid (or INTEGER PRIMARY KEY) of the row.
+
+ @param writable Whether the handle may write.
+
+ @param error Standard error-capturing double
+ indirection pointer.
+
+ @return A new handle, or nil if the cell could not be opened.
+ */
++ (LabQLiteBlobHandle *)blobHandleWithDatabase:(LabQLiteDatabase *)database
+                                         table:(NSString *)tableName
+                                        column:(NSString *)columnName
+                                         rowID:(sqlite3_int64)rowID
+                                      writable:(BOOL)writable
+                                         error:(NSError **)error;
+
+/**
+ @abstract Reads up to the provided number of bytes, starting at
+ the provided offset, into a caller-owned buffer.
+
+ @return The number of bytes read (less than requested only at
+ the end of the BLOB), or -1 on error.
+ */
+- (NSInteger)readIntoBuffer:(void *)buffer
+                     length:(NSUInteger)length
+                   atOffset:(NSUInteger)offset
+                      error:(NSError **)error;
+
+/**
+ @abstract Reads the BLOB in consecutive chunks of at most the
+ provided length, reusing one buffer. The bytes handed to the
+ block are only valid until it returns.
+
+ @return Whether or not every chunk (up to a stop) was read.
+ */
+- (BOOL)enumerateChunksOfLength:(NSUInteger)chunkLength
+                          error:(NSError **)error
+                     usingBlock:(void (^)(const void *bytes, NSUInteger length, NSUInteger offset, BOOL *stop))block;
+
+/**
+ @abstract Overwrites bytes of the BLOB starting at the provided
+ offset. The write must fit inside the current length.
+
+ @return Whether or not the bytes were written; NO with an
+ SQLITE_MISUSE error once the handle is closed.
+ */
+- (BOOL)writeBytes:(const void *)bytes
+            length:(NSUInteger)length
+          atOffset:(NSUInteger)offset
+             error:(NSError **)error;
+
+/**
+ @abstract Moves the handle to the same column of another row
+ without the cost of opening a new handle.
+
+ @return Whether or not the handle moved; NO with an
+ SQLITE_MISUSE error once the handle is closed.
+ */
+- (BOOL)reopenWithRowID:(sqlite3_int64)rowID
+                  error:(NSError **)error;
+
+/**
+ @abstract Closes the handle. Also happens on deallocation, but
+ only an explicit close reports errors.
+ */
+- (BOOL)close:(NSError **)error;
+
+
+@end
@@ -0,0 +1,219 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteBlobHandle.h"
+#import "LabQLiteDatabase.h"
+#import "LabQLiteConstants.h"
+#import "LabQLiteMetrics.h"
+
+
+@implementation LabQLiteZeroBlob
+
++ (LabQLiteZeroBlob *)zeroBlobWithLength:(NSUInteger)length {
+    LabQLiteZeroBlob *zeroBlob = [[LabQLiteZeroBlob alloc] init];
+    zeroBlob->_length = length;
+    return zeroBlob;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"zeroblob(%lu)", (unsigned long)_length];
+}
+
+@end
+
+
+
+/**
+ @abstract Builds the error for a failed sqlite3_blob_* call.
+ */
+static NSError *LabQLiteBlobHandleError(int code, LabQLiteDatabase *database) {
+    NSString *lowLevelErrorMessage = @"";
+    if (database.database != NULL) {
+        lowLevelErrorMessage = [NSString stringWithUTF8String:sqlite3_errmsg(database.database)];
+    }
+    return [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                               code:code
+                           userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:code],
+                                      @"errorDetails" : @{@"lowLevelErrorMessage" : lowLevelErrorMessage}}];
+}
+
+/**
+ @abstract Builds the error for a call on a closed handle, which
+ sqlite3_blob_* would count as misuse.
+ */
+static NSError *LabQLiteClosedBlobHandleError(void) {
+    return [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                               code:SQLITE_MISUSE
+                           userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:SQLITE_MISUSE],
+                                      @"errorDetails" : @"The BLOB handle is closed."}];
+}
+
+
+@implementation LabQLiteBlobHandle {
+    LabQLiteDatabase *_database;
+    sqlite3_blob *_blob;
+}
+
++ (LabQLiteBlobHandle *)blobHandleWithDatabase:(LabQLiteDatabase *)database
+                                         table:(NSString *)tableName
+                                        column:(NSString *)columnName
+                                         rowID:(sqlite3_int64)rowID
+                                      writable:(BOOL)writable
+                                         error:(NSError **)error {
+    sqlite3_blob *blob = NULL;
+    int code = sqlite3_blob_open(database.database,
+                                 "main",
+                                 [tableName UTF8String],
+                                 [columnName UTF8String],
+                                 rowID,
+                                 writable ? 1 : 0,
+                                 &blob);
+    if (code != SQLITE_OK) {
+        if (error != NULL) {
+            *error = LabQLiteBlobHandleError(code, database);
+        }
+        sqlite3_blob_close(blob);
+        return nil;
+    }
+    LabQLiteBlobHandle *handle = [[LabQLiteBlobHandle alloc] init];
+    handle->_database = database;
+    handle->_blob = blob;
+    handle->_tableName = tableName;
+    handle->_columnName = columnName;
+    handle->_rowID = rowID;
+    handle->_writable = writable;
+    return handle;
+}
+
+- (NSUInteger)length {
+    if (_blob == NULL) return 0;
+    return (NSUInteger)sqlite3_blob_bytes(_blob);
+}
+
+- (NSInteger)readIntoBuffer:(void *)buffer
+                     length:(NSUInteger)length
+                   atOffset:(NSUInteger)offset
+                      error:(NSError **)error {
+    NSUInteger blobLength = [self length];
+    if (offset >= blobLength) return 0;
+    NSUInteger readable = MIN(length, blobLength - offset);
+    int code = sqlite3_blob_read(_blob, buffer, (int)readable, (int)offset);
+    if (code != SQLITE_OK) {
+        if (error != NULL) {
+            *error = LabQLiteBlobHandleError(code, _database);
+        }
+        return -1;
+    }
+    LabQLiteMetricsAdd(LabQLiteMetricBlobBytesMaterialized, readable);
+    return (NSInteger)readable;
+}
+
+- (BOOL)enumerateChunksOfLength:(NSUInteger)chunkLength
+                          error:(NSError **)error
+                     usingBlock:(void (^)(const void *bytes, NSUInteger length, NSUInteger offset, BOOL *stop))block {
+    NSUInteger blobLength = [self length];
+    if (chunkLength == 0 || blobLength == 0) return YES;
+    NSMutableData *buffer = [NSMutableData dataWithLength:MIN(chunkLength, blobLength)];
+    BOOL stop = NO;
+    for (NSUInteger offset = 0; offset < blobLength && !stop; ) {
+        NSInteger read = [self readIntoBuffer:[buffer mutableBytes]
+                                       length:[buffer length]
+                                     atOffset:offset
+                                        error:error];
+        if (read < 0) return NO;
+        block([buffer bytes], (NSUInteger)read, offset, &stop);
+        offset += (NSUInteger)read;
+    }
+    return YES;
+}
+
+- (BOOL)writeBytes:(const void *)bytes
+            length:(NSUInteger)length
+          atOffset:(NSUInteger)offset
+             error:(NSError **)error {
+    if (_blob == NULL) {
+        if (error != NULL) {
+            *error = LabQLiteClosedBlobHandleError();
+        }
+        return NO;
+    }
+    int code = sqlite3_blob_write(_blob, bytes, (int)length, (int)offset);
+    if (code != SQLITE_OK) {
+        if (error != NULL) {
+            *error = LabQLiteBlobHandleError(code, _database);
+        }
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)reopenWithRowID:(sqlite3_int64)rowID
+                  error:(NSError **)error {
+    if (_blob == NULL) {
+        if (error != NULL) {
+            *error = LabQLiteClosedBlobHandleError();
+        }
+        return NO;
+    }
+    int code = sqlite3_blob_reopen(_blob, rowID);
+    if (code != SQLITE_OK) {
+        if (error != NULL) {
+            *error = LabQLiteBlobHandleError(code, _database);
+        }
+        return NO;
+    }
+    _rowID = rowID;
+    return YES;
+}
+
+- (BOOL)close:(NSError **)error {
+    if (_blob == NULL) return YES;
+    int code = sqlite3_blob_close(_blob);
+    _blob = NULL;
+    if (code != SQLITE_OK) {
+        if (error != NULL) {
+            *error = LabQLiteBlobHandleError(code, _database);
+        }
+        return NO;
+    }
+    return YES;
+}
+
+- (void)dealloc {
+    if (_blob != NULL) {
+        sqlite3_blob_close(_blob);
+    }
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<LabQLiteBlobHandle %@.%@ rowid %lld, %lu bytes%@>",
+            _tableName, _columnName, _rowID, (unsigned long)[self length],
+            (_writable ? @", writable" : @"")];
+}
+
+
+@end
@@ -25,11 +25,12 @@ OTHER DEALINGS IN THE SOFTWARE.
 For more information, please refer to <http://unlicense.org>
  */
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "sqlite3.h"
 
 #import "LabQLiteStipulation.h"
 #import "LabQLiteRowMappable.h"
+#import "LabQLiteLatencyHistogram.h"
 
 @class LabQLiteDatabaseController;
 
@@ -55,7 +56,13 @@ typedef enum {
     LabQLiteErrorMultipleErrors,
     LabQLiteErrorDatabaseDoesNotExistInBundle,
     LabQLiteErrorDatabasePathPointsToNonDatabase,
-    LabQLiteErrorColumnsCountDidNotMatchValuesCount
+    LabQLiteErrorColumnsCountDidNotMatchValuesCount,
+    LabQLiteErrorKeyColumnsCountDidNotMatchKeyValuesCount,
+    LabQLiteErrorShardKeyChanged,
+    LabQLiteErrorNoFullTextIndex,
+    LabQLiteErrorFullTextModuleUnavailable,
+    LabQLiteErrorDatabaseReadOnly,
+    LabQLiteErrorNoShards
 } LabQLiteError;
 
 FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageCollectionContainedNonSQLiteRowObject;
@@ -66,6 +73,106 @@ FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageMultipleErrors;
 FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageDatabaseDoesNotExistInBundle;
 FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageDatabasePathPointsToNonDatabase;
 FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageKeyColumnsCountDidNotMatchKeyValuesCount;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageShardKeyChanged;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageNoFullTextIndex;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageFullTextModuleUnavailable;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageDatabaseReadOnly;
+FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageNoShards;
+
+#pragma mark - Query Plan Diagnostics Keys
+
+/**
+ @abstract Keys of the dictionaries returned by
+ -[LabQLiteDatabase queryPlanDiagnostics].
+ */
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanStatementKey;
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanTableKey;
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanDetailsKey;
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanUsesFullTableScanKey;
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanUsesTemporaryBTreeKey;
+FOUNDATION_EXPORT NSString *const LabQLiteQueryPlanSuggestedIndexColumnsKey;
+
+#pragma mark - Statement Statistics Keys
+
+/**
+ @abstract Keys of the per-fingerprint dictionaries returned by
+ -[LabQLiteDatabase statisticsSnapshot]. Durations are NSNumber
+ doubles in microseconds.
+ */
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsCountKey;
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsMeanKey;
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsP50Key;
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsP95Key;
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsP99Key;
+FOUNDATION_EXPORT NSString *const LabQLiteStatementStatisticsMaxKey;
+
+#pragma mark - Open Modes
+
+/**
+ @abstract How the low-level database file is opened.
+ 
+ @constant LabQLiteDatabaseOpenModeReadWrite Read-write, created
+ if missing (sqlite3_open).
+ 
+ @constant LabQLiteDatabaseOpenModeReadOnly SQLITE_OPEN_READONLY;
+ other connections may still change the file. Statements which
+ would write fail with LabQLiteErrorDatabaseReadOnly before they
+ run.
+ 
+ @constant LabQLiteDatabaseOpenModeImmutable Read-only with the
+ `immutable=1` URI parameter: SQLite assumes the file can never
+ change and skips locking and journal/WAL checks altogether.
+ Suitable for files inside the app bundle. Writes fail as in
+ LabQLiteDatabaseOpenModeReadOnly.
+ 
+ @constant LabQLiteDatabaseOpenModeInMemory The file is copied into
+ a private in-memory database when the LabQLiteDatabase is
+ initialized, and every statement runs against that copy from then
+ on. Committed writes are copied back to the file as set by
+ writeThrough. Only suitable for databases which fit in memory and
+ which no other process writes to.
+ */
+typedef enum {
+    LabQLiteDatabaseOpenModeReadWrite = 0,
+    LabQLiteDatabaseOpenModeReadOnly,
+    LabQLiteDatabaseOpenModeImmutable,
+    LabQLiteDatabaseOpenModeInMemory
+} LabQLiteDatabaseOpenMode;
+
+/**
+ @abstract When the in-memory mode copies committed writes back to
+ the file.
+ 
+ @constant LabQLiteWriteThroughSynchronous Before the statement
+ which committed them returns. A statement whose writes could not
+ be copied fails, although the in-memory database keeps them.
+ 
+ @constant LabQLiteWriteThroughDeferred On a background queue,
+ LABQLITE_WRAPPER_IN_MEMORY_FLUSH_DELAY_SECONDS after the first
+ commit; later commits are coalesced into the same flush. Failures
+ are reported through lastWriteThroughError.
+ */
+typedef enum {
+    LabQLiteWriteThroughSynchronous = 0,
+    LabQLiteWriteThroughDeferred
+} LabQLiteWriteThrough;
+
+#pragma mark - Row Enumeration Options
+
+/**
+ @abstract Options of
+ enumerateRowsOfStatement:bindableValues:affinityTypes:options:insulatedly:error:usingBlock:.
+ 
+ @constant LabQLiteRowEnumerationBorrowColumnBuffers TEXT and BLOB
+ values (and the row array itself) are views of SQLite's buffers
+ for the current row, valid only until the block returns. Send
+ -copy to any value that must outlive the block.
+ */
+typedef enum {
+    LabQLiteRowEnumerationOptionsNone = 0,
+    LabQLiteRowEnumerationBorrowColumnBuffers = 1 << 0
+} LabQLiteRowEnumerationOptions;
 
 #pragma mark - LabQLiteDatabase Class
 
@@ -87,19 +194,106 @@ FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchVal
 @property (nonatomic) NSString *databasePath;
 
 /**
- @abstract Date formatter which formats dates to the format
- that SQLite3 expects.
+ @abstract Date formatter using `yyyy-MM-dd HH:mm:ss ZZZZ`,
+ created on first use.
+
+ @discussion Kept for callers which format dates themselves;
+ LabQLite binds and decodes dates with LabQLiteDateCodec.
  */
 @property (nonatomic) NSDateFormatter *defaultIODateFormatter;
 
+/**
+ @abstract How long, in milliseconds, a statement waits on a
+ database locked by another connection before failing with
+ SQLITE_BUSY. Zero (the default) fails immediately.
+
+ @discussion Applied with sqlite3_busy_timeout each time the
+ low-level database is opened.
+ */
+@property (nonatomic) int busyTimeout;
+
+/**
+ @abstract How the low-level database is opened. Defaults to
+ LabQLiteDatabaseOpenModeReadWrite.
+ */
+@property (nonatomic) LabQLiteDatabaseOpenMode openMode;
+
+/**
+ @abstract If positive, the number of bytes of the database file
+ SQLite may memory-map (PRAGMA mmap_size), applied each time the
+ low-level database is opened. Zero keeps SQLite's default.
+ */
+@property (nonatomic) long long mmapSize;
+
+/**
+ @abstract Whether LIKE compares ASCII letters case-sensitively
+ (PRAGMA case_sensitive_like), applied each time the low-level
+ database is opened. Defaults to NO, SQLite's default.
+
+ @discussion LabQLiteDatabaseController range-rewrites LIKE prefix
+ stipulations with the collation matching this setting: BINARY
+ when YES, NOCASE when NO. It does so only on columns of declared
+ TEXT affinity which lead an index of that collation, so with the
+ default of NO an index such as `(name COLLATE NOCASE)` is needed;
+ an ordinary BINARY index is not seeked by the NOCASE range.
+ */
+@property (nonatomic) BOOL caseSensitiveLike;
+
+/**
+ @abstract In LabQLiteDatabaseOpenModeInMemory, when committed
+ writes reach the file. Defaults to LabQLiteWriteThroughSynchronous.
+ */
+@property (nonatomic) LabQLiteWriteThrough writeThrough;
+
+/**
+ @abstract The error of the last deferred write-through which
+ failed, if any. The writes stay pending and are retried with the
+ next flush.
+ */
+@property (nonatomic, readonly) NSError *lastWriteThroughError;
+
+/**
+ @abstract In LabQLiteDatabaseOpenModeInMemory, copies the in-memory
+ database to the file now, with the backup API. Does nothing in the
+ other modes.
+ 
+ @discussion Call before the process may be suspended if
+ writeThrough is LabQLiteWriteThroughDeferred.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ */
+- (BOOL)flushToDisk:(NSError **)error;
+
 /**
  @abstract Opens the sqlite3 low-level database.
  
+ @discussion The first successful open also runs PRAGMA
+ schema_version, failing with
+ LabQLiteErrorDatabasePathPointsToNonDatabase if the file is not a
+ usable database. The time spent validating is added to the
+ LabQLiteMetricSchemaValidationNanoseconds counter.
+ 
  @param error Standard error-capturing double
  indirection pointer.
  */
 - (BOOL)openDatabase:(NSError **)error;
 
+/**
+ @abstract Opens another low-level connection to the database
+ file, in the same mode and with the same busy timeout and mmap
+ size as openDatabase:, for work which must not share the
+ database property (e.g. an online backup running on another
+ queue). The schema is not validated again.
+ 
+ @param connection Receives the connection, which the caller
+ closes with sqlite3_close.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ */
+- (BOOL)openConnection:(sqlite3 **)connection error:(NSError **)error;
+
 /**
  @abstract Closes the sqlite3 low-level database.
  
@@ -198,12 +392,83 @@ FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchVal
 - (NSArray *)processStatement:(NSString *)sqlStatement
                         error:(NSError **)error;
 
+/**
+ @abstract Processes one data-modifying statement (e.g. an
+ INSERT) once for every row of bindable values, preparing it
+ only once.
+ 
+ @discussion The prepared statement is bound, stepped and reset
+ for each row, which avoids re-preparing the same SQL per row.
+ The database is expected to be open already; wrapping the call
+ in a transaction avoids a journal sync per row.
+ 
+ @param sqlStatement The SQL statement to be processed.
+ 
+ @param bindableValueRows An array of arrays, each holding the
+ values to be bound for one execution.
+ 
+ @param columnAffinityTypes The column affinity types shared by
+ every row of bindable values.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ 
+ @return Whether or not every row was processed. Processing
+ stops at the first failing row.
+ */
+- (BOOL)processStatement:(NSString *)sqlStatement
+       bindableValueRows:(NSArray *)bindableValueRows
+           affinityTypes:(NSArray *)columnAffinityTypes
+                   error:(NSError **)error;
+
+/**
+ @abstract Steps through the results of a SQL statement one row at
+ a time, handing each row to the provided block instead of
+ collecting every row into memory first.
+ 
+ @param sqlStatement The SQL statement to process.
+ 
+ @param bindableValues The values to bind, or nil.
+ 
+ @param columnAffinityTypes The affinity types of the bindable
+ values, or nil.
+ 
+ @param options LabQLiteRowEnumerationBorrowColumnBuffers avoids
+ copying TEXT and BLOB cells; see LabQLiteRowEnumerationOptions.
+ 
+ @param shouldAutoOpenAndCloseDatabase Whether or not to open the
+ database before and close it after the enumeration.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ 
+ @param block Called once per row with an array of cell values in
+ column order. Setting *stop to YES ends the enumeration early.
+ 
+ @return Whether or not the enumeration ran to completion or was
+ stopped by the block.
+ */
+- (BOOL)enumerateRowsOfStatement:(NSString *)sqlStatement
+                  bindableValues:(NSArray *)bindableValues
+                   affinityTypes:(NSArray *)columnAffinityTypes
+                         options:(LabQLiteRowEnumerationOptions)options
+                     insulatedly:(BOOL)shouldAutoOpenAndCloseDatabase
+                           error:(NSError **)error
+                      usingBlock:(void (^)(NSArray *row, BOOL *stop))block;
+
 
 
 /**
  @abstract Basic initialization - initializes a low-level sqlite3
  database found at the provided path.
  
+ @discussion Nothing is opened here: only the first bytes of the
+ file are checked against the SQLite header. The low-level
+ database is opened by the first statement, which also reads
+ PRAGMA schema_version once to validate the schema; see
+ openDatabase:. A missing or empty file is accepted, as SQLite
+ creates it.
+ 
  @param pathToDatabaseFile The path to the low-level sqlite3 database
  file.
  
@@ -215,6 +480,27 @@ FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchVal
 - (instancetype)initWithPath:(NSString *)pathToDatabaseFile
                        error:(NSError **)error;
 
+/**
+ @abstract Initializes a low-level sqlite3 database found at the
+ provided path, opened in the provided mode.
+ 
+ @discussion Validated as by initWithPath:error:, except that a
+ missing or empty file is rejected in the read-only modes.
+ 
+ @param pathToDatabaseFile The path to the low-level sqlite3 database
+ file.
+ 
+ @param openMode See LabQLiteDatabaseOpenMode.
+ 
+ @param error Standard error-capturing double
+ indirection pointer.
+ 
+ @return A new LabQLiteDatabase object.
+ */
+- (instancetype)initWithPath:(NSString *)pathToDatabaseFile
+                    openMode:(LabQLiteDatabaseOpenMode)openMode
+                       error:(NSError **)error;
+
 /**
  @abstract Provides the corresponding LabQLiteError error message
  based on the provided error code.
@@ -239,5 +525,136 @@ FOUNDATION_EXPORT NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchVal
 - (NSString *)insertionStatementFromSQLite3RowMappable:(id <LabQLiteRowMappable>)rowMappable;
 
 
+
+#pragma mark - Query Plan Diagnostics
+
+/**
+ @abstract Whether query plans of generated statements should
+ be captured. Defaults to NO.
+
+ @discussion While enabled, the database controller hands each
+ SELECT, DELETE and UPDATE statement it generates to
+ captureQueryPlanForStatement:table:stipulations:orderingColumn:insulatedly:
+ before processing it. Each distinct statement shape is only
+ explained once.
+ */
+@property (nonatomic) BOOL queryPlanDiagnosticsEnabled;
+
+/**
+ @abstract Returns a normalized form of the provided SQL statement
+ in which numeric and string literals are replaced by `?` and
+ runs of whitespace are collapsed. Statements which differ only
+ in their literal values share a fingerprint.
+
+ @param sqlStatement The SQL statement to fingerprint.
+
+ @return The fingerprint of the statement.
+ */
++ (NSString *)fingerprintForStatement:(NSString *)sqlStatement;
+
+/**
+ @abstract Runs `EXPLAIN QUERY PLAN` for the provided statement
+ (unless its shape has already been explained) and records
+ whether it scans the whole table or sorts into a temporary
+ B-tree.
+
+ @param sqlStatement The SQL statement to explain. Any `?`
+ parameters are left unbound.
+
+ @param tableName The table the statement operates on.
+
+ @param stipulations The LabQLiteStipulations the statement was
+ generated from. The attributes of their equality constraints are
+ the candidate index columns, unless any of them is OR-ed in.
+
+ @param orderingColumn The ORDER BY clause, if any: one column or
+ a comma-separated list, each optionally followed by ASC or DESC.
+
+ @param shouldAutoOpenAndCloseDatabase Whether the statement is
+ to be run insulatedly. If so, it is explained on the connection
+ processStatement: opens to run it, right before it runs, rather
+ than on a connection of its own. Otherwise it is explained right
+ away on the open connection.
+
+ @return Whether the plan was captured or set to be captured along
+ with the statement (NO when diagnostics are disabled, the shape
+ was already captured or explaining failed).
+ */
+- (BOOL)captureQueryPlanForStatement:(NSString *)sqlStatement
+                               table:(NSString *)tableName
+                        stipulations:(NSArray *)stipulations
+                      orderingColumn:(NSString *)orderingColumn
+                         insulatedly:(BOOL)shouldAutoOpenAndCloseDatabase;
+
+/**
+ @abstract The captured query plans, one dictionary per distinct
+ statement shape.
+
+ @see LabQLiteQueryPlanStatementKey
+ */
+- (NSArray *)queryPlanDiagnostics;
+
+/**
+ @abstract Suggests `CREATE INDEX IF NOT EXISTS` statements for
+ every captured statement shape that scanned its whole table or
+ sorted into a temporary B-tree.
+
+ @discussion Columns constrained by equality come first, then
+ the ORDER BY columns without their sort direction. Stipulations
+ connected by OR contribute no columns, as no index column then
+ narrows every match; nor do LIKE, inequality or MATCH ones.
+ Duplicate suggestions are folded together.
+
+ @return The suggested index creation statements.
+ */
+- (NSArray *)suggestedIndexStatements;
+
+/**
+ @abstract A human-readable report of the flagged statement shapes
+ and the suggested indexes.
+ */
+- (NSString *)queryPlanDiagnosticsReport;
+
+/**
+ @abstract Forgets every captured query plan.
+ */
+- (void)resetQueryPlanDiagnostics;
+
+
+
+#pragma mark - Statement Statistics
+
+/**
+ @abstract Whether the wall time of every statement should be
+ recorded. Defaults to NO.
+
+ @discussion Timing is collected through sqlite3_trace_v2 with
+ SQLITE_TRACE_PROFILE (sqlite3_profile where the SQLite headers
+ predate 3.14), which is registered on the low-level connection
+ when it is opened; a change takes effect the next time the
+ database is opened. Durations are kept in one
+ LabQLiteLatencyHistogram per statement fingerprint, shared by
+ every thread under one lock and released with the database.
+
+ @see fingerprintForStatement:
+ */
+@property (nonatomic) BOOL statementTimingEnabled;
+
+/**
+ @abstract Returns the recorded statement timings.
+
+ @return A dictionary mapping each statement fingerprint to a
+ dictionary holding its count, mean, p50, p95, p99 and max.
+
+ @see LabQLiteStatementStatisticsCountKey
+ */
+- (NSDictionary *)statisticsSnapshot;
+
+/**
+ @abstract Forgets every recorded statement timing.
+ */
+- (void)resetStatistics;
+
+
 @end
 
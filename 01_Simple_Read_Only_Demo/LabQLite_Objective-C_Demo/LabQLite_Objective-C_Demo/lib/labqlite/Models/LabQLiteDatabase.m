@@ -28,6 +28,29 @@ For more information, please refer to <http://unlicense.org>
 
 
 #import "LabQLiteDatabase.h"
+#import "LabQLiteMetrics.h"
+#import "LabQLiteBlobHandle.h"
+#import "LabQLiteDateCodec.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+
+
+/**
+ @abstract How a parameter is bound; mirrors the
+ SQLITE_AFFINITY_TYPE_ values.
+ */
+typedef enum {
+    LabQLiteBindKindInteger = 1,
+    LabQLiteBindKindText    = 2,
+    LabQLiteBindKindNone    = 3,
+    LabQLiteBindKindReal    = 4,
+    LabQLiteBindKindNumeric = 5
+} LabQLiteBindKind;
 
 
 
@@ -60,16 +83,30 @@ For more information, please refer to <http://unlicense.org>
 - (int)resultCodeFromPreparingStatement:(NSString *)sqlStatement
        addressOfLowLevelSQLiteStatement:(sqlite3_stmt **)address;
 
+/**
+ @abstract Whether the prepared statement may run in the open
+ mode: in the read-only modes, statements which would write
+ (sqlite3_stmt_readonly) are refused with
+ LabQLiteErrorDatabaseReadOnly rather than left to fail with
+ SQLITE_READONLY.
+ */
+- (BOOL)mayRunPreparedStatement:(sqlite3_stmt *)lowLevelStatement
+                   sqlStatement:(NSString *)sqlStatement
+                          error:(NSError **)error;
+
 /**
  @abstract Binds the provided values according to the
  provided affinity types to the provided low-level
  sqlite3_stmt.
  
- @discussion Binds the values provided in NSString, NSDate
- or NSNumber form to the provided lol-level sqlite3_stmt
- object using the provided affinity types. The appropriate
- sqlite3_bind method is used based on the provided affinity
- type. The provided affinity types array must be of the same
+ @discussion Binds the values provided in NSString, NSNumber,
+ NSData, NSDate or LabQLiteZeroBlob form to the provided
+ low-level sqlite3_stmt object. The sqlite3_bind function is
+ chosen by the class of each value: NSNumbers are bound as
+ 64-bit integers or doubles, NSData as BLOBs of their full
+ length and NSDates through LabQLiteDateCodec. The affinity
+ types decide how NSStrings bound to INTEGER and REAL columns
+ are converted and how NSDates are stored. The provided affinity types array must be of the same
  length as the provided bindableValues array. Index i of
  bindable values must have a value which is bindable according
  to the affinity type provided at index i of affinityTypes.
@@ -97,6 +134,30 @@ For more information, please refer to <http://unlicense.org>
        toStatement:(sqlite3_stmt *)lowLevelStatement
              error:(NSError **)error;
 
+/**
+ @abstract Translates affinity types into a bind plan once, so
+ that statements processed for many rows of values do not
+ re-examine the affinity NSNumbers for every row.
+ 
+ @param bindPlan Receives one LabQLiteBindKind per affinity type.
+ 
+ @return NO, with a LabQLiteErrorAffinityTypeUknown error, if an
+ affinity type is not one of the SQLITE_AFFINITY_TYPE_ values.
+ */
+- (BOOL)makeBindPlan:(LabQLiteBindKind *)bindPlan
+   fromAffinityTypes:(NSArray *)affinityTypes
+               error:(NSError **)error;
+
+/**
+ @abstract Binds the provided values according to a bind plan
+ made by makeBindPlan:fromAffinityTypes:error:.
+ */
+- (BOOL)bindValues:(NSArray *)bindableValues
+      withBindPlan:(const LabQLiteBindKind *)bindPlan
+             count:(NSUInteger)count
+       toStatement:(sqlite3_stmt *)lowLevelStatement
+             error:(NSError **)error;
+
 /**
  @abstract Gets the results for stepping through the prepared
  low-level sqlite3_stmt.
@@ -142,39 +203,659 @@ NSString *const LabQLiteErrorMessageMultipleErrors = @"Multiple database errors
 NSString *const LabQLiteErrorMessageDatabaseDoesNotExistInBundle = @"No SQLite database found at bundle path specified with which to create LabQLiteDatabase object.";
 NSString *const LabQLiteErrorMessageDatabasePathPointsToNonDatabase = @"Cannot perform operation because the file at the database path is not a database.";
 NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The number of columns and the number of values did not match.";
+NSString *const LabQLiteErrorMessageKeyColumnsCountDidNotMatchKeyValuesCount = @"The number of key columns and the number of values in a key tuple did not match.";
+NSString *const LabQLiteErrorMessageShardKeyChanged = @"The update would move the row to another shard.";
+NSString *const LabQLiteErrorMessageNoFullTextIndex = @"The class does not declare a full-text index.";
+NSString *const LabQLiteErrorMessageFullTextModuleUnavailable = @"The linked SQLite library was not built with the full-text module the index needs.";
+NSString *const LabQLiteErrorMessageDatabaseReadOnly = @"The database was opened read-only; the statement would write to it.";
+NSString *const LabQLiteErrorMessageNoShards = @"A sharded controller needs at least one database path.";
+
+NSString *const LabQLiteQueryPlanStatementKey = @"statement";
+NSString *const LabQLiteQueryPlanTableKey = @"table";
+NSString *const LabQLiteQueryPlanDetailsKey = @"details";
+NSString *const LabQLiteQueryPlanUsesFullTableScanKey = @"usesFullTableScan";
+NSString *const LabQLiteQueryPlanUsesTemporaryBTreeKey = @"usesTemporaryBTree";
+NSString *const LabQLiteQueryPlanSuggestedIndexColumnsKey = @"suggestedIndexColumns";
+
+NSString *const LabQLiteStatementStatisticsCountKey = @"count";
+NSString *const LabQLiteStatementStatisticsMeanKey = @"meanMicroseconds";
+NSString *const LabQLiteStatementStatisticsP50Key = @"p50Microseconds";
+NSString *const LabQLiteStatementStatisticsP95Key = @"p95Microseconds";
+NSString *const LabQLiteStatementStatisticsP99Key = @"p99Microseconds";
+NSString *const LabQLiteStatementStatisticsMaxKey = @"maxMicroseconds";
+
 
-@implementation LabQLiteDatabase
+
+@class LabQLiteStatementTimings;
+
+@interface LabQLiteDatabase ()
+
+/**
+ @abstract Captured query plans keyed by statement fingerprint.
+ */
+@property (nonatomic) NSMutableDictionary *capturedQueryPlans;
+
+/**
+ @abstract Query plans to capture on the connection opened for
+ the statement itself, keyed by statement.
+ */
+@property (nonatomic) NSMutableDictionary *pendingQueryPlanCaptures;
+
+/**
+ @abstract The statement timings of every thread, released with
+ the database.
+ */
+@property (nonatomic) LabQLiteStatementTimings *statementTimings;
+
+/**
+ @abstract Whether the schema has been read once, on the first
+ open of the low-level database.
+ */
+@property (nonatomic) BOOL schemaValidated;
+
+/**
+ @abstract The error reported when the database file fails
+ validation: LabQLiteErrorDatabasePathPointsToNonDatabase for
+ SQLITE_NOTADB, the low-level error otherwise.
+ */
++ (NSError *)validationErrorForCode:(int)errorCode path:(NSString *)path;
+
+/**
+ @abstract The error of the last deferred write-through which
+ failed, if any.
+ */
+@property (nonatomic, readwrite) NSError *lastWriteThroughError;
+
+/**
+ @abstract Closes the low-level database after a failed statement
+ without reporting errors. The in-memory database stays open.
+ */
+- (void)closeDatabaseQuietly;
+
+/**
+ @abstract Copies the disk file into a new in-memory database.
+ */
+- (BOOL)hydrateInMemoryDatabase:(NSError **)error;
+
+/**
+ @abstract Writes the in-memory database back to disk if a write
+ was committed since the last flush and no transaction is open:
+ right away, or later on the write-through queue.
+ */
+- (BOOL)writeThroughIfNeeded:(NSError **)error;
+
+/**
+ @abstract flushToDisk:, for callers already on the write-through
+ queue.
+ */
+- (BOOL)flushToDiskOnWriteThroughQueue:(NSError **)error;
+
+/**
+ @abstract Records the duration of one statement execution.
+ */
+- (void)recordDuration:(uint64_t)nanoseconds
+          forStatement:(const char *)sqlStatement;
+
+/**
+ @abstract Runs `EXPLAIN QUERY PLAN` for the provided statement on
+ the open connection and records the plan under the fingerprint.
+ */
+- (BOOL)explainStatement:(NSString *)sqlStatement
+             fingerprint:(NSString *)fingerprint
+                   table:(NSString *)tableName
+            stipulations:(NSArray *)stipulations
+          orderingColumn:(NSString *)orderingColumn;
+
+/**
+ @abstract Explains the provided statement if its plan was set to
+ be captured along with it. The connection must be open.
+ */
+- (void)capturePendingQueryPlanForStatement:(NSString *)sqlStatement;
+
+@end
+
+
+
+#if SQLITE_VERSION_NUMBER >= 3014000
+
+/**
+ @abstract sqlite3_trace_v2 callback; forwards each finished
+ statement's wall time (SQLITE_TRACE_PROFILE) to the owning
+ LabQLiteDatabase.
+ */
+static int LabQLiteDatabaseTraceCallback(unsigned traceType, void *context, void *statement, void *nanoseconds) {
+    if (traceType == SQLITE_TRACE_PROFILE) {
+        LabQLiteDatabase *database = (__bridge LabQLiteDatabase *)context;
+        [database recordDuration:(uint64_t)*(sqlite3_int64 *)nanoseconds
+                    forStatement:sqlite3_sql((sqlite3_stmt *)statement)];
+    }
+    return 0;
+}
+
+#else
+
+/**
+ @abstract sqlite3_profile callback, for SQLite older than 3.14
+ which lacks sqlite3_trace_v2.
+ */
+static void LabQLiteDatabaseProfileCallback(void *context, const char *sqlStatement, sqlite3_uint64 nanoseconds) {
+    LabQLiteDatabase *database = (__bridge LabQLiteDatabase *)context;
+    [database recordDuration:nanoseconds forStatement:sqlStatement];
+}
+
+#endif
+
+/**
+ @abstract Registers the statement timing callback of the provided
+ database on the provided connection.
+ */
+static void LabQLiteDatabaseTimeStatements(sqlite3 *connection, LabQLiteDatabase *database) {
+#if SQLITE_VERSION_NUMBER >= 3014000
+    sqlite3_trace_v2(connection, SQLITE_TRACE_PROFILE, LabQLiteDatabaseTraceCallback, (__bridge void *)database);
+#else
+    sqlite3_profile(connection, LabQLiteDatabaseProfileCallback, (__bridge void *)database);
+#endif
+}
+
+/**
+ @abstract The statement timings recorded on one LabQLiteDatabase:
+ latency histograms keyed by fingerprint, and fingerprints keyed by
+ raw SQL so that the generated statements are only normalized once.
+ 
+ @discussion Every thread records under the one lock, which is
+ held for a dictionary lookup and an O(1) histogram update.
+ */
+@interface LabQLiteStatementTimings : NSObject
+
+@property (nonatomic, readonly) NSLock *lock;
+@property (nonatomic, readonly) NSMutableDictionary *histograms;
+@property (nonatomic, readonly) NSMutableDictionary *fingerprintsBySQL;
+
+@end
+
+@implementation LabQLiteStatementTimings
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _lock = [NSLock new];
+        _histograms = [NSMutableDictionary new];
+        _fingerprintsBySQL = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+@end
+
+/**
+ @abstract sqlite3_commit_hook of the in-memory database; marks it
+ as holding writes which are not on disk yet.
+ */
+static int LabQLiteInMemoryCommitHook(void *context) {
+    atomic_store_explicit((atomic_int *)context, 1, memory_order_relaxed);
+    return 0;
+}
+
+static uint64_t LabQLiteMonotonicNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ @abstract Checks the first 16 bytes of the file at the provided
+ path against the SQLite header string, without opening it as a
+ database.
+
+ @return SQLITE_OK for an SQLite file, and for a missing or empty
+ one if it may be created (SQLite writes the header on the first
+ write); SQLITE_CANTOPEN for a missing file which may not be
+ created or an unreadable one; SQLITE_NOTADB otherwise.
+ */
+static int LabQLiteDatabaseFileHeaderCheck(NSString *path, BOOL mayCreate) {
+    int descriptor = open([path fileSystemRepresentation], O_RDONLY);
+    if (descriptor < 0) {
+        return (errno == ENOENT && mayCreate) ? SQLITE_OK : SQLITE_CANTOPEN;
+    }
+    char header[16];
+    ssize_t readCount = pread(descriptor, header, sizeof(header), 0);
+    close(descriptor);
+    if (readCount == 0 && mayCreate) return SQLITE_OK;
+    if (readCount != (ssize_t)sizeof(header) || memcmp(header, "SQLite format 3", sizeof(header)) != 0) {
+        return SQLITE_NOTADB;
+    }
+    return SQLITE_OK;
+}
+
+
+
+#pragma mark - Column Decoding
+
+/**
+ @abstract How a result column is turned into an object. Decided
+ once per statement from the column's declared type.
+ */
+typedef enum {
+    LabQLiteColumnDecodingText = 0,
+    LabQLiteColumnDecodingInteger,
+    LabQLiteColumnDecodingReal,
+    LabQLiteColumnDecodingBlob,
+    LabQLiteColumnDecodingNumeric
+} LabQLiteColumnDecoding;
+
+static BOOL LabQLiteDeclaredTypeContains(const char *declaredType, const char *keyword) {
+    size_t keywordLength = strlen(keyword);
+    for (const char *c = declaredType; *c != '\0'; c++) {
+        if (strncasecmp(c, keyword, keywordLength) == 0) return YES;
+    }
+    return NO;
+}
+
+/**
+ @abstract Maps a declared column type onto its decoding: TEXT if
+ it mentions CHAR, CLOB or TEXT; INTEGER if INT; REAL if REAL, FLOA
+ or DOUB; BLOB if BLOB; NUMERIC otherwise (including expression
+ columns, which have no declared type).
+ */
+static LabQLiteColumnDecoding LabQLiteColumnDecodingForDeclaredType(const char *declaredType) {
+    if (declaredType == NULL) return LabQLiteColumnDecodingNumeric;
+    if (LabQLiteDeclaredTypeContains(declaredType, "CHAR") ||
+        LabQLiteDeclaredTypeContains(declaredType, "CLOB") ||
+        LabQLiteDeclaredTypeContains(declaredType, "TEXT")) {
+        return LabQLiteColumnDecodingText;
+    }
+    if (LabQLiteDeclaredTypeContains(declaredType, "INT")) return LabQLiteColumnDecodingInteger;
+    if (LabQLiteDeclaredTypeContains(declaredType, "REAL") ||
+        LabQLiteDeclaredTypeContains(declaredType, "FLOA") ||
+        LabQLiteDeclaredTypeContains(declaredType, "DOUB")) {
+        return LabQLiteColumnDecodingReal;
+    }
+    if (LabQLiteDeclaredTypeContains(declaredType, "BLOB")) return LabQLiteColumnDecodingBlob;
+    return LabQLiteColumnDecodingNumeric;
+}
+
+/**
+ @abstract An NSString over a column's UTF-8 buffer, which it does
+ not own. -copy returns a string with its own storage.
+ */
+@interface LabQLiteBorrowedString : NSString {
+    const char *_bytes;
+    NSUInteger _byteLength;
+    NSString *_view;
+}
+
+- (instancetype)initWithBytesNoCopy:(const char *)bytes
+                             length:(NSUInteger)length;
+
+@end
+
+@implementation LabQLiteBorrowedString
+
+- (instancetype)initWithBytesNoCopy:(const char *)bytes
+                             length:(NSUInteger)length {
+    self = [super init];
+    if (self) {
+        _bytes = bytes;
+        _byteLength = length;
+        _view = [[NSString alloc] initWithBytesNoCopy:(void *)bytes
+                                               length:length
+                                             encoding:NSUTF8StringEncoding
+                                         freeWhenDone:NO];
+        if (_view == nil) _view = @"";
+    }
+    return self;
+}
+
+- (NSUInteger)length {
+    return [_view length];
+}
+
+- (unichar)characterAtIndex:(NSUInteger)index {
+    return [_view characterAtIndex:index];
+}
+
+- (void)getCharacters:(unichar *)buffer range:(NSRange)range {
+    [_view getCharacters:buffer range:range];
+}
+
+- (const char *)UTF8String {
+    return _bytes;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[NSString alloc] initWithBytes:_bytes
+                                    length:_byteLength
+                                  encoding:NSUTF8StringEncoding];
+}
+
+@end
+
+/**
+ @abstract An NSData over a column's buffer, which it does not own.
+ -copy returns data with its own storage.
+ */
+@interface LabQLiteBorrowedData : NSData {
+    const void *_bytes;
+    NSUInteger _length;
+}
+
+- (instancetype)initWithBytesNoCopy:(const void *)bytes
+                             length:(NSUInteger)length;
+
+@end
+
+@implementation LabQLiteBorrowedData
+
+- (instancetype)initWithBytesNoCopy:(const void *)bytes
+                             length:(NSUInteger)length {
+    self = [super init];
+    if (self) {
+        _bytes = bytes;
+        _length = length;
+    }
+    return self;
+}
+
+- (const void *)bytes {
+    return _bytes;
+}
+
+- (NSUInteger)length {
+    return _length;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[NSData alloc] initWithBytes:_bytes length:_length];
+}
+
+@end
+
+/**
+ @abstract Decodes one cell of the current row, tallying the work
+ into the provided LabQLiteMetric-indexed counters. With borrowing,
+ TEXT and BLOB cells are views valid until the next step.
+ */
+static id LabQLiteObjectForColumn(sqlite3_stmt *statement,
+                                  int column,
+                                  LabQLiteColumnDecoding decoding,
+                                  BOOL borrowing,
+                                  uint64_t *tallies) {
+    if (sqlite3_column_type(statement, column) == SQLITE_NULL) {
+        tallies[LabQLiteMetricNullCellsDecoded]++;
+        return [NSNull null];
+    }
+    switch (decoding) {
+        case LabQLiteColumnDecodingInteger:
+            tallies[LabQLiteMetricIntegerCellsDecoded]++;
+            return [NSNumber numberWithLongLong:sqlite3_column_int64(statement, column)];
+        case LabQLiteColumnDecodingReal:
+            tallies[LabQLiteMetricRealCellsDecoded]++;
+            return [NSNumber numberWithDouble:sqlite3_column_double(statement, column)];
+        case LabQLiteColumnDecodingBlob: {
+            const void *bytes = sqlite3_column_blob(statement, column);
+            NSUInteger length = (NSUInteger)sqlite3_column_bytes(statement, column);
+            tallies[LabQLiteMetricBlobCellsDecoded]++;
+            if (borrowing) {
+                return [[LabQLiteBorrowedData alloc] initWithBytesNoCopy:bytes length:length];
+            }
+            tallies[LabQLiteMetricBlobBytesMaterialized] += length;
+            return [NSData dataWithBytes:bytes length:length];
+        }
+        default: {
+            const char *text = (const char *)sqlite3_column_text(statement, column);
+            NSUInteger length = (NSUInteger)sqlite3_column_bytes(statement, column);
+            tallies[decoding == LabQLiteColumnDecodingText ? LabQLiteMetricTextCellsDecoded : LabQLiteMetricNumericCellsDecoded]++;
+            if (borrowing) {
+                return [[LabQLiteBorrowedString alloc] initWithBytesNoCopy:text length:length];
+            }
+            tallies[LabQLiteMetricTextBytesMaterialized] += length;
+            NSString *string = [[NSString alloc] initWithBytes:text
+                                                        length:length
+                                                      encoding:NSUTF8StringEncoding];
+            return string != nil ? string : @"";
+        }
+    }
+}
+
+/**
+ @abstract Publishes decoding tallies to the library metrics.
+ */
+static void LabQLitePublishDecodingTallies(uint64_t rowsStepped, const uint64_t *tallies) {
+    LabQLiteMetricsAdd(LabQLiteMetricRowsStepped, rowsStepped);
+    for (int metric = 0; metric < LabQLiteMetricCount; metric++) {
+        if (tallies[metric] > 0) {
+            LabQLiteMetricsAdd((LabQLiteMetric)metric, tallies[metric]);
+        }
+    }
+}
+
+
+
+#pragma mark - Value Binding
+
+/**
+ @abstract Binds a string as TEXT with its full UTF-8 byte length,
+ embedded NULs included.
+ */
+static int LabQLiteBindText(sqlite3_stmt *statement, int index, NSString *string) {
+    return sqlite3_bind_text(statement, index, [string UTF8String],
+                             (int)[string lengthOfBytesUsingEncoding:NSUTF8StringEncoding], SQLITE_TRANSIENT);
+}
+
+/**
+ @abstract Whether the whole string, leading and trailing spaces
+ aside, is a base-10 integer within the 64-bit range.
+ */
+static BOOL LabQLiteScanInteger(const char *text, sqlite3_int64 *integer) {
+    char *end = NULL;
+    errno = 0;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || errno == ERANGE) return NO;
+    while (*end == ' ') end++;
+    if (*end != '\0') return NO;
+    *integer = value;
+    return YES;
+}
+
+/**
+ @abstract Whether the whole string, leading and trailing spaces
+ aside, is a finite decimal number. Hexadecimal, infinities and
+ NaN are refused, as SQLite would keep those as text.
+ */
+static BOOL LabQLiteScanReal(const char *text, double *real) {
+    if (strpbrk(text, "xXnN") != NULL) return NO;
+    char *end = NULL;
+    errno = 0;
+    double value = strtod(text, &end);
+    if (end == text || errno == ERANGE || !isfinite(value)) return NO;
+    while (*end == ' ') end++;
+    if (*end != '\0') return NO;
+    *real = value;
+    return YES;
+}
+
+/**
+ @abstract Binds one value, dispatching on its class. The bind
+ kind (the column affinity) only decides how numeric strings are
+ coerced for INTEGER and REAL columns and how dates are stored;
+ numbers, data and other strings are bound natively and SQLite
+ applies the column affinity.
+ */
+static int LabQLiteBindValue(sqlite3_stmt *statement, int index, id value, LabQLiteBindKind kind) {
+    static Class stringClass, numberClass, dataClass, dateClass, zeroBlobClass;
+    static id null;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        stringClass = [NSString class];
+        numberClass = [NSNumber class];
+        dataClass = [NSData class];
+        dateClass = [NSDate class];
+        zeroBlobClass = [LabQLiteZeroBlob class];
+        null = [NSNull null];
+    });
+    
+    if (value == nil || value == null) {
+        return sqlite3_bind_null(statement, index);
+    }
+    if ([value isKindOfClass:stringClass]) {
+        // Only strings which are numbers through and through are
+        // coerced; "abc" or "1.5" for an INTEGER column are bound as
+        // text and left to the column affinity, like any other text.
+        sqlite3_int64 integer;
+        double real;
+        if (kind == LabQLiteBindKindInteger && LabQLiteScanInteger([value UTF8String], &integer)) {
+            return sqlite3_bind_int64(statement, index, integer);
+        }
+        if (kind == LabQLiteBindKindReal && LabQLiteScanReal([value UTF8String], &real)) {
+            return sqlite3_bind_double(statement, index, real);
+        }
+        return LabQLiteBindText(statement, index, value);
+    }
+    if ([value isKindOfClass:numberClass]) {
+        const char *type = [value objCType];
+        if (kind == LabQLiteBindKindReal || type[0] == 'd' || type[0] == 'f') {
+            return sqlite3_bind_double(statement, index, [value doubleValue]);
+        }
+        if (type[0] == 'Q') {
+            return sqlite3_bind_int64(statement, index, (sqlite3_int64)[value unsignedLongLongValue]);
+        }
+        return sqlite3_bind_int64(statement, index, [value longLongValue]);
+    }
+    if ([value isKindOfClass:dataClass]) {
+        return sqlite3_bind_blob(statement, index, [value bytes], (int)[value length], SQLITE_TRANSIENT);
+    }
+    if ([value isKindOfClass:dateClass]) {
+        switch ([LabQLiteDateCodec storageForAffinity:@(kind)]) {
+            case LabQLiteDateStorageUnixEpoch:
+                return sqlite3_bind_int64(statement, index, (sqlite3_int64)floor([value timeIntervalSince1970]));
+            case LabQLiteDateStorageJulianDay:
+                return sqlite3_bind_double(statement, index, [[LabQLiteDateCodec storageValueForDate:value
+                                                                                             storage:LabQLiteDateStorageJulianDay] doubleValue]);
+            default:
+                return LabQLiteBindText(statement, index, [LabQLiteDateCodec ISO8601StringFromDate:value]);
+        }
+    }
+    if ([value isKindOfClass:zeroBlobClass]) {
+        return sqlite3_bind_zeroblob(statement, index, (int)[(LabQLiteZeroBlob *)value length]);
+    }
+    return LabQLiteBindText(statement, index, [value description]);
+}
+
+
+@implementation LabQLiteDatabase {
+    sqlite3 *_inMemoryDatabase;
+    atomic_int _inMemoryDirty;
+    atomic_int _flushScheduled;
+    dispatch_queue_t _writeThroughQueue;
+}
 
 
 
 #pragma mark - Initialization
 
 - (instancetype)initWithPath:(NSString *)pathToDatabaseFile error:(NSError **)error {
+    return [self initWithPath:pathToDatabaseFile
+                     openMode:LabQLiteDatabaseOpenModeReadWrite
+                        error:error];
+}
+
+- (instancetype)initWithPath:(NSString *)pathToDatabaseFile
+                    openMode:(LabQLiteDatabaseOpenMode)openMode
+                       error:(NSError **)error {
     self = [super init];
     if (self) {
         _databasePath = [[NSString alloc] initWithString:pathToDatabaseFile];
-        if ([self openDatabase:error]) {
-            if ([self closeDatabase:error]) {
-                self.defaultIODateFormatter = [[NSDateFormatter alloc] init];
-                [self.defaultIODateFormatter setDateFormat:@"yyyy-MM-DD HH:mm:ss ZZZZ"];
-                NSError *e;
-                NSArray *t = [self processStatement:@"SELECT * FROM sqlite_master" insulatedly:YES error:&e];
-                if (t) {
-                    return self;
-                }
+        _openMode = openMode;
+        _statementTimings = [LabQLiteStatementTimings new];
+        
+        // Only the file header is checked here; the low-level
+        // database is first opened, and its schema read, by the
+        // first statement.
+        uint64_t start = LabQLiteMonotonicNanoseconds();
+        BOOL mayCreate = openMode == LabQLiteDatabaseOpenModeReadWrite || openMode == LabQLiteDatabaseOpenModeInMemory;
+        int resultCode = LabQLiteDatabaseFileHeaderCheck(_databasePath, mayCreate);
+        LabQLiteMetricsAdd(LabQLiteMetricSchemaValidationNanoseconds, LabQLiteMonotonicNanoseconds() - start);
+        if (resultCode != SQLITE_OK) {
+            if (error != NULL) {
+                *error = [LabQLiteDatabase validationErrorForCode:resultCode path:_databasePath];
             }
+            return nil;
+        }
+        
+        // The in-memory mode loads the whole file up front
+        if (openMode == LabQLiteDatabaseOpenModeInMemory && ![self hydrateInMemoryDatabase:error]) {
+            return nil;
         }
     }
-    return nil;
+    return self;
+}
+
+- (void)dealloc {
+    if (_inMemoryDatabase != NULL) {
+        if (atomic_load_explicit(&_inMemoryDirty, memory_order_relaxed)) {
+            [self flushToDiskOnWriteThroughQueue:NULL];
+        }
+        sqlite3_close(_inMemoryDatabase);
+    }
+}
+
+
+
+- (NSDateFormatter *)defaultIODateFormatter {
+    if (_defaultIODateFormatter == nil) {
+        _defaultIODateFormatter = [[NSDateFormatter alloc] init];
+        [_defaultIODateFormatter setLocale:[[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"]];
+        [_defaultIODateFormatter setDateFormat:@"yyyy-MM-dd HH:mm:ss ZZZZ"];
+    }
+    return _defaultIODateFormatter;
 }
 
 
 
 #pragma mark - Basic Low-Level Operations
 
-- (BOOL)openDatabase:(NSError **)error {
-    int errorCode = sqlite3_open([_databasePath UTF8String], &_database);
+/**
+ @abstract The `file:` URI of the database path with the query
+ parameters of the read-only open modes. Characters which are
+ special in URIs are percent-encoded.
+ */
+- (NSString *)readOnlyURIForOpenMode:(LabQLiteDatabaseOpenMode)openMode {
+    NSMutableData *bytes = [NSMutableData dataWithBytes:"file:" length:5];
+    const char *path = [_databasePath UTF8String];
+    for (const char *c = path; *c != '\0'; c++) {
+        if (*c == '%' || *c == '?' || *c == '#') {
+            char escape[4];
+            snprintf(escape, sizeof(escape), "%%%02X", (unsigned char)*c);
+            [bytes appendBytes:escape length:3];
+        }
+        else {
+            [bytes appendBytes:c length:1];
+        }
+    }
+    NSMutableString *uri = [[NSMutableString alloc] initWithData:bytes encoding:NSUTF8StringEncoding];
+    [uri appendString:@"?mode=ro"];
+    if (openMode == LabQLiteDatabaseOpenModeImmutable) {
+        [uri appendString:@"&immutable=1"];
+    }
+    return uri;
+}
+
+- (BOOL)openConnection:(sqlite3 **)connection error:(NSError **)error {
+    int errorCode;
+    if (_openMode == LabQLiteDatabaseOpenModeReadWrite || _openMode == LabQLiteDatabaseOpenModeInMemory) {
+        errorCode = sqlite3_open([_databasePath UTF8String], connection);
+    }
+    else {
+        errorCode = sqlite3_open_v2([[self readOnlyURIForOpenMode:_openMode] UTF8String],
+                                    connection,
+                                    SQLITE_OPEN_READONLY | SQLITE_OPEN_URI,
+                                    NULL);
+    }
     if (errorCode != SQLITE_OK) {
+        
+        // sqlite3_open hands back a handle even on failure
+        sqlite3_close(*connection);
+        *connection = NULL;
         if (error != NULL) {
             *error = [[NSError alloc] initWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
                                                 code:errorCode
@@ -182,15 +863,87 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
         }
         return FALSE;
     }
+    LabQLiteMetricsAdd(LabQLiteMetricConnectionOpens, 1);
+    if (self.busyTimeout > 0) {
+        sqlite3_busy_timeout(*connection, self.busyTimeout);
+    }
+    if (self.mmapSize > 0) {
+        NSString *pragma = [NSString stringWithFormat:@"PRAGMA mmap_size=%lld", self.mmapSize];
+        sqlite3_exec(*connection, [pragma UTF8String], NULL, NULL, NULL);
+    }
+    if (self.caseSensitiveLike) {
+        sqlite3_exec(*connection, "PRAGMA case_sensitive_like=ON", NULL, NULL, NULL);
+    }
+    return TRUE;
+}
+
+- (void)setCaseSensitiveLike:(BOOL)caseSensitiveLike {
+    _caseSensitiveLike = caseSensitiveLike;
+    
+    // The in-memory copy stays open, so it is not reconfigured
+    // by openConnection:error:.
+    if (_inMemoryDatabase != NULL) {
+        sqlite3_exec(_inMemoryDatabase,
+                     (caseSensitiveLike ? "PRAGMA case_sensitive_like=ON" : "PRAGMA case_sensitive_like=OFF"),
+                     NULL, NULL, NULL);
+    }
+}
+
+- (BOOL)openDatabase:(NSError **)error {
+    if (_inMemoryDatabase != NULL) {
+        _database = _inMemoryDatabase;
+        if (self.statementTimingEnabled) {
+            LabQLiteDatabaseTimeStatements(_database, self);
+        }
+        return TRUE;
+    }
+    if (![self openConnection:&_database error:error]) {
+        return FALSE;
+    }
+    int errorCode;
+    if (self.statementTimingEnabled) {
+        LabQLiteDatabaseTimeStatements(_database, self);
+    }
+    if (!self.schemaValidated) {
+        
+        // Reading the schema cookie makes SQLite parse the schema,
+        // so files which only look like databases fail here rather
+        // than in the middle of the first real statement.
+        uint64_t start = LabQLiteMonotonicNanoseconds();
+        errorCode = sqlite3_exec(_database, "PRAGMA schema_version", NULL, NULL, NULL);
+        LabQLiteMetricsAdd(LabQLiteMetricSchemaValidations, 1);
+        LabQLiteMetricsAdd(LabQLiteMetricSchemaValidationNanoseconds, LabQLiteMonotonicNanoseconds() - start);
+        if (errorCode != SQLITE_OK) {
+            sqlite3_close(_database);
+            _database = NULL;
+            LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+            if (error != NULL) {
+                *error = [LabQLiteDatabase validationErrorForCode:errorCode path:_databasePath];
+            }
+            return FALSE;
+        }
+        self.schemaValidated = YES;
+    }
     return TRUE;
 }
 
++ (NSError *)validationErrorForCode:(int)errorCode path:(NSString *)path {
+    NSString *errorDetails = [NSString stringWithFormat:@"Path: %@", path];
+    if (errorCode == SQLITE_NOTADB) {
+        return [NSError errorWithDomain:LabQLiteErrorDomain
+                                   code:LabQLiteErrorDatabasePathPointsToNonDatabase
+                               userInfo:@{@"errorMessage" : LabQLiteErrorMessageDatabasePathPointsToNonDatabase,
+                                          @"errorDetails" : errorDetails}];
+    }
+    return [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                               code:errorCode
+                           userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:errorCode],
+                                      @"errorDetails" : errorDetails}];
+}
+
 - (BOOL)closeDatabase:(NSError **)error {
-    NSArray *t = [self processStatement:@"SELECT * FROM sqlite_master"
-                            insulatedly:NO
-                                  error:error];
-    if (t == nil) {
-        return FALSE;
+    if (_inMemoryDatabase != NULL) {
+        return TRUE;
     }
     int errorCode = sqlite3_close(_database);
     if (errorCode != SQLITE_OK) {
@@ -201,9 +954,149 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
         }
         return FALSE;
     }
+    LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+    return TRUE;
+}
+
+- (void)closeDatabaseQuietly {
+    if (_inMemoryDatabase == NULL) {
+        sqlite3_close(_database);
+    }
+}
+
+
+
+#pragma mark - In-Memory Mode
+
+- (BOOL)hydrateInMemoryDatabase:(NSError **)error {
+    sqlite3 *disk = NULL;
+    if (![self openConnection:&disk error:error]) {
+        return NO;
+    }
+    
+    // An in-memory backup destination must use the page size of
+    // its source, and may only change it while still empty.
+    int resultCode = sqlite3_open(":memory:", &_inMemoryDatabase);
+    if (resultCode == SQLITE_OK) {
+        sqlite3_stmt *pageSizeStatement = NULL;
+        if (sqlite3_prepare_v2(disk, "PRAGMA page_size", -1, &pageSizeStatement, NULL) == SQLITE_OK &&
+            sqlite3_step(pageSizeStatement) == SQLITE_ROW) {
+            NSString *pragma = [NSString stringWithFormat:@"PRAGMA page_size=%d", sqlite3_column_int(pageSizeStatement, 0)];
+            sqlite3_exec(_inMemoryDatabase, [pragma UTF8String], NULL, NULL, NULL);
+        }
+        else {
+            resultCode = sqlite3_errcode(disk);
+        }
+        sqlite3_finalize(pageSizeStatement);
+    }
+    if (resultCode == SQLITE_OK) {
+        sqlite3_backup *backup = sqlite3_backup_init(_inMemoryDatabase, "main", disk, "main");
+        if (backup == NULL) {
+            resultCode = sqlite3_errcode(_inMemoryDatabase);
+        }
+        else {
+            resultCode = sqlite3_backup_step(backup, -1);
+            int finishCode = sqlite3_backup_finish(backup);
+            resultCode = resultCode == SQLITE_DONE ? finishCode : resultCode;
+        }
+    }
+    sqlite3_close(disk);
+    LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+    
+    if (resultCode != SQLITE_OK) {
+        sqlite3_close(_inMemoryDatabase);
+        _inMemoryDatabase = NULL;
+        if (error != NULL) {
+            *error = [LabQLiteDatabase validationErrorForCode:resultCode path:_databasePath];
+        }
+        return NO;
+    }
+    sqlite3_commit_hook(_inMemoryDatabase, LabQLiteInMemoryCommitHook, &_inMemoryDirty);
+    _writeThroughQueue = dispatch_queue_create("labqlite.database.write-through", DISPATCH_QUEUE_SERIAL);
+    self.schemaValidated = YES;
+    return YES;
+}
+
+- (BOOL)writeThroughIfNeeded:(NSError **)error {
+    if (_inMemoryDatabase == NULL ||
+        !atomic_load_explicit(&_inMemoryDirty, memory_order_relaxed) ||
+        !sqlite3_get_autocommit(_inMemoryDatabase)) {
+        return TRUE;
+    }
+    if (self.writeThrough == LabQLiteWriteThroughSynchronous) {
+        return [self flushToDisk:error];
+    }
+    
+    // Writes made before the flush runs are coalesced into it
+    if (!atomic_exchange_explicit(&_flushScheduled, 1, memory_order_relaxed)) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(LABQLITE_WRAPPER_IN_MEMORY_FLUSH_DELAY_SECONDS * NSEC_PER_SEC)),
+                       _writeThroughQueue, ^{
+            atomic_store_explicit(&self->_flushScheduled, 0, memory_order_relaxed);
+            NSError *flushError = nil;
+            if (![self flushToDiskOnWriteThroughQueue:&flushError]) {
+                self.lastWriteThroughError = flushError;
+            }
+        });
+    }
     return TRUE;
 }
 
+- (BOOL)flushToDisk:(NSError **)error {
+    if (_inMemoryDatabase == NULL) {
+        return TRUE;
+    }
+    __block BOOL flushed = NO;
+    __block NSError *flushError = nil;
+    dispatch_sync(_writeThroughQueue, ^{
+        flushed = [self flushToDiskOnWriteThroughQueue:&flushError];
+    });
+    if (!flushed && error != NULL) {
+        *error = flushError;
+    }
+    return flushed;
+}
+
+- (BOOL)flushToDiskOnWriteThroughQueue:(NSError **)error {
+    
+    // Cleared first: a commit made while the flush runs sets it
+    // again, and also restarts the backup.
+    atomic_store_explicit(&_inMemoryDirty, 0, memory_order_relaxed);
+    
+    sqlite3 *disk = NULL;
+    if (![self openConnection:&disk error:error]) {
+        atomic_store_explicit(&_inMemoryDirty, 1, memory_order_relaxed);
+        return NO;
+    }
+    int resultCode;
+    sqlite3_backup *backup = sqlite3_backup_init(disk, "main", _inMemoryDatabase, "main");
+    if (backup == NULL) {
+        resultCode = sqlite3_errcode(disk);
+    }
+    else {
+        do {
+            resultCode = sqlite3_backup_step(backup, -1);
+            if (resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED) {
+                sqlite3_sleep(LABQLITE_WRAPPER_BACKUP_STEP_PAUSE_MILLISECONDS);
+            }
+        } while (resultCode == SQLITE_OK || resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED);
+        int finishCode = sqlite3_backup_finish(backup);
+        resultCode = resultCode == SQLITE_DONE ? finishCode : resultCode;
+    }
+    if (resultCode != SQLITE_OK && error != NULL) {
+        *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                     code:resultCode
+                                 userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode],
+                                            @"errorDetails" : [NSString stringWithFormat:@"Write-through to %@: %s", _databasePath, sqlite3_errmsg(disk)]}];
+    }
+    sqlite3_close(disk);
+    LabQLiteMetricsAdd(LabQLiteMetricConnectionCloses, 1);
+    if (resultCode != SQLITE_OK) {
+        atomic_store_explicit(&_inMemoryDirty, 1, memory_order_relaxed);
+        return NO;
+    }
+    return YES;
+}
+
 #pragma mark - SQL Statement Processing Helpers
 
 - (int)resultCodeFromPreparingStatement:(NSString *)sqlStatement
@@ -214,42 +1107,55 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
                                  -1,
                                  address,
                                  NULL);
+    if (code == SQLITE_OK) {
+        LabQLiteMetricsAdd(LabQLiteMetricStatementsPrepared, 1);
+    }
     return code;
 }
 
+- (BOOL)mayRunPreparedStatement:(sqlite3_stmt *)lowLevelStatement
+                   sqlStatement:(NSString *)sqlStatement
+                          error:(NSError **)error {
+    if (_openMode != LabQLiteDatabaseOpenModeReadOnly && _openMode != LabQLiteDatabaseOpenModeImmutable) {
+        return YES;
+    }
+    if (sqlite3_stmt_readonly(lowLevelStatement) || [sqlStatement hasPrefix:@"EXPLAIN "]) {
+        return YES;
+    }
+    if (error != nil) {
+        *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                     code:LabQLiteErrorDatabaseReadOnly
+                                 userInfo:@{@"errorMessage" : LabQLiteErrorMessageDatabaseReadOnly,
+                                            @"errorDetails" : [NSString stringWithFormat:@"SQL statement: %@", sqlStatement]}];
+    }
+    return NO;
+}
+
 - (BOOL)bindValues:(NSArray *)bindableValues
  withAffinityTypes:(NSArray *)affinityTypes
        toStatement:(sqlite3_stmt *)lowLevelStatement
              error:(NSError **)error {
-    for (int i = 0; i < [affinityTypes count]; i++) {
-        id bindableValue = [bindableValues objectAtIndex:i];
-        NSNumber *columnAffinityType  = (NSNumber *)[affinityTypes objectAtIndex:i];
-    
-        if (bindableValue == [NSNull null]) {
-            sqlite3_bind_null(lowLevelStatement, (i + 1));
-        }
-        else if ([columnAffinityType isEqual:SQLITE_AFFINITY_TYPE_INTEGER]) {
-            bindableValue = (NSNumber *)bindableValue;
-            int bindable = [bindableValue intValue];
-            sqlite3_bind_int(lowLevelStatement,    (i + 1), bindable);
-        }
-        else if ([columnAffinityType isEqual:SQLITE_AFFINITY_TYPE_TEXT]) {
-            NSString *bindable = (NSString *)bindableValue;
-            sqlite3_bind_text(lowLevelStatement,   (i + 1), [bindable UTF8String], -1, NULL);
-        }
-        else if ([columnAffinityType isEqual:SQLITE_AFFINITY_TYPE_NONE]) {
-            NSData *bindable = (NSData *)bindableValue;
-            sqlite3_bind_blob(lowLevelStatement,   (i + 1), [bindable bytes], -1, NULL);
-        }
-        else if ([columnAffinityType isEqual:SQLITE_AFFINITY_TYPE_REAL]) {
-            double bindable = [bindableValue doubleValue];
-            sqlite3_bind_double(lowLevelStatement, (i + 1), bindable);
-        }
-        else if ([columnAffinityType isEqual:SQLITE_AFFINITY_TYPE_NUMERIC]) {
-            NSString *bindable = (NSString *)bindableValue;
-            sqlite3_bind_text(lowLevelStatement,   (i + 1), [bindable UTF8String], -1, NULL);
-        }
-        else {
+    NSUInteger count = [affinityTypes count];
+    LabQLiteBindKind bindPlan[count > 0 ? count : 1];
+    if (![self makeBindPlan:bindPlan
+          fromAffinityTypes:affinityTypes
+                      error:error]) {
+        return NO;
+    }
+    return [self bindValues:bindableValues
+               withBindPlan:bindPlan
+                      count:count
+                toStatement:lowLevelStatement
+                      error:error];
+}
+
+- (BOOL)makeBindPlan:(LabQLiteBindKind *)bindPlan
+   fromAffinityTypes:(NSArray *)affinityTypes
+               error:(NSError **)error {
+    NSUInteger i = 0;
+    for (NSNumber *columnAffinityType in affinityTypes) {
+        int affinity = [columnAffinityType isKindOfClass:[NSNumber class]] ? [columnAffinityType intValue] : 0;
+        if (affinity < LabQLiteBindKindInteger || affinity > LabQLiteBindKindNumeric) {
             NSString *domain = LabQLiteErrorDomain;
             int code = LabQLiteErrorAffinityTypeUknown;
             NSString *errorMessage = LabQLiteErrorMessageAffinityTypeUknown;
@@ -258,9 +1164,44 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
             NSDictionary *userInfo = @{@"errorMessage" : errorMessage,
                                        @"errorDetails" : errorDetails};
             
-            *error = [NSError errorWithDomain:domain
-                                         code:code
-                                     userInfo:userInfo];
+            if (error != NULL) {
+                *error = [NSError errorWithDomain:domain
+                                             code:code
+                                         userInfo:userInfo];
+            }
+            return NO;
+        }
+        bindPlan[i++] = (LabQLiteBindKind)affinity;
+    }
+    return YES;
+}
+
+- (BOOL)bindValues:(NSArray *)bindableValues
+      withBindPlan:(const LabQLiteBindKind *)bindPlan
+             count:(NSUInteger)count
+       toStatement:(sqlite3_stmt *)lowLevelStatement
+             error:(NSError **)error {
+    if ([bindableValues count] < count) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorBindableValuesCountDidNotMatchColumnAffinityTypesCount
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageBindableValuesCountDidNotMatchColumnAffinityTypesCount,
+                                                @"errorDetails" : @{@"bindableValuesCount" : @([bindableValues count]),
+                                                                    @"affinityTypesCount" : @(count)}}];
+        }
+        return NO;
+    }
+    for (NSUInteger i = 0; i < count; i++) {
+        int code = LabQLiteBindValue(lowLevelStatement, (int)(i + 1), [bindableValues objectAtIndex:i], bindPlan[i]);
+        if (code != SQLITE_OK) {
+            if (error != NULL) {
+                NSString *lowLevelErrorMessage = [NSString stringWithUTF8String:sqlite3_errmsg(_database)];
+                *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                             code:code
+                                         userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:code],
+                                                    @"errorDetails" : @{@"lowLevelErrorMessage" : lowLevelErrorMessage,
+                                                                        @"parameterIndex" : @(i + 1)}}];
+            }
             return NO;
         }
     }
@@ -273,6 +1214,19 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
     // Prepare an array to receive rows of data
     NSMutableArray *arrayOfRows = [[NSMutableArray alloc] init];
     
+    // Tally decoding work locally; it is published to the
+    // library metrics once the statement is done.
+    uint64_t rowsStepped = 0;
+    uint64_t tallies[LabQLiteMetricCount] = {0};
+    
+    // Declared types do not change from row to row, so the
+    // decoding of each column is determined once.
+    int m = sqlite3_column_count(lowLevelSQLStatement);
+    LabQLiteColumnDecoding decodings[m > 0 ? m : 1];
+    for (int i = 0; i < m; i++) {
+        decodings[i] = LabQLiteColumnDecodingForDeclaredType(sqlite3_column_decltype(lowLevelSQLStatement, i));
+    }
+    
     // Prepare to step through the low-level SQLite statement
     int stepValue = 0;
     stepValue = sqlite3_step(lowLevelSQLStatement);
@@ -280,84 +1234,17 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
     // Continuously step through the low-level SQLite statement
     // until done or until an error occurs
     while (stepValue == SQLITE_ROW) {
-        int m = sqlite3_column_count(lowLevelSQLStatement);
         NSMutableArray *row = [[NSMutableArray alloc] initWithCapacity:m];
         for (int i = 0; i < m; i++) {
-            const unsigned char *value = sqlite3_column_text(lowLevelSQLStatement, i);
-            const char *declType = sqlite3_column_decltype(lowLevelSQLStatement, i);
-            
-            NSString *declaredType = [NSString stringWithFormat:@"%s", declType];
-            
-            // Determine affinity type...
-            
-            // Determine if TEXT affinity exists..
-            NSRange rangeOfTEXTAffinitySubstringCHAR = [declaredType rangeOfString:@"CHAR" options:NSCaseInsensitiveSearch];
-            NSRange rangeOfTEXTAffinitySubstringCLOB = [declaredType rangeOfString:@"CLOB" options:NSCaseInsensitiveSearch];
-            NSRange rangeOfTEXTAffinitySubstringTEXT = [declaredType rangeOfString:@"TEXT" options:NSCaseInsensitiveSearch];
-            
-            BOOL isTEXTBecauseOfCHAR = rangeOfTEXTAffinitySubstringCHAR.location != NSNotFound;
-            BOOL isTEXTBecauseOfCLOB = rangeOfTEXTAffinitySubstringCLOB.location != NSNotFound;
-            BOOL isTEXTBecauseOfTEXT = rangeOfTEXTAffinitySubstringTEXT.location != NSNotFound;
-            
-            // Determine if INTEGER affinity exists
-            NSRange rangeOfINTAffinitySubstringINT = [declaredType rangeOfString:@"INT" options:NSCaseInsensitiveSearch];
-            
-            BOOL isINTBecauseOfINT = rangeOfINTAffinitySubstringINT.location != NSNotFound;
-            
-            // Determine if REAL affinity exists
-            NSRange rangeOfREALAffinitySubstringREAL = [declaredType rangeOfString:@"REAL" options:NSCaseInsensitiveSearch];
-            NSRange rangeOfREALAffinitySubstringFLOA = [declaredType rangeOfString:@"FLOA" options:NSCaseInsensitiveSearch];
-            NSRange rangeOfREALAffinitySubstringDOUB = [declaredType rangeOfString:@"DOUB" options:NSCaseInsensitiveSearch];
-            
-            BOOL isREALBecauseOfREAL = rangeOfREALAffinitySubstringREAL.location != NSNotFound;
-            BOOL isREALBecauseOfFLOA = rangeOfREALAffinitySubstringFLOA.location != NSNotFound;
-            BOOL isREALBecauseOfDOUB = rangeOfREALAffinitySubstringDOUB.location != NSNotFound;
-            
-            // Determine of NONE affinity exists
-            NSRange rangeOfNONEAffinitySubstringBLOB = [declaredType rangeOfString:@"BLOB" options:NSCaseInsensitiveSearch];
-            
-            BOOL isNONEBecauseofBLOB = rangeOfNONEAffinitySubstringBLOB.location != NSNotFound;
-            
-            
-            // Get the string value, regardless...
-            NSString *objCValueWrapper = [NSString stringWithFormat:@"%s", value];
-            
-            // Determine whether is NULL value.
-            BOOL isNULL = [objCValueWrapper isEqualToString:@"(null)"];
-            
-            // Conduct tests to see which affinity it is.
-            // Then handle appropriately.
-            
-            // If NULL, use NSNull to represent
-            // NULL in the row array.
-            if (isNULL) {
-                [row addObject:[NSNull null]];
-            }
-            else if (isTEXTBecauseOfCHAR || isTEXTBecauseOfCLOB || isTEXTBecauseOfTEXT) {
-                [row addObject:objCValueWrapper];
-            }
-            else if (isINTBecauseOfINT) {
-                long long longValue = [objCValueWrapper longLongValue];
-                NSNumber *integerNumber = [NSNumber numberWithLongLong:longValue];
-                [row addObject:integerNumber];
-            }
-            else if (isREALBecauseOfDOUB || isREALBecauseOfFLOA || isREALBecauseOfREAL) {
-                double decimalValue = [objCValueWrapper doubleValue];
-                NSNumber *decimalNumber = [NSNumber numberWithDouble:decimalValue];
-                [row addObject:decimalNumber];
-            }
-            else if (isNONEBecauseofBLOB) {
-                NSData *dataValue = [objCValueWrapper dataUsingEncoding:NSUTF8StringEncoding];
-                [row addObject:dataValue];
-            }
-            else { // is NUMERIC
-                [row addObject:objCValueWrapper];
-            }
+            [row addObject:LabQLiteObjectForColumn(lowLevelSQLStatement, i, decodings[i], NO, tallies)];
         }
         [arrayOfRows addObject:row];
+        rowsStepped++;
         stepValue = sqlite3_step(lowLevelSQLStatement);
     }
     
+    LabQLitePublishDecodingTallies(rowsStepped, tallies);
+    
     // Handle error encounter
     if (stepValue != SQLITE_DONE) {
         NSString *lowLevelErrorMessage = [NSString stringWithUTF8String:sqlite3_errmsg(_database)];
@@ -399,6 +1286,12 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
         return nil;
     }
     
+    // If its query plan was asked for, explain the statement
+    // first on the same connection.
+    if (self.queryPlanDiagnosticsEnabled) {
+        [self capturePendingQueryPlanForStatement:sqlStatement];
+    }
+    
     // Otherwise, attempt to prepare the SQL statement.
     sqlite3_stmt *lowLevelSQLStatement;
     int resultCode = [self resultCodeFromPreparingStatement:sqlStatement
@@ -416,6 +1309,14 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
                                          code:resultCode
                                      userInfo:userInfo];
         }
+        if (databaseWasOpened) [self closeDatabaseQuietly];
+        return nil;
+    }
+    if (![self mayRunPreparedStatement:lowLevelSQLStatement
+                          sqlStatement:sqlStatement
+                                 error:error]) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        if (databaseWasOpened) [self closeDatabaseQuietly];
         return nil;
     }
     
@@ -436,6 +1337,8 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
     // If should have attempted to bind values yet
     // was unable to do so, then return nil.
     if (shouldAttemptToBindValues && !didBindValuesToStatement) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        if (databaseWasOpened) [self closeDatabaseQuietly];
         return nil;
     }
     
@@ -447,8 +1350,12 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
     NSArray *results = [self resultsFromPreparedStatement:lowLevelSQLStatement
                                                     error:error];
     
-    // If the step-through failed, then simply return nil.
+    // If the step-through failed, release the statement (and
+    // the connection, if it was opened here) so that no lock
+    // outlives the failure, then return nil.
     if (!results) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        if (databaseWasOpened) [self closeDatabaseQuietly];
         return nil;
     }
     
@@ -457,6 +1364,12 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
     // SQL statement.
     sqlite3_finalize(lowLevelSQLStatement);
     
+    // In the in-memory mode, carry committed writes to disk.
+    if (![self writeThroughIfNeeded:error]) {
+        if (databaseWasOpened) [self closeDatabaseQuietly];
+        return nil;
+    }
+    
     // If should close database, then attempt to do so.
     // Otherwise, skip it.
     BOOL didCloseDatabase = NO;
@@ -510,6 +1423,167 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
                             error:error];
 }
 
+- (BOOL)enumerateRowsOfStatement:(NSString *)sqlStatement
+                  bindableValues:(NSArray *)bindableValues
+                   affinityTypes:(NSArray *)columnAffinityTypes
+                         options:(LabQLiteRowEnumerationOptions)options
+                     insulatedly:(BOOL)shouldAutoOpenAndCloseDatabase
+                           error:(NSError **)error
+                      usingBlock:(void (^)(NSArray *row, BOOL *stop))block {
+    if (shouldAutoOpenAndCloseDatabase && ![self openDatabase:error]) {
+        return NO;
+    }
+    
+    sqlite3_stmt *lowLevelSQLStatement;
+    int resultCode = [self resultCodeFromPreparingStatement:sqlStatement
+                           addressOfLowLevelSQLiteStatement:&lowLevelSQLStatement];
+    if (resultCode != SQLITE_OK) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                         code:resultCode
+                                     userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode],
+                                                @"errorDetails" : [NSString stringWithFormat:@"SQL statement: %@", sqlStatement]}];
+        }
+        if (shouldAutoOpenAndCloseDatabase) [self closeDatabaseQuietly];
+        return NO;
+    }
+    if (![self mayRunPreparedStatement:lowLevelSQLStatement
+                          sqlStatement:sqlStatement
+                                 error:error]) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        if (shouldAutoOpenAndCloseDatabase) [self closeDatabaseQuietly];
+        return NO;
+    }
+    
+    if (bindableValues != nil && columnAffinityTypes != nil &&
+        ![self bindValues:bindableValues
+        withAffinityTypes:columnAffinityTypes
+              toStatement:lowLevelSQLStatement
+                    error:error]) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        if (shouldAutoOpenAndCloseDatabase) [self closeDatabaseQuietly];
+        return NO;
+    }
+    
+    BOOL borrowing = (options & LabQLiteRowEnumerationBorrowColumnBuffers) != 0;
+    uint64_t rowsStepped = 0;
+    uint64_t tallies[LabQLiteMetricCount] = {0};
+    int m = sqlite3_column_count(lowLevelSQLStatement);
+    LabQLiteColumnDecoding decodings[m > 0 ? m : 1];
+    for (int i = 0; i < m; i++) {
+        decodings[i] = LabQLiteColumnDecodingForDeclaredType(sqlite3_column_decltype(lowLevelSQLStatement, i));
+    }
+    
+    // When borrowing, the row array is itself only valid
+    // until the next step, so one array is reused.
+    NSMutableArray *reusedRow = borrowing ? [[NSMutableArray alloc] initWithCapacity:m] : nil;
+    BOOL stop = NO;
+    int stepValue = sqlite3_step(lowLevelSQLStatement);
+    while (stepValue == SQLITE_ROW) {
+        @autoreleasepool {
+            NSMutableArray *row = reusedRow;
+            if (row != nil) {
+                [row removeAllObjects];
+            }
+            else {
+                row = [[NSMutableArray alloc] initWithCapacity:m];
+            }
+            for (int i = 0; i < m; i++) {
+                [row addObject:LabQLiteObjectForColumn(lowLevelSQLStatement, i, decodings[i], borrowing, tallies)];
+            }
+            rowsStepped++;
+            block(row, &stop);
+            [reusedRow removeAllObjects];
+        }
+        if (stop) break;
+        stepValue = sqlite3_step(lowLevelSQLStatement);
+    }
+    LabQLitePublishDecodingTallies(rowsStepped, tallies);
+    
+    BOOL enumerated = stop || stepValue == SQLITE_DONE;
+    if (!enumerated && error != nil) {
+        NSString *lowLevelErrorMessage = [NSString stringWithUTF8String:sqlite3_errmsg(_database)];
+        *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                     code:stepValue
+                                 userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:stepValue],
+                                            @"errorDetails" : @{@"lowLevelErrorMessage" : lowLevelErrorMessage}}];
+    }
+    sqlite3_finalize(lowLevelSQLStatement);
+    if (enumerated && ![self writeThroughIfNeeded:error]) {
+        enumerated = NO;
+    }
+    
+    if (shouldAutoOpenAndCloseDatabase) {
+        if (!enumerated) {
+            [self closeDatabaseQuietly];
+        }
+        else if (![self closeDatabase:error]) {
+            return NO;
+        }
+    }
+    return enumerated;
+}
+
+- (BOOL)processStatement:(NSString *)sqlStatement
+       bindableValueRows:(NSArray *)bindableValueRows
+           affinityTypes:(NSArray *)columnAffinityTypes
+                   error:(NSError **)error {
+    sqlite3_stmt *lowLevelSQLStatement;
+    int resultCode = [self resultCodeFromPreparingStatement:sqlStatement
+                           addressOfLowLevelSQLiteStatement:&lowLevelSQLStatement];
+    if (resultCode != SQLITE_OK) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                         code:resultCode
+                                     userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode],
+                                                @"errorDetails" : [NSString stringWithFormat:@"SQL statement: %@", sqlStatement]}];
+        }
+        return NO;
+    }
+    if (![self mayRunPreparedStatement:lowLevelSQLStatement
+                          sqlStatement:sqlStatement
+                                 error:error]) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        return NO;
+    }
+    
+    NSUInteger count = [columnAffinityTypes count];
+    LabQLiteBindKind bindPlan[count > 0 ? count : 1];
+    if (![self makeBindPlan:bindPlan
+          fromAffinityTypes:columnAffinityTypes
+                      error:error]) {
+        sqlite3_finalize(lowLevelSQLStatement);
+        return NO;
+    }
+    
+    for (NSArray *bindableValues in bindableValueRows) {
+        if (![self bindValues:bindableValues
+                 withBindPlan:bindPlan
+                        count:count
+                  toStatement:lowLevelSQLStatement
+                        error:error]) {
+            sqlite3_finalize(lowLevelSQLStatement);
+            return NO;
+        }
+        int stepValue = sqlite3_step(lowLevelSQLStatement);
+        if (stepValue != SQLITE_DONE && stepValue != SQLITE_ROW) {
+            if (error != nil) {
+                NSString *lowLevelErrorMessage = [NSString stringWithUTF8String:sqlite3_errmsg(_database)];
+                *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                             code:stepValue
+                                         userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:stepValue],
+                                                    @"errorDetails" : @{@"lowLevelErrorMessage" : lowLevelErrorMessage}}];
+            }
+            sqlite3_finalize(lowLevelSQLStatement);
+            return NO;
+        }
+        sqlite3_reset(lowLevelSQLStatement);
+        sqlite3_clear_bindings(lowLevelSQLStatement);
+    }
+    sqlite3_finalize(lowLevelSQLStatement);
+    return [self writeThroughIfNeeded:error];
+}
+
 - (NSString *)description {
     NSMutableString *desc = [NSMutableString stringWithString:[[self class] description]];
     //    [desc appendFormat:@",\n low level C object: %c", _database];
@@ -552,5 +1626,306 @@ NSString *const LabQLiteErrorMessageColumnsCountDidNotMatchValuesCount = @"The n
 }
 
 
+
+#pragma mark - Query Plan Diagnostics
+
++ (NSString *)fingerprintForStatement:(NSString *)sqlStatement {
+    NSUInteger length = [sqlStatement length];
+    NSMutableString *fingerprint = [[NSMutableString alloc] initWithCapacity:length];
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    NSCharacterSet *digits = [NSCharacterSet decimalDigitCharacterSet];
+    NSMutableCharacterSet *identifierCharacters = [NSMutableCharacterSet alphanumericCharacterSet];
+    [identifierCharacters addCharactersInString:@"_$"];
+
+    unichar previous = ' ';
+    NSUInteger i = 0;
+    while (i < length) {
+        unichar c = [sqlStatement characterAtIndex:i];
+
+        // Collapse whitespace runs into a single space
+        if ([whitespace characterIsMember:c]) {
+            while (i < length && [whitespace characterIsMember:[sqlStatement characterAtIndex:i]]) i++;
+            if ([fingerprint length] > 0 && i < length) {
+                [fingerprint appendString:@" "];
+            }
+            previous = ' ';
+            continue;
+        }
+
+        // String literal ('' escapes a quote)
+        if (c == '\'') {
+            i++;
+            while (i < length) {
+                if ([sqlStatement characterAtIndex:i] == '\'') {
+                    if (i + 1 < length && [sqlStatement characterAtIndex:i + 1] == '\'') {
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                i++;
+            }
+            i++;
+            [fingerprint appendString:@"?"];
+            previous = '?';
+            continue;
+        }
+
+        // Numeric literal which is not part of an identifier
+        if ([digits characterIsMember:c] && ![identifierCharacters characterIsMember:previous]) {
+            while (i < length) {
+                unichar d = [sqlStatement characterAtIndex:i];
+                if (![digits characterIsMember:d] && d != '.') break;
+                i++;
+            }
+            [fingerprint appendString:@"?"];
+            previous = '?';
+            continue;
+        }
+
+        [fingerprint appendFormat:@"%C", c];
+        previous = c;
+        i++;
+    }
+    return fingerprint;
+}
+
+- (BOOL)captureQueryPlanForStatement:(NSString *)sqlStatement
+                               table:(NSString *)tableName
+                        stipulations:(NSArray *)stipulations
+                      orderingColumn:(NSString *)orderingColumn
+                         insulatedly:(BOOL)shouldAutoOpenAndCloseDatabase {
+    if (!self.queryPlanDiagnosticsEnabled || sqlStatement == nil) return NO;
+
+    NSString *fingerprint = [LabQLiteDatabase fingerprintForStatement:sqlStatement];
+    @synchronized (self) {
+        if (self.capturedQueryPlans == nil) {
+            self.capturedQueryPlans = [NSMutableDictionary new];
+        }
+        if ([self.capturedQueryPlans objectForKey:fingerprint] != nil) {
+            return NO;
+        }
+        
+        // Rather than opening a connection of its own, an insulated
+        // statement is explained on the one opened to run it.
+        if (shouldAutoOpenAndCloseDatabase) {
+            if (self.pendingQueryPlanCaptures == nil) {
+                self.pendingQueryPlanCaptures = [NSMutableDictionary new];
+            }
+            NSMutableDictionary *pendingCapture = [NSMutableDictionary dictionaryWithObject:fingerprint forKey:@"fingerprint"];
+            if (tableName) [pendingCapture setObject:tableName forKey:@"table"];
+            if (stipulations) [pendingCapture setObject:stipulations forKey:@"stipulations"];
+            if (orderingColumn) [pendingCapture setObject:orderingColumn forKey:@"orderingColumn"];
+            [self.pendingQueryPlanCaptures setObject:pendingCapture forKey:sqlStatement];
+            return YES;
+        }
+    }
+    return [self explainStatement:sqlStatement
+                      fingerprint:fingerprint
+                            table:tableName
+                     stipulations:stipulations
+                   orderingColumn:orderingColumn];
+}
+
+- (void)capturePendingQueryPlanForStatement:(NSString *)sqlStatement {
+    NSDictionary *pendingCapture;
+    @synchronized (self) {
+        pendingCapture = [self.pendingQueryPlanCaptures objectForKey:sqlStatement];
+        if (pendingCapture == nil) return;
+        [self.pendingQueryPlanCaptures removeObjectForKey:sqlStatement];
+    }
+    [self explainStatement:sqlStatement
+               fingerprint:[pendingCapture objectForKey:@"fingerprint"]
+                     table:[pendingCapture objectForKey:@"table"]
+              stipulations:[pendingCapture objectForKey:@"stipulations"]
+            orderingColumn:[pendingCapture objectForKey:@"orderingColumn"]];
+}
+
+- (BOOL)explainStatement:(NSString *)sqlStatement
+             fingerprint:(NSString *)fingerprint
+                   table:(NSString *)tableName
+            stipulations:(NSArray *)stipulations
+          orderingColumn:(NSString *)orderingColumn {
+    NSArray *planRows = [self processStatement:[@"EXPLAIN QUERY PLAN " stringByAppendingString:sqlStatement]
+                                   insulatedly:NO
+                                         error:NULL];
+    if (planRows == nil) {
+        return NO;
+    }
+
+    // Each row of EXPLAIN QUERY PLAN is
+    // (selectid, order, from, detail).
+    NSMutableArray *details = [[NSMutableArray alloc] initWithCapacity:[planRows count]];
+    BOOL usesFullTableScan = NO;
+    BOOL usesTemporaryBTree = NO;
+    for (NSArray *planRow in planRows) {
+        NSString *detail = [NSString stringWithFormat:@"%@", [planRow lastObject]];
+        [details addObject:detail];
+        if ([detail hasPrefix:@"SCAN TABLE"] &&
+            [detail rangeOfString:@" USING "].location == NSNotFound) {
+            usesFullTableScan = YES;
+        }
+        if ([detail rangeOfString:@"USE TEMP B-TREE"].location != NSNotFound) {
+            usesTemporaryBTree = YES;
+        }
+    }
+
+    // Only columns every matching row is equal on can lead an
+    // index; once a stipulation is OR-ed in, no single column is.
+    BOOL stipulationsAreConjunctive = YES;
+    for (NSUInteger i = 1; i < [stipulations count]; i++) {
+        LabQLiteStipulation *s = [stipulations objectAtIndex:i];
+        if (s.precedingLogicalOperator != nil &&
+            [s.precedingLogicalOperator caseInsensitiveCompare:SQLite3LogicalOperatorOR] == NSOrderedSame) {
+            stipulationsAreConjunctive = NO;
+            break;
+        }
+    }
+    NSMutableArray *indexColumns = [NSMutableArray new];
+    if (stipulationsAreConjunctive) {
+        for (LabQLiteStipulation *s in stipulations) {
+            if ([s.binaryOperator isEqualToString:SQLite3BinaryOperatorEquals] &&
+                ![indexColumns containsObject:s.attribute]) {
+                [indexColumns addObject:s.attribute];
+            }
+        }
+    }
+    
+    // The sort columns follow, without their ASC/DESC (or COLLATE)
+    // suffixes; SQLite walks an index in either direction.
+    for (NSString *orderingTerm in [orderingColumn componentsSeparatedByString:@","]) {
+        NSString *term = [orderingTerm stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        NSString *column = [[term componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] firstObject];
+        if ([column length] > 0 && ![indexColumns containsObject:column]) {
+            [indexColumns addObject:column];
+        }
+    }
+
+    NSDictionary *plan = @{LabQLiteQueryPlanStatementKey : fingerprint,
+                           LabQLiteQueryPlanTableKey : (tableName ? tableName : @""),
+                           LabQLiteQueryPlanDetailsKey : details,
+                           LabQLiteQueryPlanUsesFullTableScanKey : @(usesFullTableScan),
+                           LabQLiteQueryPlanUsesTemporaryBTreeKey : @(usesTemporaryBTree),
+                           LabQLiteQueryPlanSuggestedIndexColumnsKey : indexColumns};
+    @synchronized (self) {
+        [self.capturedQueryPlans setObject:plan forKey:fingerprint];
+    }
+    return YES;
+}
+
+- (NSArray *)queryPlanDiagnostics {
+    @synchronized (self) {
+        if (self.capturedQueryPlans == nil) return @[];
+        return [self.capturedQueryPlans allValues];
+    }
+}
+
+- (NSArray *)suggestedIndexStatements {
+    NSMutableArray *statements = [NSMutableArray new];
+    for (NSDictionary *plan in [self queryPlanDiagnostics]) {
+        BOOL isFlagged = [[plan objectForKey:LabQLiteQueryPlanUsesFullTableScanKey] boolValue] ||
+                         [[plan objectForKey:LabQLiteQueryPlanUsesTemporaryBTreeKey] boolValue];
+        NSArray *columns = [plan objectForKey:LabQLiteQueryPlanSuggestedIndexColumnsKey];
+        NSString *tableName = [plan objectForKey:LabQLiteQueryPlanTableKey];
+        if (!isFlagged || [columns count] == 0 || [tableName length] == 0) continue;
+
+        NSString *indexName = [NSString stringWithFormat:@"idx_%@_%@", tableName, [columns componentsJoinedByString:@"_"]];
+        NSString *statement = [NSString stringWithFormat:@"CREATE INDEX IF NOT EXISTS %@ ON %@ (%@)",
+                               indexName,
+                               tableName,
+                               [columns componentsJoinedByString:@", "]];
+        if (![statements containsObject:statement]) {
+            [statements addObject:statement];
+        }
+    }
+    return statements;
+}
+
+- (NSString *)queryPlanDiagnosticsReport {
+    NSMutableString *report = [NSMutableString stringWithString:@"LabQLite query plan diagnostics\n"];
+    for (NSDictionary *plan in [self queryPlanDiagnostics]) {
+        BOOL usesFullTableScan = [[plan objectForKey:LabQLiteQueryPlanUsesFullTableScanKey] boolValue];
+        BOOL usesTemporaryBTree = [[plan objectForKey:LabQLiteQueryPlanUsesTemporaryBTreeKey] boolValue];
+        if (!usesFullTableScan && !usesTemporaryBTree) continue;
+        [report appendFormat:@"\n%@\n", [plan objectForKey:LabQLiteQueryPlanStatementKey]];
+        for (NSString *detail in [plan objectForKey:LabQLiteQueryPlanDetailsKey]) {
+            [report appendFormat:@"    %@\n", detail];
+        }
+    }
+    NSArray *suggestions = [self suggestedIndexStatements];
+    if ([suggestions count] > 0) {
+        [report appendString:@"\nSuggested indexes:\n"];
+        for (NSString *statement in suggestions) {
+            [report appendFormat:@"    %@;\n", statement];
+        }
+    }
+    return report;
+}
+
+- (void)resetQueryPlanDiagnostics {
+    @synchronized (self) {
+        [self.capturedQueryPlans removeAllObjects];
+        [self.pendingQueryPlanCaptures removeAllObjects];
+    }
+}
+
+
+
+
+#pragma mark - Statement Statistics
+
+- (void)recordDuration:(uint64_t)nanoseconds
+          forStatement:(const char *)sqlStatement {
+    if (sqlStatement == NULL) return;
+    
+    LabQLiteStatementTimings *timings = self.statementTimings;
+    NSString *sql = [NSString stringWithUTF8String:sqlStatement];
+    [timings.lock lock];
+    NSString *fingerprint = [timings.fingerprintsBySQL objectForKey:sql];
+    if (fingerprint == nil) {
+        // Statements built with literal values would otherwise
+        // grow the cache without bound.
+        if ([timings.fingerprintsBySQL count] >= 1024) {
+            [timings.fingerprintsBySQL removeAllObjects];
+        }
+        fingerprint = [LabQLiteDatabase fingerprintForStatement:sql];
+        [timings.fingerprintsBySQL setObject:fingerprint forKey:sql];
+    }
+    LabQLiteLatencyHistogram *histogram = [timings.histograms objectForKey:fingerprint];
+    if (histogram == nil) {
+        histogram = [LabQLiteLatencyHistogram new];
+        [timings.histograms setObject:histogram forKey:fingerprint];
+    }
+    [histogram recordValue:nanoseconds];
+    [timings.lock unlock];
+}
+
+- (NSDictionary *)statisticsSnapshot {
+    LabQLiteStatementTimings *timings = self.statementTimings;
+    NSMutableDictionary *snapshot = [NSMutableDictionary new];
+    [timings.lock lock];
+    for (NSString *fingerprint in timings.histograms) {
+        LabQLiteLatencyHistogram *histogram = [timings.histograms objectForKey:fingerprint];
+        if (histogram.count == 0) continue;
+        [snapshot setObject:@{LabQLiteStatementStatisticsCountKey : @(histogram.count),
+                              LabQLiteStatementStatisticsMeanKey : @((double)histogram.totalValue / (double)histogram.count / 1000.0),
+                              LabQLiteStatementStatisticsP50Key : @([histogram valueAtPercentile:50.0] / 1000.0),
+                              LabQLiteStatementStatisticsP95Key : @([histogram valueAtPercentile:95.0] / 1000.0),
+                              LabQLiteStatementStatisticsP99Key : @([histogram valueAtPercentile:99.0] / 1000.0),
+                              LabQLiteStatementStatisticsMaxKey : @(histogram.maxValue / 1000.0)}
+                     forKey:fingerprint];
+    }
+    [timings.lock unlock];
+    return snapshot;
+}
+
+- (void)resetStatistics {
+    LabQLiteStatementTimings *timings = self.statementTimings;
+    [timings.lock lock];
+    [timings.histograms removeAllObjects];
+    [timings.lock unlock];
+}
+
+
 @end
 
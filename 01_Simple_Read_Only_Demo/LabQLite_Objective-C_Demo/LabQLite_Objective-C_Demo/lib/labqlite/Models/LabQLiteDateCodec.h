@@ -0,0 +1,114 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "LabQLiteRowMappable.h"
+
+
+
+#pragma mark - Date Storage Modes
+
+/**
+ @abstract How an NSDate is stored in a column.
+
+ @constant LabQLiteDateStorageISO8601Text TEXT of the form
+ `YYYY-MM-DD HH:MM:SS[.SSS]` in UTC, which SQLite's own date and
+ time functions read and produce, and which sorts correctly.
+
+ @constant LabQLiteDateStorageUnixEpoch INTEGER seconds since
+ 1970-01-01 00:00:00 UTC.
+
+ @constant LabQLiteDateStorageJulianDay REAL days since noon in
+ Greenwich on November 24, 4714 B.C., as used by julianday().
+ */
+typedef enum {
+    LabQLiteDateStorageISO8601Text = 0,
+    LabQLiteDateStorageUnixEpoch,
+    LabQLiteDateStorageJulianDay
+} LabQLiteDateStorage;
+
+
+
+#pragma mark - LabQLiteDateCodec Class
+
+/**
+ @abstract Converts NSDates to and from their stored SQLite form
+ with hand-written parsers and printers; no NSDateFormatter is
+ involved, so there is no per-call setup and no locale or
+ calendar dependence.
+ */
+@interface LabQLiteDateCodec : NSObject
+
+/**
+ @abstract The stored form of the provided date: an NSString for
+ ISO-8601 text, an NSNumber otherwise.
+ */
++ (id)storageValueForDate:(NSDate *)date
+                  storage:(LabQLiteDateStorage)storage;
+
+/**
+ @abstract The storage mode used for a column which does not
+ declare one: Unix epoch for INTEGER affinity, Julian day for
+ REAL affinity and ISO-8601 text otherwise.
+ */
++ (LabQLiteDateStorage)storageForAffinity:(NSNumber *)affinity;
+
+/**
+ @abstract The date represented by a stored value.
+
+ @discussion NSStrings are parsed as ISO-8601 text whatever the
+ storage mode, since SQLite hands back NUMERIC-declared columns
+ as text too; NSNumbers are read as Julian days when that is the
+ storage mode and as Unix epoch seconds otherwise.
+
+ @return The date, or nil if the value is NSNull, nil or cannot
+ be parsed.
+ */
++ (NSDate *)dateFromStorageValue:(id)value
+                         storage:(LabQLiteDateStorage)storage;
+
+/**
+ @abstract Formats a date as `YYYY-MM-DD HH:MM:SS` in UTC, with
+ `.SSS` milliseconds appended when they are not zero.
+ */
++ (NSString *)ISO8601StringFromDate:(NSDate *)date;
+
+/**
+ @abstract Parses `YYYY-MM-DD`, optionally followed by a space or
+ `T` and `HH:MM`, `:SS`, `.fraction`, and `Z` or a `+HH:MM`,
+ `-HH:MM` or `+HHMM` offset. Times without an offset are UTC.
+ The `GMT-05:00` offsets of the `yyyy-MM-dd HH:mm:ss ZZZZ`
+ strings LabQLiteDatabase formatted before are read too.
+
+ @discussion Days past the end of their month are rejected, and
+ hour 24 is only accepted as `24:00:00`.
+
+ @return The date, or nil if the string is not of that form.
+ */
++ (NSDate *)dateFromISO8601String:(NSString *)string;
+
+@end
@@ -0,0 +1,229 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteDateCodec.h"
+
+
+/**
+ @abstract Julian day of the Unix epoch.
+ */
+static const double LabQLiteJulianDayOfUnixEpoch = 2440587.5;
+
+/**
+ @abstract Days since 1970-01-01 of a proleptic Gregorian date.
+ */
+static int64_t LabQLiteDaysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = (unsigned)(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+/**
+ @abstract Proleptic Gregorian date of a day count since 1970-01-01.
+ */
+static void LabQLiteCivilFromDays(int64_t days, int64_t *year, unsigned *month, unsigned *day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = (unsigned)(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned mp = (5 * dayOfYear + 2) / 153;
+    *day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = (int64_t)yearOfEra + era * 400 + (*month <= 2);
+}
+
+/**
+ @abstract Days in a month of a proleptic Gregorian year.
+ */
+static int LabQLiteDaysInMonth(int year, int month) {
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    BOOL leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return (month == 2 && leapYear) ? 29 : daysInMonth[month - 1];
+}
+
+/**
+ @abstract Reads exactly `count` decimal digits.
+ */
+static BOOL LabQLiteReadDigits(const char **cursor, const char *end, int count, int *value) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (*cursor >= end || **cursor < '0' || **cursor > '9') return NO;
+        result = result * 10 + (**cursor - '0');
+        (*cursor)++;
+    }
+    *value = result;
+    return YES;
+}
+
+static BOOL LabQLiteReadCharacter(const char **cursor, const char *end, char character) {
+    if (*cursor < end && **cursor == character) {
+        (*cursor)++;
+        return YES;
+    }
+    return NO;
+}
+
+
+@implementation LabQLiteDateCodec
+
++ (id)storageValueForDate:(NSDate *)date
+                  storage:(LabQLiteDateStorage)storage {
+    NSTimeInterval seconds = [date timeIntervalSince1970];
+    switch (storage) {
+        case LabQLiteDateStorageUnixEpoch:
+            return [NSNumber numberWithLongLong:(long long)floor(seconds)];
+        case LabQLiteDateStorageJulianDay:
+            return [NSNumber numberWithDouble:seconds / 86400.0 + LabQLiteJulianDayOfUnixEpoch];
+        default:
+            return [LabQLiteDateCodec ISO8601StringFromDate:date];
+    }
+}
+
++ (LabQLiteDateStorage)storageForAffinity:(NSNumber *)affinity {
+    if ([affinity isEqual:SQLITE_AFFINITY_TYPE_INTEGER]) return LabQLiteDateStorageUnixEpoch;
+    if ([affinity isEqual:SQLITE_AFFINITY_TYPE_REAL]) return LabQLiteDateStorageJulianDay;
+    return LabQLiteDateStorageISO8601Text;
+}
+
++ (NSDate *)dateFromStorageValue:(id)value
+                         storage:(LabQLiteDateStorage)storage {
+    if ([value isKindOfClass:[NSDate class]]) {
+        return value;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        NSDate *date = [LabQLiteDateCodec dateFromISO8601String:value];
+        if (date != nil || storage == LabQLiteDateStorageISO8601Text) return date;
+        value = [NSNumber numberWithDouble:[value doubleValue]];
+    }
+    if ([value isKindOfClass:[NSNumber class]]) {
+        double number = [value doubleValue];
+        if (storage == LabQLiteDateStorageJulianDay) {
+            return [NSDate dateWithTimeIntervalSince1970:(number - LabQLiteJulianDayOfUnixEpoch) * 86400.0];
+        }
+        return [NSDate dateWithTimeIntervalSince1970:number];
+    }
+    return nil;
+}
+
++ (NSString *)ISO8601StringFromDate:(NSDate *)date {
+    double seconds = [date timeIntervalSince1970];
+    int64_t milliseconds = (int64_t)llround(seconds * 1000.0);
+    int64_t wholeSeconds = milliseconds >= 0 ? milliseconds / 1000 : -((-milliseconds + 999) / 1000);
+    int millisecond = (int)(milliseconds - wholeSeconds * 1000);
+    int64_t days = wholeSeconds >= 0 ? wholeSeconds / 86400 : -((-wholeSeconds + 86399) / 86400);
+    int secondOfDay = (int)(wholeSeconds - days * 86400);
+    int64_t year;
+    unsigned month, day;
+    LabQLiteCivilFromDays(days, &year, &month, &day);
+    
+    char buffer[40];
+    int length = snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02d:%02d:%02d",
+                          (long long)year, month, day,
+                          secondOfDay / 3600, (secondOfDay / 60) % 60, secondOfDay % 60);
+    if (millisecond != 0) {
+        length += snprintf(buffer + length, sizeof(buffer) - length, ".%03d", millisecond);
+    }
+    return [[NSString alloc] initWithBytes:buffer
+                                    length:(NSUInteger)length
+                                  encoding:NSASCIIStringEncoding];
+}
+
++ (NSDate *)dateFromISO8601String:(NSString *)string {
+    const char *cursor = [string UTF8String];
+    if (cursor == NULL) return nil;
+    const char *end = cursor + strlen(cursor);
+    while (cursor < end && *cursor == ' ') cursor++;
+    
+    int year, month, day;
+    if (!LabQLiteReadDigits(&cursor, end, 4, &year) ||
+        !LabQLiteReadCharacter(&cursor, end, '-') ||
+        !LabQLiteReadDigits(&cursor, end, 2, &month) ||
+        !LabQLiteReadCharacter(&cursor, end, '-') ||
+        !LabQLiteReadDigits(&cursor, end, 2, &day)) {
+        return nil;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > LabQLiteDaysInMonth(year, month)) return nil;
+    
+    int hour = 0, minute = 0, second = 0;
+    double fraction = 0;
+    int offsetSeconds = 0;
+    if (LabQLiteReadCharacter(&cursor, end, ' ') || LabQLiteReadCharacter(&cursor, end, 'T')) {
+        if (!LabQLiteReadDigits(&cursor, end, 2, &hour) ||
+            !LabQLiteReadCharacter(&cursor, end, ':') ||
+            !LabQLiteReadDigits(&cursor, end, 2, &minute)) {
+            return nil;
+        }
+        if (LabQLiteReadCharacter(&cursor, end, ':')) {
+            if (!LabQLiteReadDigits(&cursor, end, 2, &second)) return nil;
+            if (LabQLiteReadCharacter(&cursor, end, '.')) {
+                double scale = 0.1;
+                while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+                    fraction += (*cursor - '0') * scale;
+                    scale /= 10.0;
+                    cursor++;
+                }
+            }
+        }
+        if (hour > 24 || minute > 59 || second > 60) return nil;
+        
+        // 24:00:00 is the end of the day; no later time of hour 24 is
+        if (hour == 24 && (minute != 0 || second != 0 || fraction != 0)) return nil;
+        
+        while (cursor < end && *cursor == ' ') cursor++;
+        
+        // NSDateFormatter's `ZZZZ` writes the offset as `GMT-05:00`,
+        // or `GMT` alone at zero
+        if (end - cursor >= 3 && strncmp(cursor, "GMT", 3) == 0) {
+            cursor += 3;
+        }
+        if (LabQLiteReadCharacter(&cursor, end, 'Z')) {
+            offsetSeconds = 0;
+        }
+        else if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+            int sign = *cursor == '-' ? -1 : 1;
+            cursor++;
+            int offsetHours, offsetMinutes = 0;
+            if (!LabQLiteReadDigits(&cursor, end, 2, &offsetHours)) return nil;
+            LabQLiteReadCharacter(&cursor, end, ':');
+            if (cursor < end && !LabQLiteReadDigits(&cursor, end, 2, &offsetMinutes)) return nil;
+            offsetSeconds = sign * (offsetHours * 3600 + offsetMinutes * 60);
+        }
+    }
+    while (cursor < end && *cursor == ' ') cursor++;
+    if (cursor != end) return nil;
+    
+    int64_t days = LabQLiteDaysFromCivil(year, (unsigned)month, (unsigned)day);
+    double seconds = (double)(days * 86400 + hour * 3600 + minute * 60 + second - offsetSeconds) + fraction;
+    return [NSDate dateWithTimeIntervalSince1970:seconds];
+}
+
+
+@end
@@ -0,0 +1,108 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+@class LabQLiteDatabaseController;
+
+
+
+/**
+ @abstract How many neighbouring faults of one batch are loaded
+ together when any one of them is first accessed.
+ */
+#define LABQLITE_FAULT_BATCH_LOAD_SIZE 64
+
+
+
+#pragma mark - LabQLiteFaultBatch Class
+
+/**
+ @abstract The lazy values of one column for a set of rows
+ mapped together. Loading is by rowid, a window of
+ LABQLITE_FAULT_BATCH_LOAD_SIZE rows per statement.
+
+ @discussion Not thread safe: the faults of a batch should be
+ fired from the thread that mapped them, or access serialized.
+ */
+@interface LabQLiteFaultBatch : NSObject
+
+/**
+ @abstract The table and column whose values are deferred.
+ */
+@property (nonatomic, readonly) NSString *tableName;
+@property (nonatomic, readonly) NSString *columnName;
+
+/**
+ @abstract The error of the last failed load, if any. Faults
+ whose load failed resolve to NSNull for that access only; they
+ stay unloaded, and the next access retries the load.
+ */
+@property (nonatomic, readonly) NSError *lastError;
+
+- (instancetype)initWithController:(LabQLiteDatabaseController *)controller
+                         tableName:(NSString *)tableName
+                        columnName:(NSString *)columnName;
+
+/**
+ @abstract Returns a fault for the provided row, to be set in
+ place of the column value on a mapped object.
+ */
+- (id)faultForRowID:(NSNumber *)rowID;
+
+/**
+ @abstract Returns the loaded value of the fault at the provided
+ index, loading it (and its neighbours) first if need be, or
+ NSNull if that load fails.
+ */
+- (id)valueAtIndex:(NSUInteger)index;
+
+@end
+
+
+
+#pragma mark - LabQLiteFault Class
+
+/**
+ @abstract Stands in for a lazily loaded column value. The first
+ message other than -isFault loads the value and every later
+ message is forwarded to it, so to callers it behaves like the
+ NSData (or NSString, NSNumber) it stands for.
+ */
+@interface LabQLiteFault : NSProxy
+
+/**
+ @abstract Whether the value has not been loaded yet.
+ */
+- (BOOL)isFault;
+
+/**
+ @abstract The loaded value (loading it if need be).
+ */
+- (id)resolvedValue;
+
+@end
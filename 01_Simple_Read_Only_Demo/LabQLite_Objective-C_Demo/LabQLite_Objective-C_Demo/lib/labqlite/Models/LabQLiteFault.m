@@ -0,0 +1,212 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteFault.h"
+#import "LabQLiteDatabaseController.h"
+#import "LabQLiteConstants.h"
+
+
+@interface LabQLiteFault ()
+
+- (instancetype)initWithBatch:(LabQLiteFaultBatch *)batch
+                        index:(NSUInteger)index;
+
+@end
+
+@interface LabQLiteFaultBatch ()
+
+- (BOOL)isLoadedAtIndex:(NSUInteger)index;
+
+@end
+
+
+
+@implementation LabQLiteFaultBatch {
+    LabQLiteDatabaseController *_controller;
+    NSMutableArray *_rowIDs;
+    NSMutableArray *_values;
+}
+
+- (instancetype)initWithController:(LabQLiteDatabaseController *)controller
+                         tableName:(NSString *)tableName
+                        columnName:(NSString *)columnName {
+    self = [super init];
+    if (self) {
+        _controller = controller;
+        _tableName = tableName;
+        _columnName = columnName;
+        _rowIDs = [NSMutableArray new];
+        _values = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (id)faultForRowID:(NSNumber *)rowID {
+    NSUInteger index = [_rowIDs count];
+    [_rowIDs addObject:rowID];
+    [_values addObject:[LabQLiteFaultBatch unloadedMarker]];
+    return [[LabQLiteFault alloc] initWithBatch:self index:index];
+}
+
++ (id)unloadedMarker {
+    static NSObject *marker;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        marker = [NSObject new];
+    });
+    return marker;
+}
+
+- (BOOL)isLoadedAtIndex:(NSUInteger)index {
+    return [_values objectAtIndex:index] != [LabQLiteFaultBatch unloadedMarker];
+}
+
+- (id)valueAtIndex:(NSUInteger)index {
+    if (![self isLoadedAtIndex:index] && ![self loadWindowStartingAtIndex:index]) {
+        return [NSNull null];
+    }
+    return [_values objectAtIndex:index];
+}
+
+/**
+ @abstract Loads the still unloaded values of the window of rows
+ following (and including) the provided index in one statement.
+ 
+ @discussion On failure the window stays unloaded, so that the
+ next access retries, and the error is kept in lastError.
+ */
+- (BOOL)loadWindowStartingAtIndex:(NSUInteger)index {
+    NSUInteger windowSize = MIN((NSUInteger)LABQLITE_FAULT_BATCH_LOAD_SIZE,
+                                (NSUInteger)LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT);
+    NSMutableArray *indexes = [NSMutableArray new];
+    NSMutableArray *rowIDs = [NSMutableArray new];
+    NSMutableArray *affinities = [NSMutableArray new];
+    NSMutableArray *placeholders = [NSMutableArray new];
+    for (NSUInteger i = index; i < [_rowIDs count] && [rowIDs count] < windowSize; i++) {
+        if ([self isLoadedAtIndex:i]) continue;
+        [indexes addObject:@(i)];
+        [rowIDs addObject:[_rowIDs objectAtIndex:i]];
+        [affinities addObject:SQLITE_AFFINITY_TYPE_INTEGER];
+        [placeholders addObject:@"?"];
+    }
+    
+    NSString *q = [NSString stringWithFormat:@"SELECT rowid, %@ FROM %@ WHERE rowid IN (%@)",
+                   _columnName,
+                   _tableName,
+                   [placeholders componentsJoinedByString:@", "]];
+    NSError *error;
+    NSArray *rows = [_controller processStatement:q
+                                   bindableValues:rowIDs
+                                    affinityTypes:affinities
+                                      insulatedly:YES
+                                            error:&error];
+    if (rows == nil) {
+        _lastError = error;
+        return NO;
+    }
+    NSMutableDictionary *valuesByRowID = [[NSMutableDictionary alloc] initWithCapacity:[rows count]];
+    for (NSArray *row in rows) {
+        [valuesByRowID setObject:[row objectAtIndex:1] forKey:[row objectAtIndex:0]];
+    }
+    for (NSNumber *i in indexes) {
+        id value = [valuesByRowID objectForKey:[_rowIDs objectAtIndex:[i unsignedIntegerValue]]];
+        [_values replaceObjectAtIndex:[i unsignedIntegerValue]
+                           withObject:(value != nil ? value : [NSNull null])];
+    }
+    return YES;
+}
+
+@end
+
+
+
+@implementation LabQLiteFault {
+    LabQLiteFaultBatch *_batch;
+    NSUInteger _index;
+    id _value;
+}
+
+- (instancetype)initWithBatch:(LabQLiteFaultBatch *)batch
+                        index:(NSUInteger)index {
+    _batch = batch;
+    _index = index;
+    return self;
+}
+
+- (BOOL)isFault {
+    return _value == nil;
+}
+
+- (id)resolvedValue {
+    if (_value == nil) {
+        id value = [_batch valueAtIndex:_index];
+        
+        // A failed load is retried on the next access
+        if (![_batch isLoadedAtIndex:_index]) return value;
+        _value = value;
+        _batch = nil;
+    }
+    return _value;
+}
+
+- (id)forwardingTargetForSelector:(SEL)selector {
+    return [self resolvedValue];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)selector {
+    return [[self resolvedValue] methodSignatureForSelector:selector];
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+    [invocation invokeWithTarget:[self resolvedValue]];
+}
+
+- (BOOL)respondsToSelector:(SEL)selector {
+    return [[self resolvedValue] respondsToSelector:selector];
+}
+
+- (BOOL)isKindOfClass:(Class)cls {
+    return [[self resolvedValue] isKindOfClass:cls];
+}
+
+- (BOOL)isEqual:(id)object {
+    return [[self resolvedValue] isEqual:object];
+}
+
+- (NSUInteger)hash {
+    return [[self resolvedValue] hash];
+}
+
+- (NSString *)description {
+    if (_value == nil) {
+        return [NSString stringWithFormat:@"<fault %@.%@>", [_batch tableName], [_batch columnName]];
+    }
+    return [_value description];
+}
+
+
+@end
@@ -0,0 +1,162 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+#pragma mark - Full-Text Modules
+
+/**
+ @abstract The SQLite full-text module backing a full-text index.
+ Both require the linked SQLite to be compiled with
+ SQLITE_ENABLE_FTS4 / SQLITE_ENABLE_FTS5; the Xcode project does
+ not define them for the sqlite3.c amalgamation it builds, so
+ apps which search add them there. Use +isModuleAvailable: to
+ check at runtime.
+ */
+typedef NS_ENUM(NSInteger, LabQLiteFullTextModule) {
+    LabQLiteFullTextModuleFTS5 = 0,
+    LabQLiteFullTextModuleFTS4
+};
+
+
+
+#pragma mark - LabQLiteFullTextIndexDefinition Class
+
+/**
+ @abstract Describes a full-text index over text columns of the
+ table of a LabQLiteRowMappable class. Mappable classes return one
+ from +fullTextIndexDefinition; the database controller creates it
+ when missing, together with the indexes of +indexDefinitions.
+ Like those, it requires +indexedTableName. Example:
+
+    + (LabQLiteFullTextIndexDefinition *)fullTextIndexDefinition {
+        return [LabQLiteFullTextIndexDefinition fullTextIndexOnColumns:@[@"common_name", @"common_type"]];
+    }
+
+ @discussion The index is an external-content FTS table: it stores
+ only the index, not a copy of the text, and reads the text back
+ from the mappable class's table. Triggers on that table keep the
+ index in sync with every insert, update and delete; rows already
+ in the table are indexed when the index is created. Query it with
+ SQLite3BinaryOperatorMatch stipulations or the controller's ranked
+ full-text search.
+
+ @see LabQLiteRowMappable
+ */
+@interface LabQLiteFullTextIndexDefinition : NSObject
+
+/**
+ @abstract The name of the FTS table. If nil, it is the table
+ name followed by `_fts`.
+ */
+@property (nonatomic) NSString *name;
+
+/**
+ @abstract The indexed column names. They must be columns of the
+ indexed table.
+ */
+@property (nonatomic) NSArray *columns;
+
+/**
+ @abstract The full-text module; FTS5 unless set otherwise.
+ */
+@property (nonatomic) LabQLiteFullTextModule module;
+
+/**
+ @abstract The tokenizer arguments, e.g. `porter unicode61`. If
+ nil, the module's default tokenizer is used.
+ */
+@property (nonatomic) NSString *tokenizer;
+
+
+
+#pragma mark - Initialization
+
+/**
+ @abstract Returns a new FTS5 index definition with a derived
+ name and the default tokenizer.
+
+ @param columns The indexed column names.
+ */
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexOnColumns:(NSArray *)columns;
+
+/**
+ @abstract Returns a new index definition with a derived name.
+
+ @param columns The indexed column names.
+
+ @param module The full-text module.
+
+ @param tokenizer The tokenizer arguments, or nil.
+ */
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexOnColumns:(NSArray *)columns
+                                                     module:(LabQLiteFullTextModule)module
+                                                  tokenizer:(NSString *)tokenizer;
+
+
+
+#pragma mark - Module Availability
+
+/**
+ @abstract Whether the linked SQLite library was compiled with
+ the provided module (sqlite3_compileoption_used). FTS4 ships in
+ the FTS3 module, so either option provides it.
+ */
++ (BOOL)isModuleAvailable:(LabQLiteFullTextModule)module;
+
+
+
+#pragma mark - SQL Generation
+
+/**
+ @abstract The name the FTS table will have for the provided
+ table.
+ */
+- (NSString *)fullTextTableNameForTable:(NSString *)tableName;
+
+/**
+ @abstract Generates the idempotent statements creating the FTS
+ table and its sync triggers for the provided table, followed by
+ the statement indexing the rows the table already holds.
+ */
+- (NSArray *)creationStatementsForTable:(NSString *)tableName;
+
+/**
+ @abstract The expression ranking matches of the FTS table, best
+ first when sorted ascending.
+
+ @discussion FTS5 uses its built-in bm25 `rank`. FTS4 has no
+ built-in ranking, so its matches are ranked by the negated
+ number of matching phrase instances reported by `offsets()`.
+ */
+- (NSString *)rankingExpressionForTable:(NSString *)tableName;
+
+
+@end
+
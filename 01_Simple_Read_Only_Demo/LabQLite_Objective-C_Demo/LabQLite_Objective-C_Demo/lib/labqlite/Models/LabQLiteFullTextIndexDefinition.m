@@ -0,0 +1,127 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "sqlite3.h"
+#import "LabQLiteFullTextIndexDefinition.h"
+
+
+@implementation LabQLiteFullTextIndexDefinition
+
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexOnColumns:(NSArray *)columns {
+    return [LabQLiteFullTextIndexDefinition fullTextIndexOnColumns:columns
+                                                            module:LabQLiteFullTextModuleFTS5
+                                                         tokenizer:nil];
+}
+
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexOnColumns:(NSArray *)columns
+                                                     module:(LabQLiteFullTextModule)module
+                                                  tokenizer:(NSString *)tokenizer {
+    LabQLiteFullTextIndexDefinition *newIndexDefinition = [[LabQLiteFullTextIndexDefinition alloc] init];
+    newIndexDefinition.columns = columns;
+    newIndexDefinition.module = module;
+    newIndexDefinition.tokenizer = tokenizer;
+    return newIndexDefinition;
+}
+
++ (BOOL)isModuleAvailable:(LabQLiteFullTextModule)module {
+    if (module == LabQLiteFullTextModuleFTS4) {
+        return sqlite3_compileoption_used("ENABLE_FTS4") || sqlite3_compileoption_used("ENABLE_FTS3");
+    }
+    return sqlite3_compileoption_used("ENABLE_FTS5") != 0;
+}
+
+- (NSString *)fullTextTableNameForTable:(NSString *)tableName {
+    if (self.name != nil) return self.name;
+    return [NSString stringWithFormat:@"%@_fts", tableName];
+}
+
+- (NSArray *)creationStatementsForTable:(NSString *)tableName {
+    NSString *ftsTable = [self fullTextTableNameForTable:tableName];
+    NSString *columns = [self.columns componentsJoinedByString:@", "];
+    NSMutableArray *newValues = [NSMutableArray new];
+    NSMutableArray *oldValues = [NSMutableArray new];
+    for (NSString *column in self.columns) {
+        [newValues addObject:[@"new." stringByAppendingString:column]];
+        [oldValues addObject:[@"old." stringByAppendingString:column]];
+    }
+    NSString *insertNew, *removeOld;
+    NSMutableArray *statements = [NSMutableArray new];
+    
+    if (self.module == LabQLiteFullTextModuleFTS4) {
+        NSString *options = [NSString stringWithFormat:@"content=\"%@\", %@", tableName, columns];
+        if (self.tokenizer != nil) {
+            options = [options stringByAppendingFormat:@", tokenize=%@", self.tokenizer];
+        }
+        [statements addObject:[NSString stringWithFormat:@"CREATE VIRTUAL TABLE IF NOT EXISTS %@ USING fts4(%@)", ftsTable, options]];
+        insertNew = [NSString stringWithFormat:@"INSERT INTO %@(docid, %@) VALUES(new.rowid, %@);",
+                     ftsTable, columns, [newValues componentsJoinedByString:@", "]];
+        removeOld = [NSString stringWithFormat:@"DELETE FROM %@ WHERE docid=old.rowid;", ftsTable];
+        
+        // FTS4 reads the old text back from the content table, so
+        // it must be removed before the row changes.
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_bu BEFORE UPDATE ON %@ BEGIN %@ END", ftsTable, tableName, removeOld]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_bd BEFORE DELETE ON %@ BEGIN %@ END", ftsTable, tableName, removeOld]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_au AFTER UPDATE ON %@ BEGIN %@ END", ftsTable, tableName, insertNew]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_ai AFTER INSERT ON %@ BEGIN %@ END", ftsTable, tableName, insertNew]];
+    }
+    else {
+        NSString *options = [NSString stringWithFormat:@"%@, content='%@', content_rowid='rowid'", columns, tableName];
+        if (self.tokenizer != nil) {
+            options = [options stringByAppendingFormat:@", tokenize='%@'", self.tokenizer];
+        }
+        [statements addObject:[NSString stringWithFormat:@"CREATE VIRTUAL TABLE IF NOT EXISTS %@ USING fts5(%@)", ftsTable, options]];
+        insertNew = [NSString stringWithFormat:@"INSERT INTO %@(rowid, %@) VALUES(new.rowid, %@);",
+                     ftsTable, columns, [newValues componentsJoinedByString:@", "]];
+        
+        // FTS5 is handed the old values along with the 'delete'
+        // command, so everything can run after the change.
+        removeOld = [NSString stringWithFormat:@"INSERT INTO %@(%@, rowid, %@) VALUES('delete', old.rowid, %@);",
+                     ftsTable, ftsTable, columns, [oldValues componentsJoinedByString:@", "]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_ai AFTER INSERT ON %@ BEGIN %@ END", ftsTable, tableName, insertNew]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_ad AFTER DELETE ON %@ BEGIN %@ END", ftsTable, tableName, removeOld]];
+        [statements addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@_au AFTER UPDATE ON %@ BEGIN %@ %@ END", ftsTable, tableName, removeOld, insertNew]];
+    }
+    
+    [statements addObject:[NSString stringWithFormat:@"INSERT INTO %@(%@) VALUES('rebuild')", ftsTable, ftsTable]];
+    return statements;
+}
+
+- (NSString *)rankingExpressionForTable:(NSString *)tableName {
+    NSString *ftsTable = [self fullTextTableNameForTable:tableName];
+    if (self.module == LabQLiteFullTextModuleFTS4) {
+        // offsets() yields four integers per matching phrase instance
+        return [NSString stringWithFormat:@"-(length(offsets(%@)) - length(replace(offsets(%@), ' ', '')) + 1)", ftsTable, ftsTable];
+    }
+    return [NSString stringWithFormat:@"%@.rank", ftsTable];
+}
+
+- (NSString *)description {
+    return [[self creationStatementsForTable:@"<table>"] firstObject];
+}
+
+
+@end
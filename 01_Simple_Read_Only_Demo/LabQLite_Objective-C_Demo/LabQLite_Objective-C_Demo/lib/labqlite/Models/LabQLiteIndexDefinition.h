@@ -0,0 +1,123 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+#pragma mark - LabQLiteIndexDefinition Class
+
+/**
+ @abstract Describes a secondary index on the table of a
+ LabQLiteRowMappable class. Mappable classes return these from
+ +indexDefinitions; the database controller creates any that are
+ missing when it is activated. Example:
+
+    + (NSString *)indexedTableName {
+        return @"plant";
+    }
+
+    + (NSArray *)indexDefinitions {
+        return @[[LabQLiteIndexDefinition indexOnColumns:@[@"fk_garden_name", @"fk_garden_address"]
+                                                  unique:NO]];
+    }
+
+ @see LabQLiteRowMappable
+ */
+@interface LabQLiteIndexDefinition : NSObject
+
+/**
+ @abstract The name of the index. If nil, a name is derived
+ from the table and column names.
+ */
+@property (nonatomic) NSString *name;
+
+/**
+ @abstract The indexed column names, in index order.
+ */
+@property (nonatomic) NSArray *columns;
+
+/**
+ @abstract Whether the index is a UNIQUE index.
+ */
+@property (nonatomic) BOOL unique;
+
+/**
+ @abstract The collation of every indexed column, e.g. `NOCASE`.
+ If nil, the columns' own collations are used. A NOCASE index
+ serves the range-rewritten prefix LIKE stipulations of a
+ database whose LIKE is case-insensitive.
+ */
+@property (nonatomic) NSString *collation;
+
+
+
+#pragma mark - Initialization
+
+/**
+ @abstract Returns a new index definition with a derived name.
+
+ @param columns The indexed column names, in index order. One
+ column for a single-column index, several for a composite one.
+
+ @param unique Whether the index is a UNIQUE index.
+ */
++ (LabQLiteIndexDefinition *)indexOnColumns:(NSArray *)columns
+                                     unique:(BOOL)unique;
+
+/**
+ @abstract Returns a new index definition with the provided name.
+
+ @param name The name of the index.
+
+ @param columns The indexed column names, in index order.
+
+ @param unique Whether the index is a UNIQUE index.
+ */
++ (LabQLiteIndexDefinition *)indexNamed:(NSString *)name
+                              onColumns:(NSArray *)columns
+                                 unique:(BOOL)unique;
+
+
+
+#pragma mark - SQL Generation
+
+/**
+ @abstract The name the index will be created with on the
+ provided table.
+ */
+- (NSString *)indexNameForTable:(NSString *)tableName;
+
+/**
+ @abstract Generates the idempotent
+ `CREATE [UNIQUE] INDEX IF NOT EXISTS` statement for this index
+ on the provided table.
+ */
+- (NSString *)creationStatementForTable:(NSString *)tableName;
+
+
+@end
@@ -0,0 +1,82 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteIndexDefinition.h"
+
+
+@implementation LabQLiteIndexDefinition
+
++ (LabQLiteIndexDefinition *)indexOnColumns:(NSArray *)columns
+                                     unique:(BOOL)unique {
+    return [LabQLiteIndexDefinition indexNamed:nil
+                                     onColumns:columns
+                                        unique:unique];
+}
+
++ (LabQLiteIndexDefinition *)indexNamed:(NSString *)name
+                              onColumns:(NSArray *)columns
+                                 unique:(BOOL)unique {
+    LabQLiteIndexDefinition *newIndexDefinition = [[LabQLiteIndexDefinition alloc] init];
+    newIndexDefinition.name = name;
+    newIndexDefinition.columns = columns;
+    newIndexDefinition.unique = unique;
+    return newIndexDefinition;
+}
+
+- (NSString *)indexNameForTable:(NSString *)tableName {
+    if (self.name != nil) return self.name;
+    NSString *indexName = [NSString stringWithFormat:@"%@_%@_%@",
+                           (self.unique ? @"uidx" : @"idx"),
+                           tableName,
+                           [self.columns componentsJoinedByString:@"_"]];
+    if (self.collation != nil) {
+        indexName = [indexName stringByAppendingFormat:@"_%@", [self.collation lowercaseString]];
+    }
+    return indexName;
+}
+
+- (NSString *)creationStatementForTable:(NSString *)tableName {
+    NSString *columnSeparator = @", ";
+    NSString *lastColumnSuffix = @"";
+    if (self.collation != nil) {
+        columnSeparator = [NSString stringWithFormat:@" COLLATE %@, ", self.collation];
+        lastColumnSuffix = [NSString stringWithFormat:@" COLLATE %@", self.collation];
+    }
+    return [NSString stringWithFormat:@"CREATE %@INDEX IF NOT EXISTS %@ ON %@ (%@%@)",
+            (self.unique ? @"UNIQUE " : @""),
+            [self indexNameForTable:tableName],
+            tableName,
+            [self.columns componentsJoinedByString:columnSeparator],
+            lastColumnSuffix];
+}
+
+- (NSString *)description {
+    return [self creationStatementForTable:@"<table>"];
+}
+
+
+@end
@@ -0,0 +1,98 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+/**
+ @abstract Number of histogram buckets: 32 exact buckets for values
+ below 32, then 16 linear sub-buckets per power of two up to 2^64.
+ */
+#define LABQLITE_LATENCY_HISTOGRAM_BUCKET_COUNT 976
+
+
+
+#pragma mark - LabQLiteLatencyHistogram Class
+
+/**
+ @abstract A fixed-size, log-linear (HDR-style) histogram of
+ unsigned 64-bit values such as statement durations in
+ nanoseconds.
+
+ @discussion Values are counted into buckets whose width grows
+ with the value, so every recorded value is known to within
+ roughly 6% while the memory used stays constant no matter how
+ many values are recorded. Recording is O(1). The histogram is
+ not thread safe; callers serialize access.
+ */
+@interface LabQLiteLatencyHistogram : NSObject
+
+/**
+ @abstract The number of recorded values.
+ */
+@property (nonatomic, readonly) uint64_t count;
+
+/**
+ @abstract The sum of all recorded values.
+ */
+@property (nonatomic, readonly) uint64_t totalValue;
+
+/**
+ @abstract The largest recorded value (exact).
+ */
+@property (nonatomic, readonly) uint64_t maxValue;
+
+/**
+ @abstract Records a single value.
+ */
+- (void)recordValue:(uint64_t)value;
+
+/**
+ @abstract Adds every value recorded by another histogram, e.g.
+ to combine per-thread histograms.
+ */
+- (void)addHistogram:(LabQLiteLatencyHistogram *)histogram;
+
+/**
+ @abstract Returns the value below which the provided percentage
+ of the recorded values fall.
+
+ @param percentile A percentage between 0 and 100.
+
+ @return The upper bound of the bucket holding the percentile,
+ capped at maxValue. Zero if nothing was recorded.
+ */
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+/**
+ @abstract Forgets every recorded value.
+ */
+- (void)reset;
+
+
+@end
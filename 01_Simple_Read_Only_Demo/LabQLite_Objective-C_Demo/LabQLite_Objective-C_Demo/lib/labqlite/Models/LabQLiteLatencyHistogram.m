@@ -0,0 +1,98 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import "LabQLiteLatencyHistogram.h"
+
+
+/**
+ @abstract Maps a value onto its bucket. Values below 32 get a bucket
+ of their own; larger values keep their 5 most significant bits.
+ */
+static inline NSUInteger LabQLiteLatencyHistogramBucketForValue(uint64_t value) {
+    if (value < 32) return (NSUInteger)value;
+    int shift = (63 - __builtin_clzll(value)) - 4;
+    uint64_t subBucket = value >> shift;
+    return (NSUInteger)(shift * 16 + subBucket);
+}
+
+/**
+ @abstract The largest value that falls into the provided bucket.
+ */
+static inline uint64_t LabQLiteLatencyHistogramUpperBoundOfBucket(NSUInteger bucket) {
+    if (bucket < 32) return bucket;
+    NSUInteger shift = bucket / 16 - 1;
+    uint64_t subBucket = bucket - shift * 16;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+
+@implementation LabQLiteLatencyHistogram {
+    uint64_t _counts[LABQLITE_LATENCY_HISTOGRAM_BUCKET_COUNT];
+}
+
+- (void)recordValue:(uint64_t)value {
+    _counts[LabQLiteLatencyHistogramBucketForValue(value)]++;
+    _count++;
+    _totalValue += value;
+    if (value > _maxValue) _maxValue = value;
+}
+
+- (void)addHistogram:(LabQLiteLatencyHistogram *)histogram {
+    if (histogram == nil || histogram->_count == 0) return;
+    for (NSUInteger i = 0; i < LABQLITE_LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+        _counts[i] += histogram->_counts[i];
+    }
+    _count += histogram->_count;
+    _totalValue += histogram->_totalValue;
+    if (histogram->_maxValue > _maxValue) _maxValue = histogram->_maxValue;
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile {
+    if (_count == 0) return 0;
+    if (percentile > 100.0) percentile = 100.0;
+    uint64_t rank = (uint64_t)ceil((percentile / 100.0) * (double)_count);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (NSUInteger i = 0; i < LABQLITE_LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+        seen += _counts[i];
+        if (seen >= rank) {
+            uint64_t upperBound = LabQLiteLatencyHistogramUpperBoundOfBucket(i);
+            return upperBound < _maxValue ? upperBound : _maxValue;
+        }
+    }
+    return _maxValue;
+}
+
+- (void)reset {
+    memset(_counts, 0, sizeof(_counts));
+    _count = 0;
+    _totalValue = 0;
+    _maxValue = 0;
+}
+
+
+@end
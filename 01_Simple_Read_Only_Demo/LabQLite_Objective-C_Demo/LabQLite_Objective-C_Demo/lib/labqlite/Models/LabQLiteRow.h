@@ -27,7 +27,7 @@ For more information, please refer to <http://unlicense.org>
 
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "LabQLiteRowMappable.h"
 #import "LabQLiteDatabaseController.h"
 
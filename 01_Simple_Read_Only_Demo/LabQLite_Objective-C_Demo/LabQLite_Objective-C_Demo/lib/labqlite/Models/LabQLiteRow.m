@@ -27,6 +27,7 @@ For more information, please refer to <http://unlicense.org>
 
 
 #import "LabQLiteRow.h"
+#import "LabQLiteDateCodec.h"
 
 
 
@@ -424,11 +425,22 @@ NSString *const LabQLiteRowErrorMessageObjectPropertyOrKeyNotFound = @"Specified
     NSArray *keys = [self propertyKeysMatchingAttributeColumns];
     if ([keys count] > 0) {
         values = [NSMutableArray new];
+        NSDictionary *dateStorages = nil;
+        if ([[self class] respondsToSelector:@selector(dateStorageForColumns)]) {
+            dateStorages = [[self class] dateStorageForColumns];
+        }
         for (int i = 0; i < [keys count]; i++) {
             id value = [self valueForKey:[keys objectAtIndex:i]];
             if (value == nil) {
                 value = [NSNull null];
             }
+            else if ([value isKindOfClass:[NSDate class]]) {
+                NSNumber *storage = [dateStorages objectForKey:[[self columnNames] objectAtIndex:i]];
+                if (storage != nil) {
+                    value = [LabQLiteDateCodec storageValueForDate:value
+                                                           storage:(LabQLiteDateStorage)[storage intValue]];
+                }
+            }
             [values addObject:value];
         }
     }
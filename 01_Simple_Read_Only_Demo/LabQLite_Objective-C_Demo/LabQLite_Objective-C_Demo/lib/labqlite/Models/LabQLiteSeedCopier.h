@@ -0,0 +1,82 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+
+
+#pragma mark - LabQLiteSeedCopier Class
+
+/**
+ @abstract Keeps a writable copy of a seed database (e.g. one
+ shipped in the app bundle) up to date without copying it on
+ every launch.
+
+ @discussion Each copy has a sidecar file next to it recording
+ the stamp of the seed it was made from. The stamp is read from
+ the seed's 100-byte SQLite header: its PRAGMA user_version, its
+ file change counter and its page count, so checking whether a
+ copy is current costs two small reads instead of a hash of the
+ whole file. Copies are made with a file clone where the file
+ system supports it (copyfile on Apple platforms,
+ copy_file_range on Linux) and a plain read/write loop
+ otherwise, into a temporary file which is then renamed into
+ place, so an interrupted copy never looks current.
+ */
+@interface LabQLiteSeedCopier : NSObject
+
+/**
+ @abstract The stamp of the database at the provided path, or nil
+ if it cannot be read or is not an SQLite database.
+ */
++ (NSString *)stampForDatabaseAtPath:(NSString *)path
+                               error:(NSError **)error;
+
+/**
+ @abstract The path of the sidecar recording which seed the copy
+ at the provided path was made from.
+ */
++ (NSString *)sidecarPathForCopyAtPath:(NSString *)copyPath;
+
+/**
+ @abstract Whether a copy exists at the provided path and was made
+ from the seed as it is now.
+ */
++ (BOOL)isCopyAtPath:(NSString *)copyPath
+ currentWithSeedAtPath:(NSString *)seedPath;
+
+/**
+ @abstract Copies the seed to the provided path (creating the
+ directory if need be) and records its stamp in the sidecar.
+
+ @return Whether the copy and its sidecar are in place.
+ */
++ (BOOL)copySeedAtPath:(NSString *)seedPath
+                toPath:(NSString *)copyPath
+                 error:(NSError **)error;
+
+@end
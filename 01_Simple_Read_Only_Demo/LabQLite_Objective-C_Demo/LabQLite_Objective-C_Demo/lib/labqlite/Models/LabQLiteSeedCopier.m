@@ -0,0 +1,219 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#import "LabQLiteSeedCopier.h"
+#import "LabQLiteDatabase.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <copyfile.h>
+#endif
+
+
+/**
+ @abstract The SQLite database header is 100 bytes long and starts
+ with this 16-byte magic string.
+ */
+static const char LabQLiteSQLiteHeaderMagic[16] = "SQLite format 3";
+
+static uint32_t LabQLiteReadBigEndian32(const unsigned char *bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+static NSError *LabQLitePOSIXError(int code, NSString *path) {
+    return [NSError errorWithDomain:NSPOSIXErrorDomain
+                               code:code
+                           userInfo:@{@"errorMessage" : [NSString stringWithUTF8String:strerror(code)],
+                                      @"errorDetails" : [NSString stringWithFormat:@"Path: %@", path]}];
+}
+
+/**
+ @abstract Copies every byte from one descriptor to another, with
+ copy_file_range where available (which lets the kernel share or
+ clone extents) and read/write otherwise.
+ */
+static BOOL LabQLiteCopyFileContents(int sourceDescriptor, int destinationDescriptor, off_t length) {
+#if defined(__linux__)
+    off_t remaining = length;
+    while (remaining > 0) {
+        ssize_t copied = copy_file_range(sourceDescriptor, NULL, destinationDescriptor, NULL, (size_t)remaining, 0);
+        if (copied < 0) {
+            if (errno == EINTR) continue;
+            if (remaining == length && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) break;
+            return NO;
+        }
+        if (copied == 0) break;
+        remaining -= copied;
+    }
+    if (remaining == 0) return YES;
+    if (remaining != length) return NO;
+#endif
+    char buffer[1 << 16];
+    for (;;) {
+        ssize_t readCount = read(sourceDescriptor, buffer, sizeof(buffer));
+        if (readCount < 0) {
+            if (errno == EINTR) continue;
+            return NO;
+        }
+        if (readCount == 0) return YES;
+        for (ssize_t written = 0; written < readCount; ) {
+            ssize_t writeCount = write(destinationDescriptor, buffer + written, (size_t)(readCount - written));
+            if (writeCount < 0) {
+                if (errno == EINTR) continue;
+                return NO;
+            }
+            written += writeCount;
+        }
+    }
+}
+
+
+@implementation LabQLiteSeedCopier
+
++ (NSString *)stampForDatabaseAtPath:(NSString *)path
+                               error:(NSError **)error {
+    int descriptor = open([path fileSystemRepresentation], O_RDONLY);
+    if (descriptor < 0) {
+        if (error != NULL) *error = LabQLitePOSIXError(errno, path);
+        return nil;
+    }
+    unsigned char header[100];
+    ssize_t readCount = pread(descriptor, header, sizeof(header), 0);
+    close(descriptor);
+    if (readCount != (ssize_t)sizeof(header) ||
+        memcmp(header, LabQLiteSQLiteHeaderMagic, sizeof(LabQLiteSQLiteHeaderMagic)) != 0) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:LabQLiteErrorDomain
+                                         code:LabQLiteErrorDatabasePathPointsToNonDatabase
+                                     userInfo:@{@"errorMessage" : LabQLiteErrorMessageDatabasePathPointsToNonDatabase,
+                                                @"errorDetails" : [NSString stringWithFormat:@"Path: %@", path]}];
+        }
+        return nil;
+    }
+    
+    // Offsets are those of the SQLite file format: file change
+    // counter at 24, database size in pages at 28 and
+    // user_version at 60, all big-endian.
+    return [NSString stringWithFormat:@"user_version=%u change_counter=%u page_count=%u",
+            LabQLiteReadBigEndian32(header + 60),
+            LabQLiteReadBigEndian32(header + 24),
+            LabQLiteReadBigEndian32(header + 28)];
+}
+
++ (NSString *)sidecarPathForCopyAtPath:(NSString *)copyPath {
+    return [copyPath stringByAppendingString:@".labqlite-seed"];
+}
+
++ (BOOL)isCopyAtPath:(NSString *)copyPath
+ currentWithSeedAtPath:(NSString *)seedPath {
+    if (![[NSFileManager defaultManager] fileExistsAtPath:copyPath]) return NO;
+    NSString *recordedStamp = [NSString stringWithContentsOfFile:[LabQLiteSeedCopier sidecarPathForCopyAtPath:copyPath]
+                                                        encoding:NSUTF8StringEncoding
+                                                           error:NULL];
+    if (recordedStamp == nil) return NO;
+    NSString *seedStamp = [LabQLiteSeedCopier stampForDatabaseAtPath:seedPath error:NULL];
+    return seedStamp != nil && [recordedStamp isEqualToString:seedStamp];
+}
+
++ (BOOL)copySeedAtPath:(NSString *)seedPath
+                toPath:(NSString *)copyPath
+                 error:(NSError **)error {
+    NSString *stamp = [LabQLiteSeedCopier stampForDatabaseAtPath:seedPath error:error];
+    if (stamp == nil) return NO;
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![fileManager createDirectoryAtPath:[copyPath stringByDeletingLastPathComponent]
+                withIntermediateDirectories:YES
+                                 attributes:nil
+                                      error:error]) {
+        return NO;
+    }
+    
+    // The sidecar goes first so that a copy is never paired with
+    // the stamp of the seed it replaced.
+    NSString *sidecarPath = [LabQLiteSeedCopier sidecarPathForCopyAtPath:copyPath];
+    [fileManager removeItemAtPath:sidecarPath error:NULL];
+    
+    NSString *temporaryPath = [copyPath stringByAppendingString:@".partial"];
+    [fileManager removeItemAtPath:temporaryPath error:NULL];
+    
+#if defined(__APPLE__)
+    if (copyfile([seedPath fileSystemRepresentation], [temporaryPath fileSystemRepresentation], NULL, COPYFILE_CLONE) != 0) {
+        if (error != NULL) *error = LabQLitePOSIXError(errno, seedPath);
+        return NO;
+    }
+#else
+    int sourceDescriptor = open([seedPath fileSystemRepresentation], O_RDONLY);
+    if (sourceDescriptor < 0) {
+        if (error != NULL) *error = LabQLitePOSIXError(errno, seedPath);
+        return NO;
+    }
+    int destinationDescriptor = open([temporaryPath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (destinationDescriptor < 0) {
+        if (error != NULL) *error = LabQLitePOSIXError(errno, temporaryPath);
+        close(sourceDescriptor);
+        return NO;
+    }
+    struct stat sourceStatus;
+    BOOL copied = fstat(sourceDescriptor, &sourceStatus) == 0 &&
+                  LabQLiteCopyFileContents(sourceDescriptor, destinationDescriptor, sourceStatus.st_size) &&
+                  fsync(destinationDescriptor) == 0;
+    int copyErrno = errno;
+    close(sourceDescriptor);
+    close(destinationDescriptor);
+    if (!copied) {
+        if (error != NULL) *error = LabQLitePOSIXError(copyErrno, temporaryPath);
+        unlink([temporaryPath fileSystemRepresentation]);
+        return NO;
+    }
+#endif
+    
+    // Any journal left beside an older copy belongs to it, not to
+    // the new one.
+    for (NSString *suffix in @[@"-journal", @"-wal", @"-shm"]) {
+        [fileManager removeItemAtPath:[copyPath stringByAppendingString:suffix] error:NULL];
+    }
+    if (rename([temporaryPath fileSystemRepresentation], [copyPath fileSystemRepresentation]) != 0) {
+        if (error != NULL) *error = LabQLitePOSIXError(errno, copyPath);
+        unlink([temporaryPath fileSystemRepresentation]);
+        return NO;
+    }
+    return [stamp writeToFile:sidecarPath
+                   atomically:YES
+                     encoding:NSUTF8StringEncoding
+                        error:error];
+}
+
+
+@end
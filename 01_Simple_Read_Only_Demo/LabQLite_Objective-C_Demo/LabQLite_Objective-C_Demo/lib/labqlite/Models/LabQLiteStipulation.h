@@ -27,7 +27,7 @@ For more information, please refer to <http://unlicense.org>
 
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "LabQLiteConstants.h"
 #import "LabQLiteValidationController.h"
@@ -113,9 +113,12 @@ FOUNDATION_EXPORT NSString *const LabQLiteStipulationErrorMessageInvalidBinaryOp
 
 /**
  @abstract The value of the attribute being
- stipulated
+ stipulated: an NSString, NSNumber, NSData, NSDate
+ or NSNull, kept as provided and bound natively
+ (e.g. integers as 64-bit integers) so that the
+ comparison can use the column's indexes.
  */
-@property (nonatomic) NSString *value;
+@property (nonatomic) id value;
 
 /**
  @abstract The SQLite attribute affinity
@@ -71,44 +71,10 @@ NSString *const LabQLiteStipulationErrorMessageInvalidBinaryOperator = @"Invalid
         return nil;
     }
     
-    // Because a value can be an:
-    //    NSDate,
-    //    NSString,
-    //    NSData,
-    //    or NSNumber,
-    // we have to extract the value appropriately
-    // and make it into a string form for SQLite
-    // processing purposes.
-    
-    
-    NSString *stringValue;
-    
-    if ([value isKindOfClass:[NSNumber class]]) {
-        NSNumber *v = (NSNumber *)value;
-        stringValue = [v stringValue];
-    }
-    else if ([value isKindOfClass:[NSString class]]) {
-        NSString *v = (NSString *)value;
-        stringValue = v;
-    }
-    else if ([value isKindOfClass:[NSData class]]) {
-        NSData *v = (NSData *)value;
-        stringValue = [[NSString alloc] initWithData:v encoding:NSUTF8StringEncoding];
-    }
-    else if ([value isKindOfClass:[NSDate class]]) {
-        NSDate *v = (NSDate *)value;
-        NSDateFormatter *defaultFormatter = [[NSDateFormatter alloc] init];
-        [defaultFormatter setDateFormat:@"yyyy-MM-DD HH:mm:ss ZZZZ"];
-        stringValue = [defaultFormatter stringFromDate:v];
-    }
-    else {
-        // ERROR: Default value is NULL.
-        stringValue = @"NULL";
-    }
-    
-    
-    newStipulation.value = stringValue;
-    
+    // The value is kept as provided (NSString, NSNumber,
+    // NSData or NSDate) and bound natively when the
+    // stipulation is processed; nil stands for NULL.
+    newStipulation.value = value != nil ? value : [NSNull null];
     
     newStipulation.affinity = affinityTypeOfValue;
     newStipulation.precedingLogicalOperator = precedingLogicalOperator;
@@ -116,9 +82,9 @@ NSString *const LabQLiteStipulationErrorMessageInvalidBinaryOperator = @"Invalid
 }
 
 + (NSArray *)valuesForBindingFromStipulations:(NSArray *)arrayOfStipulations {
-    NSMutableArray *values = [NSMutableArray new];
+    NSMutableArray *values = [[NSMutableArray alloc] initWithCapacity:[arrayOfStipulations count]];
     for (LabQLiteStipulation *s in arrayOfStipulations) {
-        [values addObject:s.value];
+        [values addObject:(s.value != nil ? s.value : [NSNull null])];
     }
     NSArray *valuesImmutable = [NSArray arrayWithArray:values];
     return valuesImmutable;
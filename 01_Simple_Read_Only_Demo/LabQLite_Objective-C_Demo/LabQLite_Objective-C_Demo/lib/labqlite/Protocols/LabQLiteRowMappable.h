@@ -26,8 +26,9 @@ For more information, please refer to <http://unlicense.org>
  */
 
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
+@class LabQLiteFullTextIndexDefinition;
 
 
 #pragma mark - SQLite3 Affinity Rules Enumerated as NSNumbers
@@ -47,6 +48,11 @@ For more information, please refer to <http://unlicense.org>
  processable by an LabQLiteDatabaseController. In this
  respect, such objects represent rows in a table or view.
  
+ If the controller's parallelMappingEnabled is YES, objects of a
+ conforming class are initialized and have their properties set
+ on several threads at once, one object per thread; -init and
+ the setters must not touch shared state unsynchronized.
+ 
  @see LabQLiteDatabaseController
  */
 @protocol LabQLiteRowMappable <NSObject>
@@ -121,6 +127,79 @@ For more information, please refer to <http://unlicense.org>
  */
 - (BOOL)isValid:(NSError **)error;
 
+/**
+ @abstract Declares the secondary indexes (single-column,
+ composite or unique) which the table of this class should have.
+
+ @discussion When a read-write LabQLiteDatabaseController is
+ activated or initialized, every class implementing this method
+ and +indexedTableName whose table exists in the opened database
+ has its missing indexes created, all in one transaction. Indexes
+ which already exist are left untouched.
+
+ @return An array of LabQLiteIndexDefinition objects.
+
+ @see LabQLiteIndexDefinition
+ */
++ (NSArray *)indexDefinitions;
+
+/**
+ @abstract The name of the table the declared indexes belong to;
+ the same as -tableName of instances.
+
+ @discussion Required alongside +indexDefinitions or
+ +fullTextIndexDefinition. Classes declaring indexes without it
+ are ignored.
+ */
++ (NSString *)indexedTableName;
+
+/**
+ @abstract Declares a full-text index over text columns of the
+ table of this class.
+
+ @discussion Created, together with the triggers keeping it in
+ sync, when missing at the same time as +indexDefinitions.
+ SQLite3BinaryOperatorMatch stipulations on this class's table
+ are answered from it. Requires a rowid table.
+
+ @return The full-text index definition.
+
+ @see LabQLiteFullTextIndexDefinition
+ */
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexDefinition;
+
+/**
+ @abstract Declares columns (typically large BLOBs) which should
+ not be fetched when rows of this class are mapped.
+
+ @discussion The controller leaves these columns out of its
+ SELECT and sets a LabQLiteFault on the matching property
+ instead. The fault loads the value by rowid the first time it
+ is used, together with the same column of neighbouring objects
+ mapped by the same query. Requires a rowid table.
+
+ @return The names of the lazily loaded columns.
+
+ @see LabQLiteFault
+ */
++ (NSArray *)lazilyLoadedColumnNames;
+
+/**
+ @abstract Declares the columns which hold dates, and how each
+ stores them.
+
+ @discussion Values of these columns are decoded into NSDates
+ when rows of this class are mapped. NSDate property values are
+ encoded with the declared storage when bound; dates in columns
+ not listed here use the storage matching the column affinity.
+
+ @return A dictionary of column names to NSNumber-wrapped
+ LabQLiteDateStorage values.
+
+ @see LabQLiteDateCodec
+ */
++ (NSDictionary *)dateStorageForColumns;
+
 
 @end
 
@@ -0,0 +1,1374 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+
+#if __has_include(<XCTest/XCTest.h>)
+
+#import <XCTest/XCTest.h>
+#import "LabQLite.h"
+#import "LabQLiteDateCodec.h"
+#import "LabQLiteMetrics.h"
+#import "LabQLiteFault.h"
+
+
+
+#pragma mark - Private LabQLite Methods Under Test
+
+@interface LabQLiteDatabaseController (PrivateMethods)
+
+- (NSArray *)rowidRangesForParallelScanOfTable:(NSString *)tableName
+                                         error:(NSError **)error;
+
+- (NSString *)appendStipulations:(NSArray *)arrayOfStipulations
+                        forTable:(NSString *)tableName
+                likePrefixBounds:(NSArray *)likePrefixBounds
+                     toSQLString:(NSString *)sqlString;
+
+- (NSArray *)likePrefixBoundsForStipulations:(NSArray *)stipulations
+                                    forTable:(NSString *)tableName;
+
+- (void)setDatabase:(LabQLiteDatabase *)database;
+
+@end
+
+
+
+#pragma mark - Test Rows
+
+/**
+ @abstract Row of the `behavior_plant` table the sharding tests
+ spread over several files.
+ */
+@interface LabQLiteBehaviorPlantRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *plantID;
+@property (nonatomic) NSString *name;
+
+@end
+
+@implementation LabQLiteBehaviorPlantRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = @"behavior_plant";
+        _columnNames = @[@"plant_id", @"name"];
+        _propertyKeysMatchingAttributeColumns = @[@"plantID", @"name"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_TEXT];
+    }
+    return self;
+}
+
+@end
+
+/**
+ @abstract Row of the `behavior_harvest` table, whose dates are
+ stored as Unix epoch integers.
+ */
+@interface LabQLiteBehaviorHarvestRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *harvestID;
+@property (nonatomic) NSDate *harvested;
+
+@end
+
+@implementation LabQLiteBehaviorHarvestRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = @"behavior_harvest";
+        _columnNames = @[@"harvest_id", @"harvested"];
+        _propertyKeysMatchingAttributeColumns = @[@"harvestID", @"harvested"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_INTEGER];
+    }
+    return self;
+}
+
++ (NSDictionary *)dateStorageForColumns {
+    return @{@"harvested" : @(LabQLiteDateStorageUnixEpoch)};
+}
+
+@end
+
+/**
+ @abstract Row of the `behavior_note` table, which declares an
+ FTS5 index over its body.
+ */
+@interface LabQLiteBehaviorNoteRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *noteID;
+@property (nonatomic) NSString *body;
+
+@end
+
+@implementation LabQLiteBehaviorNoteRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = @"behavior_note";
+        _columnNames = @[@"note_id", @"body"];
+        _propertyKeysMatchingAttributeColumns = @[@"noteID", @"body"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_TEXT];
+    }
+    return self;
+}
+
++ (NSString *)indexedTableName {
+    return @"behavior_note";
+}
+
++ (LabQLiteFullTextIndexDefinition *)fullTextIndexDefinition {
+    return [LabQLiteFullTextIndexDefinition fullTextIndexOnColumns:@[@"body"]];
+}
+
+@end
+
+/**
+ @abstract Row of the `behavior_bed` table, which declares a
+ unique composite index and a NOCASE one.
+ */
+@interface LabQLiteBehaviorBedRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *bedID;
+@property (nonatomic) NSString *garden;
+@property (nonatomic) NSNumber *bedNumber;
+
+@end
+
+@implementation LabQLiteBehaviorBedRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = @"behavior_bed";
+        _columnNames = @[@"bed_id", @"garden", @"bed_number"];
+        _propertyKeysMatchingAttributeColumns = @[@"bedID", @"garden", @"bedNumber"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_TEXT,
+                                            SQLITE_AFFINITY_TYPE_INTEGER];
+    }
+    return self;
+}
+
++ (NSString *)indexedTableName {
+    return @"behavior_bed";
+}
+
++ (NSArray *)indexDefinitions {
+    LabQLiteIndexDefinition *gardenIndex = [LabQLiteIndexDefinition indexOnColumns:@[@"garden"] unique:NO];
+    gardenIndex.collation = @"NOCASE";
+    return @[[LabQLiteIndexDefinition indexOnColumns:@[@"garden", @"bed_number"] unique:YES],
+             gardenIndex];
+}
+
+@end
+
+
+
+#pragma mark - LabQLiteBehaviorTests
+
+/**
+ @abstract Assertion-based tests of the controller and database
+ features, each against a scratch database of its own.
+ */
+@interface LabQLiteBehaviorTests : XCTestCase
+
+@property (nonatomic) NSString *scratchDirectory;
+@property (nonatomic) NSString *databasePath;
+
+@end
+
+@implementation LabQLiteBehaviorTests
+
+- (void)setUp {
+    [super setUp];
+    self.scratchDirectory = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                             [NSString stringWithFormat:@"labqlite-behavior-%@", [[NSUUID UUID] UUIDString]]];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.scratchDirectory
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:NULL];
+    self.databasePath = [self scratchPathForFileNamed:@"behavior.sqlite3"];
+}
+
+- (void)tearDown {
+    // Shards, backups and journals all live in the scratch directory
+    [[NSFileManager defaultManager] removeItemAtPath:self.scratchDirectory error:NULL];
+    [super tearDown];
+}
+
+- (NSString *)scratchPathForFileNamed:(NSString *)fileName {
+    return [self.scratchDirectory stringByAppendingPathComponent:fileName];
+}
+
+/**
+ @abstract Runs schema or fixture SQL straight through sqlite3,
+ so that fixtures do not depend on the code under test.
+ */
+- (void)executeFixtureSQL:(NSString *)sql {
+    [self executeFixtureSQL:sql inDatabaseAtPath:self.databasePath];
+}
+
+- (void)executeFixtureSQL:(NSString *)sql inDatabaseAtPath:(NSString *)databasePath {
+    sqlite3 *database = NULL;
+    int resultCode = sqlite3_open([databasePath UTF8String], &database);
+    if (resultCode == SQLITE_OK) {
+        resultCode = sqlite3_exec(database, [sql UTF8String], NULL, NULL, NULL);
+    }
+    XCTAssertEqual(resultCode, SQLITE_OK, @"%s", sqlite3_errmsg(database));
+    sqlite3_close(database);
+}
+
+/**
+ @abstract Counts rows straight through sqlite3, to see what has
+ reached a file whatever the code under test holds in memory.
+ */
+- (long long)fixtureCountOfRowsInTable:(NSString *)tableName
+                      inDatabaseAtPath:(NSString *)databasePath {
+    sqlite3 *database = NULL;
+    sqlite3_stmt *statement = NULL;
+    long long count = -1;
+    NSString *sql = [NSString stringWithFormat:@"SELECT count(*) FROM %@", tableName];
+    if (sqlite3_open_v2([databasePath UTF8String], &database, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK &&
+        sqlite3_prepare_v2(database, [sql UTF8String], -1, &statement, NULL) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW) {
+        count = sqlite3_column_int64(statement, 0);
+    }
+    sqlite3_finalize(statement);
+    sqlite3_close(database);
+    return count;
+}
+
+- (NSArray *)firstColumnOfRows:(NSArray *)rows {
+    NSMutableArray *values = [[NSMutableArray alloc] initWithCapacity:[rows count]];
+    for (NSArray *row in rows) {
+        [values addObject:[row firstObject]];
+    }
+    return values;
+}
+
+- (LabQLiteDatabaseController *)controller {
+    NSError *error;
+    LabQLiteDatabaseController *controller = [[LabQLiteDatabaseController alloc] initWithDatabasePath:self.databasePath
+                                                                                                error:&error];
+    XCTAssertNotNil(controller, @"%@", error);
+    return controller;
+}
+
+
+
+#pragma mark - Parallel Range Scans
+
+- (void)testParallelScanSplitsLargeTablesIntoSeveralRanges {
+    long long rowCount = 3 * LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION;
+    [self executeFixtureSQL:[NSString stringWithFormat:
+                             @"CREATE TABLE scan_row (id INTEGER PRIMARY KEY, name TEXT);"
+                             @"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %lld) "
+                             @"INSERT INTO scan_row (id, name) SELECT i, 'row-' || i FROM n;", rowCount]];
+    LabQLiteDatabaseController *controller = [self controller];
+    controller.parallelScanPartitionCount = 4;
+    
+    NSError *error;
+    NSArray *ranges = [controller rowidRangesForParallelScanOfTable:@"scan_row" error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual([ranges count], (NSUInteger)3);
+    XCTAssertEqual([[[ranges firstObject] firstObject] longLongValue], 1);
+    XCTAssertEqual([[[ranges lastObject] lastObject] longLongValue], rowCount);
+    
+    [LabQLiteMetrics reset];
+    NSArray *rows = [controller rowsFromTable:@"scan_row"
+                         withSpecifiedColumns:@[@"id"]
+                                 stipulations:nil
+                                       offset:0
+                   andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                    orderedBy:nil
+                                        error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual((long long)[rows count], rowCount);
+    XCTAssertEqual([[[rows firstObject] firstObject] longLongValue], 1);
+    XCTAssertEqual([[[rows lastObject] firstObject] longLongValue], rowCount);
+    
+    // One connection per range
+    XCTAssertGreaterThanOrEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricConnectionOpens], (uint64_t)[ranges count]);
+}
+
+- (void)testParallelScanLeavesStipulatedReadsSerial {
+    long long rowCount = 3 * LABQLITE_WRAPPER_PARALLEL_SCAN_MIN_ROWS_PER_PARTITION;
+    [self executeFixtureSQL:[NSString stringWithFormat:
+                             @"CREATE TABLE scan_row (id INTEGER PRIMARY KEY, name TEXT);"
+                             @"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %lld) "
+                             @"INSERT INTO scan_row (id, name) SELECT i, 'row-' || i FROM n;", rowCount]];
+    LabQLiteDatabaseController *controller = [self controller];
+    controller.parallelScanPartitionCount = 4;
+    NSArray *stipulations = @[[self stipulationWithAttribute:@"name"
+                                              binaryOperator:SQLite3BinaryOperatorEquals
+                                                       value:@"row-2"
+                                                    affinity:SQLITE_AFFINITY_TYPE_TEXT]];
+    
+    [LabQLiteMetrics reset];
+    NSError *error;
+    NSArray *rows = [controller rowsFromTable:@"scan_row"
+                         withSpecifiedColumns:@[@"id"]
+                                 stipulations:stipulations
+                                       offset:0
+                   andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                    orderedBy:nil
+                                        error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual([rows count], (NSUInteger)1);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricConnectionOpens], (uint64_t)1);
+}
+
+- (void)testParallelScanLeavesSmallAndRowlessTablesSerial {
+    [self executeFixtureSQL:@"CREATE TABLE small_row (id INTEGER PRIMARY KEY);"
+                            @"INSERT INTO small_row VALUES (1), (2), (3);"
+                            @"CREATE TABLE keyed_row (k TEXT PRIMARY KEY) WITHOUT ROWID;"];
+    LabQLiteDatabaseController *controller = [self controller];
+    controller.parallelScanPartitionCount = 4;
+    
+    NSError *error;
+    XCTAssertNil([controller rowidRangesForParallelScanOfTable:@"small_row" error:&error]);
+    XCTAssertNil(error);
+    XCTAssertNil([controller rowidRangesForParallelScanOfTable:@"keyed_row" error:&error]);
+    XCTAssertNil(error);
+    XCTAssertNil([controller rowidRangesForParallelScanOfTable:@"missing_row" error:&error]);
+    XCTAssertNil(error);
+}
+
+
+
+#pragma mark - Parallel Mapping
+
+- (void)testParallelMappingIsOptInAndKeepsRowOrder {
+    long long rowCount = 3 * LABQLITE_WRAPPER_PARALLEL_MAPPING_MIN_ROWS;
+    [self executeFixtureSQL:[NSString stringWithFormat:
+                             @"CREATE TABLE behavior_harvest (harvest_id INTEGER PRIMARY KEY, harvested INTEGER);"
+                             @"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %lld) "
+                             @"INSERT INTO behavior_harvest SELECT i, 1700000000 + i FROM n;", rowCount]];
+    LabQLiteDatabaseController *controller = [self controller];
+    XCTAssertFalse(controller.parallelMappingEnabled);
+    controller.parallelMappingEnabled = YES;
+    
+    NSError *error;
+    NSArray *harvests = [controller allRows:@"behavior_harvest"
+                         SQLite3RowSubclass:[LabQLiteBehaviorHarvestRow class]
+                                      error:&error];
+    XCTAssertNotNil(harvests, @"%@", error);
+    XCTAssertEqual((long long)[harvests count], rowCount);
+    [harvests enumerateObjectsUsingBlock:^(LabQLiteBehaviorHarvestRow *harvest, NSUInteger i, BOOL *stop) {
+        XCTAssertEqual([harvest.harvestID longLongValue], (long long)i + 1);
+        XCTAssertEqualObjects(harvest.harvested, [NSDate dateWithTimeIntervalSince1970:1700000000 + i + 1]);
+        *stop = [harvest.harvestID longLongValue] != (long long)i + 1;
+    }];
+}
+
+
+
+#pragma mark - Batched Key Lookups
+
+- (void)testBatchedKeyLookupFilesRowsUnderTheCallersKeys {
+    [self executeFixtureSQL:@"CREATE TABLE code (code TEXT PRIMARY KEY, label TEXT);"
+                            @"INSERT INTO code VALUES ('3', 'three'), ('5', 'five');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    
+    NSError *error;
+    NSDictionary *rows = [controller rowsFromTable:@"code"
+                                     withKeyColumn:@"code"
+                                          inValues:@[@3, @"5", @9]
+                                          affinity:SQLITE_AFFINITY_TYPE_TEXT
+                                             error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual([rows count], (NSUInteger)2);
+    XCTAssertEqualObjects([[rows objectForKey:@3] lastObject], @"three");
+    XCTAssertEqualObjects([[rows objectForKey:@"5"] lastObject], @"five");
+    XCTAssertNil([rows objectForKey:@9]);
+}
+
+- (void)testBatchedKeyLookupSpansSeveralStatements {
+    long long rowCount = 2 * LABQLITE_WRAPPER_MAX_BOUND_PARAMETERS_PER_STATEMENT + 1;
+    [self executeFixtureSQL:[NSString stringWithFormat:
+                             @"CREATE TABLE keyed (id INTEGER PRIMARY KEY, name TEXT);"
+                             @"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %lld) "
+                             @"INSERT INTO keyed (id, name) SELECT i, 'row-' || i FROM n;", rowCount]];
+    LabQLiteDatabaseController *controller = [self controller];
+    
+    NSMutableArray *keys = [NSMutableArray new];
+    for (long long i = 1; i <= rowCount + 10; i++) {
+        [keys addObject:@(i)];
+    }
+    NSError *error;
+    NSDictionary *rows = [controller rowsFromTable:@"keyed"
+                                     withKeyColumn:@"id"
+                                          inValues:keys
+                                          affinity:SQLITE_AFFINITY_TYPE_INTEGER
+                                             error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual((long long)[rows count], rowCount);
+    XCTAssertEqualObjects([[rows objectForKey:@(rowCount)] firstObject], @(rowCount));
+    XCTAssertEqualObjects([[rows objectForKey:@1000] lastObject], @"row-1000");
+    XCTAssertNil([rows objectForKey:@(rowCount + 1)]);
+}
+
+- (void)testBatchedCompositeKeyLookup {
+    [self executeFixtureSQL:@"CREATE TABLE bed (garden TEXT, number INTEGER, crop TEXT, PRIMARY KEY (garden, number));"
+                            @"INSERT INTO bed VALUES ('north', 1, 'kale'), ('north', 2, 'leek'), ('south', 1, 'bean');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    
+    NSError *error;
+    NSDictionary *rows = [controller rowsFromTable:@"bed"
+                                    withKeyColumns:@[@"garden", @"number"]
+                                     inValueTuples:@[@[@"north", @2], @[@"south", @"1"], @[@"south", @2]]
+                                        affinities:@[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_INTEGER]
+                                             error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual([rows count], (NSUInteger)2);
+    XCTAssertEqualObjects([[rows objectForKey:@[@"north", @2]] lastObject], @"leek");
+    XCTAssertEqualObjects([[rows objectForKey:@[@"south", @"1"]] lastObject], @"bean");
+}
+
+
+
+#pragma mark - LIKE Prefix Rewrites
+
+- (LabQLiteStipulation *)stipulationWithAttribute:(NSString *)attribute
+                                   binaryOperator:(SQLite3BinaryOperator *)binaryOperator
+                                            value:(id)value
+                                         affinity:(NSNumber *)affinity {
+    NSError *error;
+    LabQLiteStipulation *stipulation = [LabQLiteStipulation stipulationWithAttribute:attribute
+                                                                     binaryOperator:binaryOperator
+                                                                              value:value
+                                                                           affinity:affinity
+                                                           precedingLogicalOperator:nil
+                                                                              error:&error];
+    XCTAssertNotNil(stipulation, @"%@", error);
+    return stipulation;
+}
+
+- (NSSet *)namesFromTable:(NSString *)tableName
+         withStipulations:(NSArray *)stipulations
+             ofController:(LabQLiteDatabaseController *)controller {
+    NSError *error;
+    NSArray *rows = [controller rowsFromTable:tableName
+                         withSpecifiedColumns:@[@"name"]
+                                 stipulations:stipulations
+                                       offset:0
+                   andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                    orderedBy:nil
+                                        error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    return [NSSet setWithArray:[self firstColumnOfRows:rows]];
+}
+
+- (NSString *)whereClauseOfStipulations:(NSArray *)stipulations
+                              forTable:(NSString *)tableName
+                          ofController:(LabQLiteDatabaseController *)controller {
+    return [controller appendStipulations:stipulations
+                                 forTable:tableName
+                         likePrefixBounds:[controller likePrefixBoundsForStipulations:stipulations forTable:tableName]
+                              toSQLString:@""];
+}
+
+- (void)testLikePrefixIsRewrittenIntoARange {
+    [self executeFixtureSQL:@"CREATE TABLE fruit (id INTEGER PRIMARY KEY, name TEXT);"
+                            @"CREATE INDEX fruit_name_nocase ON fruit (name COLLATE NOCASE);"
+                            @"CREATE INDEX fruit_name ON fruit (name);"
+                            @"INSERT INTO fruit (name) VALUES ('apple'), ('Apricot'), ('banana');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSArray *stipulations = @[[self stipulationWithAttribute:@"name"
+                                              binaryOperator:SQLite3BinaryOperatorLike
+                                                       value:@"ap%"
+                                                    affinity:SQLITE_AFFINITY_TYPE_TEXT]];
+    
+    NSString *sql = [self whereClauseOfStipulations:stipulations forTable:@"fruit" ofController:controller];
+    XCTAssertTrue([sql containsString:@"name >= ? COLLATE NOCASE"], @"%@", sql);
+    XCTAssertFalse([sql containsString:@"LIKE"], @"%@", sql);
+    XCTAssertEqualObjects([self namesFromTable:@"fruit" withStipulations:stipulations ofController:controller],
+                          ([NSSet setWithObjects:@"apple", @"Apricot", nil]));
+    
+    controller.database.caseSensitiveLike = YES;
+    sql = [self whereClauseOfStipulations:stipulations forTable:@"fruit" ofController:controller];
+    XCTAssertTrue([sql containsString:@"name >= ? COLLATE BINARY"], @"%@", sql);
+    XCTAssertEqualObjects([self namesFromTable:@"fruit" withStipulations:stipulations ofController:controller],
+                          [NSSet setWithObject:@"apple"]);
+}
+
+- (void)testLikePrefixWithoutAnIndexOfItsCollationStaysLike {
+    [self executeFixtureSQL:@"CREATE TABLE fruit (id INTEGER PRIMARY KEY, name TEXT);"
+                            @"CREATE INDEX fruit_name ON fruit (name);"
+                            @"INSERT INTO fruit (name) VALUES ('apple'), ('Apricot'), ('banana');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSArray *stipulations = @[[self stipulationWithAttribute:@"name"
+                                              binaryOperator:SQLite3BinaryOperatorLike
+                                                       value:@"ap%"
+                                                    affinity:SQLITE_AFFINITY_TYPE_TEXT]];
+    
+    // Only a BINARY index, which a NOCASE range cannot seek
+    NSString *sql = [self whereClauseOfStipulations:stipulations forTable:@"fruit" ofController:controller];
+    XCTAssertTrue([sql containsString:@"name LIKE ?"], @"%@", sql);
+    XCTAssertEqualObjects([self namesFromTable:@"fruit" withStipulations:stipulations ofController:controller],
+                          ([NSSet setWithObjects:@"apple", @"Apricot", nil]));
+}
+
+- (void)testLikePrefixOnANumericColumnStaysLike {
+    [self executeFixtureSQL:@"CREATE TABLE lot (id INTEGER PRIMARY KEY, code INTEGER, name TEXT);"
+                            @"CREATE INDEX lot_code ON lot (code COLLATE NOCASE);"
+                            @"INSERT INTO lot (code, name) VALUES (123, 'first'), (45, 'second'), (12, 'third');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSArray *stipulations = @[[self stipulationWithAttribute:@"code"
+                                              binaryOperator:SQLite3BinaryOperatorLike
+                                                       value:@"12%"
+                                                    affinity:SQLITE_AFFINITY_TYPE_TEXT]];
+    
+    // LIKE matches the integers by their text; a text range would not
+    NSString *sql = [self whereClauseOfStipulations:stipulations forTable:@"lot" ofController:controller];
+    XCTAssertTrue([sql containsString:@"code LIKE ?"], @"%@", sql);
+    XCTAssertEqualObjects([self namesFromTable:@"lot" withStipulations:stipulations ofController:controller],
+                          ([NSSet setWithObjects:@"first", @"third", nil]));
+}
+
+- (void)testLikeWithInnerWildcardsFallsBackToLike {
+    [self executeFixtureSQL:@"CREATE TABLE fruit (id INTEGER PRIMARY KEY, name TEXT);"
+                            @"CREATE INDEX fruit_name_nocase ON fruit (name COLLATE NOCASE);"
+                            @"INSERT INTO fruit (name) VALUES ('apple'), ('Apricot'), ('banana');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSArray *stipulations = @[[self stipulationWithAttribute:@"name"
+                                              binaryOperator:SQLite3BinaryOperatorLike
+                                                       value:@"%an%"
+                                                    affinity:SQLITE_AFFINITY_TYPE_TEXT]];
+    
+    NSString *sql = [self whereClauseOfStipulations:stipulations forTable:@"fruit" ofController:controller];
+    XCTAssertTrue([sql containsString:@"name LIKE ?"], @"%@", sql);
+    XCTAssertEqualObjects([self namesFromTable:@"fruit" withStipulations:stipulations ofController:controller],
+                          [NSSet setWithObject:@"banana"]);
+}
+
+
+
+#pragma mark - Date Codec
+
+- (void)testDateCodecRoundTripsEveryStorage {
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    
+    id text = [LabQLiteDateCodec storageValueForDate:date storage:LabQLiteDateStorageISO8601Text];
+    XCTAssertEqualObjects(text, @"2023-11-14 22:13:20");
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromStorageValue:text storage:LabQLiteDateStorageISO8601Text], date);
+    
+    id epoch = [LabQLiteDateCodec storageValueForDate:date storage:LabQLiteDateStorageUnixEpoch];
+    XCTAssertEqualObjects(epoch, @1700000000);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromStorageValue:epoch storage:LabQLiteDateStorageUnixEpoch], date);
+    
+    id julianDay = [LabQLiteDateCodec storageValueForDate:date storage:LabQLiteDateStorageJulianDay];
+    XCTAssertEqualWithAccuracy([julianDay doubleValue], 2440587.5 + 1700000000 / 86400.0, 1e-9);
+    XCTAssertEqualWithAccuracy([[LabQLiteDateCodec dateFromStorageValue:julianDay storage:LabQLiteDateStorageJulianDay] timeIntervalSince1970],
+                               1700000000, 1e-3);
+    
+    NSDate *withMilliseconds = [NSDate dateWithTimeIntervalSince1970:1700000000.25];
+    XCTAssertEqualObjects([LabQLiteDateCodec ISO8601StringFromDate:withMilliseconds], @"2023-11-14 22:13:20.250");
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 22:13:20.250"], withMilliseconds);
+}
+
+- (void)testDateCodecParsesOffsetsAndRejectsGarbage {
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14T22:13:20Z"], date);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-15T00:13:20+02:00"], date);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 17:13:20-0500"], date);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14"],
+                          [NSDate dateWithTimeIntervalSince1970:1699920000]);
+    XCTAssertNil([LabQLiteDateCodec dateFromISO8601String:@"14/11/2023"]);
+    XCTAssertNil([LabQLiteDateCodec dateFromStorageValue:[NSNull null] storage:LabQLiteDateStorageUnixEpoch]);
+}
+
+- (void)testDateCodecValidatesCalendarFields {
+    XCTAssertNil([LabQLiteDateCodec dateFromISO8601String:@"2023-02-29"]);
+    XCTAssertNil([LabQLiteDateCodec dateFromISO8601String:@"2023-04-31"]);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2024-02-29"],
+                          [NSDate dateWithTimeIntervalSince1970:1709164800]);
+    
+    // 24:00:00 is midnight of the next day, and the only hour-24 time
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 24:00:00"],
+                          [LabQLiteDateCodec dateFromISO8601String:@"2023-11-15 00:00:00"]);
+    XCTAssertNil([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 24:30:00"]);
+}
+
+- (void)testDateCodecReadsTheFormerDefaultFormat {
+    // yyyy-MM-dd HH:mm:ss ZZZZ, as the default IO date formatter wrote
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 17:13:20 GMT-05:00"], date);
+    XCTAssertEqualObjects([LabQLiteDateCodec dateFromISO8601String:@"2023-11-14 22:13:20 GMT"], date);
+}
+
+- (void)testDatesAreBoundInTheFormSQLiteDateFunctionsRead {
+    [self executeFixtureSQL:@"CREATE TABLE dated (iso TEXT, epoch INTEGER, julian REAL);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    
+    NSError *error;
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO dated VALUES (?, ?, ?)"
+                                  bindableValues:@[date, date, date]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT, SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_REAL]
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    NSArray *rows = [controller processStatement:@"SELECT iso, datetime(epoch, 'unixepoch'), datetime(julian) FROM dated"
+                                  bindableValues:nil
+                                   affinityTypes:nil
+                                     insulatedly:YES
+                                           error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqualObjects([rows firstObject], (@[@"2023-11-14 22:13:20", @"2023-11-14 22:13:20", @"2023-11-14 22:13:20"]));
+}
+
+
+
+#pragma mark - Binding
+
+- (void)testValuesAreBoundByTheirClass {
+    [self executeFixtureSQL:@"CREATE TABLE bound_value (v INTEGER);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    
+    NSError *error;
+    NSArray *rows = [controller processStatement:@"SELECT typeof(?), typeof(?), typeof(?), typeof(?), typeof(?), typeof(?), typeof(?), length(?), typeof(?)"
+                                  bindableValues:@[@42,
+                                                   @1.5,
+                                                   [NSData dataWithBytes:"\x00\x01" length:2],
+                                                   @"7",
+                                                   date,
+                                                   date,
+                                                   date,
+                                                   [LabQLiteZeroBlob zeroBlobWithLength:16],
+                                                   [NSNull null]]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_NONE,
+                                                   SQLITE_AFFINITY_TYPE_NONE,
+                                                   SQLITE_AFFINITY_TYPE_NONE,
+                                                   SQLITE_AFFINITY_TYPE_INTEGER,
+                                                   SQLITE_AFFINITY_TYPE_TEXT,
+                                                   SQLITE_AFFINITY_TYPE_INTEGER,
+                                                   SQLITE_AFFINITY_TYPE_REAL,
+                                                   SQLITE_AFFINITY_TYPE_NONE,
+                                                   SQLITE_AFFINITY_TYPE_NONE]
+                                     insulatedly:YES
+                                           error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqualObjects([rows firstObject], (@[@"integer", @"real", @"blob", @"integer", @"text", @"integer", @"real", @"16", @"null"]));
+}
+
+- (void)testIntegersKeepAllSixtyFourBits {
+    [self executeFixtureSQL:@"CREATE TABLE bound_value (v INTEGER);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    long long beyondDoublePrecision = 9007199254740993LL;
+    
+    NSError *error;
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO bound_value (v) VALUES (?), (?)"
+                                  bindableValues:@[@(LLONG_MAX), [NSString stringWithFormat:@"%lld", beyondDoublePrecision]]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER]
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    
+    NSArray *rows = [controller rowsFromTable:@"bound_value"
+                         withSpecifiedColumns:@[@"v"]
+                                 stipulations:nil
+                                       offset:0
+                   andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                    orderedBy:@"rowid"
+                                        error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual([[[rows firstObject] firstObject] longLongValue], LLONG_MAX);
+    XCTAssertEqual([[[rows lastObject] firstObject] longLongValue], beyondDoublePrecision);
+    
+    // Stipulation values are bound as integers, not text
+    rows = [controller rowsFromTable:@"bound_value"
+                withSpecifiedColumns:@[@"v"]
+                        stipulations:@[[self stipulationWithAttribute:@"v"
+                                                       binaryOperator:SQLite3BinaryOperatorEquals
+                                                                value:@(beyondDoublePrecision)
+                                                             affinity:SQLITE_AFFINITY_TYPE_INTEGER]]
+                              offset:0
+          andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                           orderedBy:nil
+                               error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqual([rows count], (NSUInteger)1);
+}
+
+- (void)testOnlyNumericStringsAreCoercedForNumericColumns {
+    [self executeFixtureSQL:@"CREATE TABLE bound_value (v INTEGER);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    
+    NSError *error;
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO bound_value (v) VALUES (?), (?), (?)"
+                                  bindableValues:@[@"abc", @"1.5", @"42"]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER]
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    NSArray *rows = [controller processStatement:@"SELECT typeof(v) || ':' || v FROM bound_value ORDER BY rowid"
+                                  bindableValues:nil
+                                   affinityTypes:nil
+                                     insulatedly:YES
+                                           error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqualObjects([self firstColumnOfRows:rows], (@[@"text:abc", @"real:1.5", @"integer:42"]));
+}
+
+- (void)testTextIsBoundWithEmbeddedNuls {
+    [self executeFixtureSQL:@"CREATE TABLE bound_value (v TEXT);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSString *text = [NSString stringWithFormat:@"a%Cb", (unichar)0];
+    
+    NSError *error;
+    NSArray *rows = [controller processStatement:@"SELECT length(CAST(? AS BLOB))"
+                                  bindableValues:@[text]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT]
+                                     insulatedly:YES
+                                           error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqualObjects([[rows firstObject] firstObject], @"3");
+}
+
+- (void)testTooFewBindableValuesAreReportedNotThrown {
+    [self executeFixtureSQL:@"CREATE TABLE bound_value (v INTEGER);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    
+    NSError *error;
+    XCTAssertNoThrow(XCTAssertNil([controller processStatement:@"INSERT INTO bound_value (v) VALUES (?), (?)"
+                                                bindableValues:@[@1]
+                                                 affinityTypes:@[SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER]
+                                                   insulatedly:YES
+                                                         error:&error]));
+    XCTAssertEqual([error code], (NSInteger)LabQLiteErrorBindableValuesCountDidNotMatchColumnAffinityTypesCount);
+}
+
+
+
+#pragma mark - Full-Text Search
+
+- (void)testFullTextIndexAnswersMatchQueries {
+    [self executeFixtureSQL:@"CREATE TABLE behavior_note (note_id INTEGER PRIMARY KEY, body TEXT);"
+                            @"INSERT INTO behavior_note VALUES (1, 'climbing rose'), (2, 'rose rose rose garden'), (3, 'tulip bulbs');"];
+    NSError *error;
+    LabQLiteDatabaseController *controller = [[LabQLiteDatabaseController alloc] initWithDatabasePath:self.databasePath
+                                                                                                error:&error];
+    if (![LabQLiteFullTextIndexDefinition isModuleAvailable:LabQLiteFullTextModuleFTS5]) {
+        XCTAssertNil(controller);
+        XCTAssertEqual([error code], (NSInteger)LabQLiteErrorFullTextModuleUnavailable);
+        return;
+    }
+    XCTAssertNotNil(controller, @"%@", error);
+    
+    NSArray *notes = [controller rowsFromTable:@"behavior_note"
+                     asSQLite3RowsWithSubclass:[LabQLiteBehaviorNoteRow class]
+                         matchingFullTextQuery:@"rose"
+                       maxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                         error:&error];
+    XCTAssertNotNil(notes, @"%@", error);
+    XCTAssertEqualObjects([NSSet setWithArray:[notes valueForKey:@"noteID"]], ([NSSet setWithObjects:@1, @2, nil]));
+    
+    // Rows inserted later reach the index through its triggers
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO behavior_note VALUES (4, 'tulip mix')"
+                                  bindableValues:nil
+                                   affinityTypes:nil
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    NSArray *rows = [controller rowsFromTable:@"behavior_note"
+                         withSpecifiedColumns:@[@"note_id"]
+                                 stipulations:@[[self stipulationWithAttribute:@"behavior_note"
+                                                                binaryOperator:SQLite3BinaryOperatorMatch
+                                                                         value:@"tulip"
+                                                                      affinity:SQLITE_AFFINITY_TYPE_TEXT]]
+                                       offset:0
+                   andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                    orderedBy:@"note_id"
+                                        error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    XCTAssertEqualObjects([self firstColumnOfRows:rows], (@[@3, @4]));
+}
+
+
+
+#pragma mark - Sharding
+
+- (void)testShardedControllerNeedsAtLeastOnePath {
+    NSError *error;
+    XCTAssertNil([[LabQLiteShardedDatabaseController alloc] initWithDatabasePaths:@[] error:&error]);
+    XCTAssertEqual([error code], (NSInteger)LabQLiteErrorNoShards);
+}
+
+- (void)testShardedTablesRouteEqualKeysTogetherAndMergeCounts {
+    NSMutableArray *shardPaths = [NSMutableArray new];
+    for (int i = 0; i < 3; i++) {
+        NSString *shardPath = [self scratchPathForFileNamed:[NSString stringWithFormat:@"shard-%d.sqlite3", i]];
+        [self executeFixtureSQL:@"CREATE TABLE behavior_plant (plant_id INTEGER PRIMARY KEY, name TEXT);"
+               inDatabaseAtPath:shardPath];
+        [shardPaths addObject:shardPath];
+    }
+    NSError *error;
+    LabQLiteShardedDatabaseController *controller = [[LabQLiteShardedDatabaseController alloc] initWithDatabasePaths:shardPaths
+                                                                                                              error:&error];
+    XCTAssertNotNil(controller, @"%@", error);
+    [controller partitionTable:@"behavior_plant" byKeyColumn:@"plant_id"];
+    [controller placeTable:@"behavior_log" onShardAtIndex:2];
+    XCTAssertEqual([controller shardIndexForTable:@"behavior_plant" keyValue:@3],
+                   [controller shardIndexForTable:@"behavior_plant" keyValue:@"3"]);
+    XCTAssertEqual([controller shardIndexForTable:@"behavior_log" keyValue:@3], (NSUInteger)2);
+    
+    NSUInteger rowCount = 30;
+    NSMutableArray *plants = [NSMutableArray new];
+    for (NSUInteger i = 1; i <= rowCount; i++) {
+        LabQLiteBehaviorPlantRow *plant = [LabQLiteBehaviorPlantRow new];
+        plant.plantID = @(i);
+        plant.name = [NSString stringWithFormat:@"plant-%lu", (unsigned long)i];
+        [plants addObject:plant];
+    }
+    XCTAssertTrue([controller insertRows:plants intoTable:@"behavior_plant" error:&error], @"%@", error);
+    XCTAssertEqual([controller numberOfRowsInTable:@"behavior_plant" error:&error], rowCount);
+    XCTAssertEqual([[controller allRows:@"behavior_plant" SQLite3RowSubclass:[LabQLiteBehaviorPlantRow class] error:&error] count], rowCount);
+    
+    // Every row sits on the shard its key hashes to
+    NSUInteger shardsHoldingRows = 0;
+    for (NSUInteger shardIndex = 0; shardIndex < [controller.shards count]; shardIndex++) {
+        NSArray *rows = [[controller.shards objectAtIndex:shardIndex] rowsFromTable:@"behavior_plant"
+                                                               withSpecifiedColumns:@[@"plant_id"]
+                                                                       stipulations:nil
+                                                                             offset:0
+                                                         andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                                                          orderedBy:nil
+                                                                              error:&error];
+        XCTAssertNotNil(rows, @"%@", error);
+        for (NSArray *row in rows) {
+            XCTAssertEqual([controller shardIndexForTable:@"behavior_plant" keyValue:[row firstObject]], shardIndex);
+        }
+        shardsHoldingRows += [rows count] > 0 ? 1 : 0;
+    }
+    XCTAssertGreaterThan(shardsHoldingRows, (NSUInteger)1);
+}
+
+
+
+#pragma mark - Backups
+
+- (void)testBackupCopiesEveryRowWithoutTheMainQueue {
+    [self executeFixtureSQL:@"CREATE TABLE backed_up (id INTEGER PRIMARY KEY, name TEXT);"
+                            @"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 5000) "
+                            @"INSERT INTO backed_up (id, name) SELECT i, 'row-' || i FROM n;"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSString *backupPath = [self scratchPathForFileNamed:@"backup.sqlite3"];
+    
+    __block NSUInteger lastPagesCopied = 0;
+    __block NSUInteger lastPageCount = 0;
+    __block BOOL backedUp = NO;
+    __block NSError *backupError;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [controller backupToPath:backupPath
+                pagesPerStep:4
+               callbackQueue:nil
+                    progress:^(NSUInteger pagesCopied, NSUInteger pageCount, double bytesPerSecond) {
+                        lastPagesCopied = pagesCopied;
+                        lastPageCount = pageCount;
+                    }
+                  completion:^(BOOL success, NSError *error) {
+                      backedUp = success;
+                      backupError = error;
+                      dispatch_semaphore_signal(finished);
+                  }];
+    
+    // With no callback queue the main thread can simply block
+    XCTAssertEqual(dispatch_semaphore_wait(finished, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0L);
+    XCTAssertTrue(backedUp, @"%@", backupError);
+    XCTAssertGreaterThan(lastPageCount, (NSUInteger)0);
+    XCTAssertEqual(lastPagesCopied, lastPageCount);
+    
+    NSError *error;
+    LabQLiteDatabaseController *backup = [[LabQLiteDatabaseController alloc] initWithDatabasePath:backupPath
+                                                                                            error:&error];
+    XCTAssertNotNil(backup, @"%@", error);
+    XCTAssertEqual([backup numberOfRowsInTable:@"backed_up" error:&error], (NSUInteger)5000);
+}
+
+
+
+#pragma mark - In-Memory Write-Through
+
+- (LabQLiteDatabaseController *)inMemoryControllerWithWriteThrough:(LabQLiteWriteThrough)writeThrough {
+    LabQLiteDatabaseController *controller = [self controller];
+    NSError *error;
+    LabQLiteDatabase *database = [[LabQLiteDatabase alloc] initWithPath:self.databasePath
+                                                               openMode:LabQLiteDatabaseOpenModeInMemory
+                                                                  error:&error];
+    XCTAssertNotNil(database, @"%@", error);
+    database.writeThrough = writeThrough;
+    [controller setDatabase:database];
+    return controller;
+}
+
+- (void)testSynchronousWriteThroughReachesTheFileBeforeReturning {
+    [self executeFixtureSQL:@"CREATE TABLE journal (id INTEGER PRIMARY KEY, entry TEXT);"];
+    LabQLiteDatabaseController *controller = [self inMemoryControllerWithWriteThrough:LabQLiteWriteThroughSynchronous];
+    
+    NSError *error;
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO journal (entry) VALUES ('planted')"
+                                  bindableValues:nil
+                                   affinityTypes:nil
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    XCTAssertEqual([self fixtureCountOfRowsInTable:@"journal" inDatabaseAtPath:self.databasePath], 1LL);
+}
+
+- (void)testBackupIncludesWritesAwaitingDeferredWriteThrough {
+    [self executeFixtureSQL:@"CREATE TABLE journal (id INTEGER PRIMARY KEY, entry TEXT);"];
+    LabQLiteDatabaseController *controller = [self inMemoryControllerWithWriteThrough:LabQLiteWriteThroughDeferred];
+    NSString *backupPath = [self scratchPathForFileNamed:@"backup.sqlite3"];
+    
+    NSError *error;
+    XCTAssertNotNil([controller processStatement:@"INSERT INTO journal (entry) VALUES ('planted')"
+                                  bindableValues:nil
+                                   affinityTypes:nil
+                                     insulatedly:YES
+                                           error:&error], @"%@", error);
+    
+    __block BOOL backedUp = NO;
+    __block NSError *backupError;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [controller backupToPath:backupPath
+                pagesPerStep:0
+               callbackQueue:nil
+                    progress:nil
+                  completion:^(BOOL success, NSError *error) {
+                      backedUp = success;
+                      backupError = error;
+                      dispatch_semaphore_signal(finished);
+                  }];
+    XCTAssertEqual(dispatch_semaphore_wait(finished, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0L);
+    XCTAssertTrue(backedUp, @"%@", backupError);
+    XCTAssertEqual([self fixtureCountOfRowsInTable:@"journal" inDatabaseAtPath:backupPath], 1LL);
+}
+
+
+
+
+#pragma mark - Faults
+
+- (void)testFailedFaultLoadIsRetriedOnTheNextAccess {
+    [self executeFixtureSQL:@"CREATE TABLE photo (id INTEGER PRIMARY KEY, image BLOB);"
+                            @"INSERT INTO photo (id, image) VALUES (1, x'0102'), (2, x'0304');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    LabQLiteFaultBatch *batch = [[LabQLiteFaultBatch alloc] initWithController:controller
+                                                                     tableName:@"photo"
+                                                                    columnName:@"image"];
+    LabQLiteFault *fault = [batch faultForRowID:@1];
+    
+    [self executeFixtureSQL:@"ALTER TABLE photo RENAME TO photo_away;"];
+    XCTAssertEqualObjects([fault resolvedValue], [NSNull null]);
+    XCTAssertNotNil(batch.lastError);
+    XCTAssertTrue([fault isFault]);
+    
+    [self executeFixtureSQL:@"ALTER TABLE photo_away RENAME TO photo;"];
+    const unsigned char bytes[] = {0x01, 0x02};
+    XCTAssertEqualObjects([fault resolvedValue], [NSData dataWithBytes:bytes length:sizeof(bytes)]);
+    XCTAssertFalse([fault isFault]);
+}
+
+
+
+
+#pragma mark - Statement Statistics
+
+- (void)testStatementTimingsAreGroupedByFingerprintUntilReset {
+    [self executeFixtureSQL:@"CREATE TABLE fruit (id INTEGER PRIMARY KEY, name TEXT);"
+                            @"INSERT INTO fruit (name) VALUES ('apple'), ('banana');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    controller.database.statementTimingEnabled = YES;
+    
+    NSError *error;
+    for (int i = 0; i < 4; i++) {
+        NSString *q = [NSString stringWithFormat:@"SELECT name FROM fruit WHERE id = %d", i % 2 + 1];
+        XCTAssertNotNil([controller processStatement:q
+                                      bindableValues:nil
+                                       affinityTypes:nil
+                                         insulatedly:YES
+                                               error:&error], @"%@", error);
+    }
+    
+    // Both literal values share one fingerprint
+    NSString *fingerprint = [LabQLiteDatabase fingerprintForStatement:@"SELECT name FROM fruit WHERE id = 1"];
+    NSDictionary *statistics = [[controller.database statisticsSnapshot] objectForKey:fingerprint];
+    XCTAssertEqualObjects([statistics objectForKey:LabQLiteStatementStatisticsCountKey], @4);
+    XCTAssertGreaterThan([[statistics objectForKey:LabQLiteStatementStatisticsMaxKey] doubleValue], 0.0);
+    
+    [controller.database resetStatistics];
+    XCTAssertEqual([[controller.database statisticsSnapshot] count], (NSUInteger)0);
+}
+
+
+
+
+#pragma mark - Lazy Schema Validation
+
+- (void)testOnlyTheFileHeaderIsCheckedBeforeTheFirstOpen {
+    NSError *error;
+    [@"not a database" writeToFile:self.databasePath atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+    XCTAssertNil([[LabQLiteDatabase alloc] initWithPath:self.databasePath
+                                               openMode:LabQLiteDatabaseOpenModeReadWrite
+                                                  error:&error]);
+    XCTAssertEqual([error code], (NSInteger)LabQLiteErrorDatabasePathPointsToNonDatabase);
+    
+    // A valid header over a garbage page passes until the schema is read
+    NSMutableData *contents = [NSMutableData dataWithBytes:"SQLite format 3" length:16];
+    [contents setLength:1024];
+    memset((char *)[contents mutableBytes] + 16, 0xFF, 1024 - 16);
+    [contents writeToFile:self.databasePath atomically:YES];
+    error = nil;
+    LabQLiteDatabase *database = [[LabQLiteDatabase alloc] initWithPath:self.databasePath
+                                                               openMode:LabQLiteDatabaseOpenModeReadWrite
+                                                                  error:&error];
+    XCTAssertNotNil(database, @"%@", error);
+    
+    for (int attempt = 0; attempt < 2; attempt++) {
+        error = nil;
+        XCTAssertFalse([database openDatabase:&error]);
+        XCTAssertEqual([error code], (NSInteger)LabQLiteErrorDatabasePathPointsToNonDatabase);
+    }
+    XCTAssertTrue([database closeDatabase:&error], @"%@", error);
+}
+
+
+
+
+#pragma mark - BLOB Handles
+
+- (void)testBlobHandleStreamsIntoAZeroBlobAndRefusesWorkOnceClosed {
+    [self executeFixtureSQL:@"CREATE TABLE photo (id INTEGER PRIMARY KEY, image BLOB);"];
+    NSError *error;
+    LabQLiteDatabase *database = [[LabQLiteDatabase alloc] initWithPath:self.databasePath
+                                                               openMode:LabQLiteDatabaseOpenModeReadWrite
+                                                                  error:&error];
+    XCTAssertNotNil(database, @"%@", error);
+    XCTAssertTrue([database openDatabase:&error], @"%@", error);
+    XCTAssertNotNil([database processStatement:@"INSERT INTO photo (id, image) VALUES (1, ?), (2, ?)"
+                                bindableValues:@[[LabQLiteZeroBlob zeroBlobWithLength:8], [LabQLiteZeroBlob zeroBlobWithLength:4]]
+                                 affinityTypes:@[SQLITE_AFFINITY_TYPE_NONE, SQLITE_AFFINITY_TYPE_NONE]
+                                  openDatabase:NO
+                                 closeDatabase:NO
+                                         error:&error], @"%@", error);
+    
+    LabQLiteBlobHandle *handle = [LabQLiteBlobHandle blobHandleWithDatabase:database
+                                                                      table:@"photo"
+                                                                     column:@"image"
+                                                                      rowID:1
+                                                                   writable:YES
+                                                                      error:&error];
+    XCTAssertNotNil(handle, @"%@", error);
+    XCTAssertEqual(handle.length, (NSUInteger)8);
+    XCTAssertTrue([handle writeBytes:"abcdefgh" length:8 atOffset:0 error:&error], @"%@", error);
+    
+    NSMutableData *chunks = [NSMutableData new];
+    XCTAssertTrue([handle enumerateChunksOfLength:3 error:&error usingBlock:^(const void *bytes, NSUInteger length, NSUInteger offset, BOOL *stop) {
+        XCTAssertEqual(offset, [chunks length]);
+        [chunks appendBytes:bytes length:length];
+    }], @"%@", error);
+    XCTAssertEqualObjects(chunks, [NSData dataWithBytes:"abcdefgh" length:8]);
+    
+    XCTAssertTrue([handle reopenWithRowID:2 error:&error], @"%@", error);
+    XCTAssertEqual(handle.length, (NSUInteger)4);
+    XCTAssertTrue([handle close:&error], @"%@", error);
+    
+    error = nil;
+    XCTAssertFalse([handle writeBytes:"abcd" length:4 atOffset:0 error:&error]);
+    XCTAssertEqual([error code], (NSInteger)SQLITE_MISUSE);
+    error = nil;
+    XCTAssertFalse([handle reopenWithRowID:1 error:&error]);
+    XCTAssertEqual([error code], (NSInteger)SQLITE_MISUSE);
+    XCTAssertTrue([database closeDatabase:&error], @"%@", error);
+}
+
+
+
+
+#pragma mark - Query Plan Diagnostics
+
+- (void)testQueryPlanAdvisorSuggestsAnIndexForAScanOncePerShape {
+    [self executeFixtureSQL:@"CREATE TABLE fruit (id INTEGER PRIMARY KEY, name TEXT, color TEXT);"
+                            @"INSERT INTO fruit (name, color) VALUES ('apple', 'red'), ('banana', 'yellow'), ('cherry', 'red');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    controller.database.queryPlanDiagnosticsEnabled = YES;
+    
+    NSError *error;
+    for (NSString *color in @[@"red", @"yellow"]) {
+        NSArray *rows = [controller rowsFromTable:@"fruit"
+                             withSpecifiedColumns:@[@"name"]
+                                     stipulations:@[[self stipulationWithAttribute:@"color"
+                                                                    binaryOperator:SQLite3BinaryOperatorEquals
+                                                                             value:color
+                                                                          affinity:SQLITE_AFFINITY_TYPE_TEXT]]
+                                           offset:0
+                       andMaxNumberOfRowsToReturn:LABQLITE_WRAPPER_SELECT_LIMIT_NONE
+                                        orderedBy:@"name"
+                                            error:&error];
+        XCTAssertNotNil(rows, @"%@", error);
+    }
+    
+    NSArray *plans = [controller.database queryPlanDiagnostics];
+    XCTAssertEqual([plans count], (NSUInteger)1);
+    XCTAssertEqualObjects([[plans firstObject] objectForKey:LabQLiteQueryPlanUsesFullTableScanKey], @YES);
+    XCTAssertEqualObjects([[plans firstObject] objectForKey:LabQLiteQueryPlanSuggestedIndexColumnsKey], (@[@"color", @"name"]));
+    XCTAssertEqualObjects([controller.database suggestedIndexStatements],
+                          @[@"CREATE INDEX IF NOT EXISTS idx_fruit_color_name ON fruit (color, name)"]);
+    
+    [controller.database resetQueryPlanDiagnostics];
+    XCTAssertEqual([[controller.database queryPlanDiagnostics] count], (NSUInteger)0);
+}
+
+
+
+
+#pragma mark - Declared Indexes
+
+- (NSArray *)indexNamesOfTable:(NSString *)tableName
+                  ofController:(LabQLiteDatabaseController *)controller {
+    NSError *error;
+    NSArray *rows = [controller processStatement:@"SELECT name FROM sqlite_master WHERE type = 'index' AND tbl_name = ? ORDER BY name"
+                                  bindableValues:@[tableName]
+                                   affinityTypes:@[SQLITE_AFFINITY_TYPE_TEXT]
+                                     insulatedly:YES
+                                           error:&error];
+    XCTAssertNotNil(rows, @"%@", error);
+    return [self firstColumnOfRows:rows];
+}
+
+- (void)testDeclaredIndexesAreCreatedOnceOnActivation {
+    [self executeFixtureSQL:@"CREATE TABLE behavior_bed (bed_id INTEGER PRIMARY KEY, garden TEXT, bed_number INTEGER);"
+                            @"INSERT INTO behavior_bed (garden, bed_number) VALUES ('North', 1), ('South', 1);"];
+    LabQLiteDatabaseController *controller = [self controller];
+    NSArray *expectedIndexNames = @[@"idx_behavior_bed_garden_nocase", @"uidx_behavior_bed_garden_bed_number"];
+    XCTAssertEqualObjects([self indexNamesOfTable:@"behavior_bed" ofController:controller], expectedIndexNames);
+    
+    // The unique index is enforced
+    NSError *error;
+    XCTAssertNil([controller processStatement:@"INSERT INTO behavior_bed (garden, bed_number) VALUES ('North', 1)"
+                               bindableValues:nil
+                                affinityTypes:nil
+                                  insulatedly:YES
+                                        error:&error]);
+    XCTAssertNotNil(error);
+    
+    // Activating again finds them and creates nothing
+    LabQLiteDatabaseController *secondController = [self controller];
+    XCTAssertEqualObjects([self indexNamesOfTable:@"behavior_bed" ofController:secondController], expectedIndexNames);
+}
+
+
+
+
+#pragma mark - Metrics
+
+- (void)testMetricsCountTheWorkOfARead {
+    [self executeFixtureSQL:@"CREATE TABLE behavior_plant (plant_id INTEGER PRIMARY KEY, name TEXT);"
+                            @"INSERT INTO behavior_plant VALUES (1, 'rose'), (2, 'tulip'), (3, 'fern');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    [LabQLiteMetrics reset];
+    
+    NSError *error;
+    NSArray *plants = [controller allRows:@"behavior_plant"
+                       SQLite3RowSubclass:[LabQLiteBehaviorPlantRow class]
+                                    error:&error];
+    XCTAssertEqual([plants count], (NSUInteger)3, @"%@", error);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricRowsStepped], (uint64_t)3);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricIntegerCellsDecoded], (uint64_t)3);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricTextCellsDecoded], (uint64_t)3);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricTextBytesMaterialized], (uint64_t)strlen("rosetulipfern"));
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricObjectsMapped], (uint64_t)3);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricConnectionOpens],
+                   [LabQLiteMetrics valueForMetric:LabQLiteMetricConnectionCloses]);
+    
+    NSString *metricsPath = [self scratchPathForFileNamed:@"labqlite.prom"];
+    XCTAssertTrue([LabQLiteMetrics writePrometheusTextToPath:metricsPath error:&error], @"%@", error);
+    NSString *text = [NSString stringWithContentsOfFile:metricsPath encoding:NSUTF8StringEncoding error:NULL];
+    XCTAssertTrue([text containsString:@"# TYPE labqlite_rows_stepped_total counter\nlabqlite_rows_stepped_total 3\n"], @"%@", text);
+    
+    [LabQLiteMetrics reset];
+    XCTAssertEqualObjects([[LabQLiteMetrics snapshot] objectForKey:@"labqlite_rows_stepped_total"], @0);
+}
+
+
+
+
+#pragma mark - Borrowed Enumeration
+
+- (void)testBorrowedEnumerationMaterializesOnlyWhatIsCopied {
+    [self executeFixtureSQL:@"CREATE TABLE behavior_seed (seed_id INTEGER PRIMARY KEY, name TEXT, packet BLOB);"
+                            @"INSERT INTO behavior_seed VALUES (1, 'basil', X'0102'), (2, 'chive', X'030405'), (3, 'dill', X'06');"];
+    LabQLiteDatabaseController *controller = [self controller];
+    [LabQLiteMetrics reset];
+    
+    NSMutableArray *copiedNames = [NSMutableArray array];
+    NSMutableArray *copiedPackets = [NSMutableArray array];
+    NSError *error;
+    BOOL enumerated = [controller enumerateRowsOfStatement:@"SELECT seed_id, name, packet FROM behavior_seed ORDER BY seed_id;"
+                                            bindableValues:nil
+                                             affinityTypes:nil
+                                                   options:LabQLiteRowEnumerationBorrowColumnBuffers
+                                               insulatedly:YES
+                                                     error:&error
+                                                usingBlock:^(NSArray *row, BOOL *stop) {
+                                                    XCTAssertEqualObjects(row[0], @([copiedNames count] + 1));
+                                                    [copiedNames addObject:[row[1] copy]];
+                                                    [copiedPackets addObject:[row[2] copy]];
+                                                    *stop = [copiedNames count] == 2;
+                                                }];
+    XCTAssertTrue(enumerated, @"%@", error);
+    XCTAssertEqualObjects(copiedNames, (@[@"basil", @"chive"]));
+    const uint8_t chivePacket[] = {3, 4, 5};
+    XCTAssertEqualObjects(copiedPackets[1], [NSData dataWithBytes:chivePacket length:sizeof(chivePacket)]);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricRowsStepped], (uint64_t)2);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricTextCellsDecoded], (uint64_t)2);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricTextBytesMaterialized], (uint64_t)0);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricBlobBytesMaterialized], (uint64_t)0);
+    
+    // Without borrowing, every cell is copied as it is decoded.
+    [LabQLiteMetrics reset];
+    enumerated = [controller enumerateRowsOfStatement:@"SELECT name, packet FROM behavior_seed;"
+                                       bindableValues:nil
+                                        affinityTypes:nil
+                                              options:LabQLiteRowEnumerationOptionsNone
+                                          insulatedly:YES
+                                                error:&error
+                                           usingBlock:^(NSArray *row, BOOL *stop) {}];
+    XCTAssertTrue(enumerated, @"%@", error);
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricTextBytesMaterialized], (uint64_t)strlen("basilchivedill"));
+    XCTAssertEqual([LabQLiteMetrics valueForMetric:LabQLiteMetricBlobBytesMaterialized], (uint64_t)6);
+}
+
+
+
+
+#pragma mark - Read-Only Controllers
+
+- (void)testReadOnlyControllerReadsButRefusesWrites {
+    [self executeFixtureSQL:@"CREATE TABLE behavior_plant (plant_id INTEGER PRIMARY KEY, name TEXT);"
+                            @"INSERT INTO behavior_plant VALUES (1, 'rose'), (2, 'tulip');"];
+    NSError *error;
+    LabQLiteDatabaseController *controller = [[LabQLiteDatabaseController alloc] initWithReadOnlyDatabasePath:self.databasePath
+                                                                                                    immutable:NO
+                                                                                                        error:&error];
+    XCTAssertNotNil(controller, @"%@", error);
+    NSArray *plants = [controller allRows:@"behavior_plant"
+                       SQLite3RowSubclass:[LabQLiteBehaviorPlantRow class]
+                                    error:&error];
+    XCTAssertEqual([plants count], (NSUInteger)2, @"%@", error);
+    
+    LabQLiteBehaviorPlantRow *plant = [LabQLiteBehaviorPlantRow new];
+    plant.plantID = @3;
+    plant.name = @"fern";
+    error = nil;
+    XCTAssertFalse([controller insertRow:plant error:&error]);
+    XCTAssertEqualObjects([error domain], LabQLiteErrorDomain);
+    XCTAssertEqual([error code], (NSInteger)LabQLiteErrorDatabaseReadOnly);
+    
+    error = nil;
+    XCTAssertNil([controller processStatement:@"DELETE FROM behavior_plant;"
+                               bindableValues:nil
+                                affinityTypes:nil
+                                  insulatedly:YES
+                                        error:&error]);
+    XCTAssertEqual([error code], (NSInteger)LabQLiteErrorDatabaseReadOnly);
+    XCTAssertEqual([self fixtureCountOfRowsInTable:@"behavior_plant" inDatabaseAtPath:self.databasePath], 2);
+    
+    // A refused write leaves the connection usable for reads
+    error = nil;
+    XCTAssertEqual([controller numberOfRowsInTable:@"behavior_plant" error:&error], (NSUInteger)2, @"%@", error);
+}
+
+
+
+
+#pragma mark - Seed Copies
+
+- (void)testSeedIsCopiedOnceAndSwitchedToForWrites {
+    NSString *seedPath = [self scratchPathForFileNamed:@"seed.sqlite3"];
+    NSString *copyPath = [self scratchPathForFileNamed:@"copies/garden.sqlite3"];
+    [self executeFixtureSQL:@"CREATE TABLE behavior_plant (plant_id INTEGER PRIMARY KEY, name TEXT);"
+                            @"INSERT INTO behavior_plant VALUES (1, 'rose'), (2, 'tulip');"
+                   inDatabaseAtPath:seedPath];
+    XCTAssertFalse([LabQLiteSeedCopier isCopyAtPath:copyPath currentWithSeedAtPath:seedPath]);
+    
+    NSError *error;
+    XCTestExpectation *switched = [self expectationWithDescription:@"switched to the writable copy"];
+    __block NSError *copyError;
+    LabQLiteDatabaseController *controller = [[LabQLiteDatabaseController alloc] initWithSeedDatabaseAtPath:seedPath
+                                                                                           writableCopyPath:copyPath
+                                                                                                 completion:^(BOOL success, NSError *completionError) {
+                                                                                                     XCTAssertTrue(success);
+                                                                                                     copyError = completionError;
+                                                                                                     [switched fulfill];
+                                                                                                 }
+                                                                                                      error:&error];
+    XCTAssertNotNil(controller, @"%@", error);
+    
+    // The seed answers reads while the copy is made
+    XCTAssertEqual([controller numberOfRowsInTable:@"behavior_plant" error:&error], (NSUInteger)2, @"%@", error);
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+    XCTAssertNil(copyError);
+    XCTAssertTrue([LabQLiteSeedCopier isCopyAtPath:copyPath currentWithSeedAtPath:seedPath]);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[LabQLiteSeedCopier sidecarPathForCopyAtPath:copyPath]]);
+    
+    LabQLiteBehaviorPlantRow *plant = [LabQLiteBehaviorPlantRow new];
+    plant.plantID = @3;
+    plant.name = @"fern";
+    XCTAssertTrue([controller insertRow:plant error:&error], @"%@", error);
+    XCTAssertEqual([self fixtureCountOfRowsInTable:@"behavior_plant" inDatabaseAtPath:copyPath], 3);
+    XCTAssertEqual([self fixtureCountOfRowsInTable:@"behavior_plant" inDatabaseAtPath:seedPath], 2);
+    
+    // A current copy is used straight away and not copied over
+    XCTestExpectation *reused = [self expectationWithDescription:@"reused the current copy"];
+    LabQLiteDatabaseController *relaunched = [[LabQLiteDatabaseController alloc] initWithSeedDatabaseAtPath:seedPath
+                                                                                           writableCopyPath:copyPath
+                                                                                                 completion:^(BOOL success, NSError *completionError) {
+                                                                                                     XCTAssertTrue(success, @"%@", completionError);
+                                                                                                     [reused fulfill];
+                                                                                                 }
+                                                                                                      error:&error];
+    XCTAssertNotNil(relaunched, @"%@", error);
+    XCTAssertEqual([relaunched numberOfRowsInTable:@"behavior_plant" error:&error], (NSUInteger)3, @"%@", error);
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+    
+    // Any change to the seed makes the copy stale
+    NSString *stamp = [LabQLiteSeedCopier stampForDatabaseAtPath:seedPath error:&error];
+    XCTAssertNotNil(stamp, @"%@", error);
+    [self executeFixtureSQL:@"PRAGMA user_version = 2;" inDatabaseAtPath:seedPath];
+    XCTAssertNotEqualObjects([LabQLiteSeedCopier stampForDatabaseAtPath:seedPath error:&error], stamp);
+    XCTAssertFalse([LabQLiteSeedCopier isCopyAtPath:copyPath currentWithSeedAtPath:seedPath]);
+}
+
+
+@end
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ This is free and unencumbered software released into the public domain.
+ 
+ Anyone is free to copy, modify, publish, use, compile, sell, or
+ distribute this software, either in source code form or as a compiled
+ binary, for any purpose, commercial or non-commercial, and by any
+ means.
+ 
+ In jurisdictions that recognize copyright laws, the author or authors
+ of this software dedicate any and all copyright interest in the
+ software to the public domain. We make this dedication for the benefit
+ of the public at large and to the detriment of our heirs and
+ successors. We intend this dedication to be an overt act of
+ relinquishment in perpetuity of all present and future rights to this
+ software under copyright law.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ OTHER DEALINGS IN THE SOFTWARE.
+ 
+ For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "LabQLiteDatabaseController.h"
+#import "LabQLiteRow.h"
+
+
+
+#pragma mark - Benchmark Result Keys
+
+/**
+ @abstract Keys of the dictionaries returned by
+ -[LabQLiteBenchmarks runAllLayers:].
+ */
+FOUNDATION_EXPORT NSString *const LabQLiteBenchmarkLayerKey;
+FOUNDATION_EXPORT NSString *const LabQLiteBenchmarkRowCountKey;
+FOUNDATION_EXPORT NSString *const LabQLiteBenchmarkOperationsKey;
+FOUNDATION_EXPORT NSString *const LabQLiteBenchmarkSecondsKey;
+FOUNDATION_EXPORT NSString *const LabQLiteBenchmarkNanosecondsPerOperationKey;
+
+
+
+#pragma mark - Benchmark Row
+
+/**
+ @abstract Row of the generated `benchmark_row` table. Mirrors
+ the column types the garden demo uses (INTEGER, TEXT, REAL
+ and DATE).
+ */
+@interface LabQLiteBenchmarkRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *benchmarkRowID;
+@property (nonatomic) NSString *name;
+@property (nonatomic) NSNumber *weight;
+@property (nonatomic) NSString *planted;
+@property (nonatomic) NSString *notes;
+
+@end
+
+
+
+#pragma mark - LabQLiteBenchmarks Class
+
+/**
+ @abstract Microbenchmarks for each layer of the LabQLite stack,
+ run in isolation against a generated data set.
+
+ @discussion An instance owns a scratch database holding rowCount
+ deterministic rows. Each -benchmark... method performs one pass
+ of its layer over the data set and is suitable for use inside
+ -[XCTestCase measureBlock:]. The class has no XCTest dependency
+ so that the same passes can be driven headlessly (e.g. under
+ GNUstep on Linux) via +runSuiteWithRowCounts:error:.
+ */
+@interface LabQLiteBenchmarks : NSObject
+
+/**
+ @abstract The number of rows in the generated data set.
+ */
+@property (nonatomic, readonly) NSUInteger rowCount;
+
+/**
+ @abstract The controller over the scratch database.
+ */
+@property (nonatomic, readonly) LabQLiteDatabaseController *controller;
+
+/**
+ @abstract The data set sizes to benchmark: the comma-separated
+ LABQLITE_BENCHMARK_ROW_COUNTS environment variable if set,
+ otherwise 1k, 100k and 1M rows.
+ */
++ (NSArray *)defaultRowCounts;
+
+/**
+ @abstract Generates a scratch database of rowCount rows in the
+ temporary directory and opens a controller over it.
+
+ @param error Standard error-capturing double
+ indirection pointer.
+ */
+- (instancetype)initWithRowCount:(NSUInteger)rowCount
+                           error:(NSError **)error;
+
+/**
+ @abstract Removes the scratch database.
+ */
+- (void)removeDatabase;
+
+#pragma mark - Layers
+
+/**
+ @abstract Prepares and finalizes the point-lookup statement
+ once per row.
+ */
+- (BOOL)benchmarkPrepare:(NSError **)error;
+
+/**
+ @abstract Binds every row's values to one prepared insertion
+ statement via -bindValues:withAffinityTypes:toStatement:error:,
+ resetting between rows. Nothing is stepped.
+ */
+- (BOOL)benchmarkBind:(NSError **)error;
+
+/**
+ @abstract Steps through and decodes the whole table via
+ -resultsFromPreparedStatement:error:.
+ */
+- (BOOL)benchmarkStepAndDecode:(NSError **)error;
+
+/**
+ @abstract Maps the already-decoded table onto
+ LabQLiteBenchmarkRow objects via KVC, as the controller does.
+ */
+- (BOOL)benchmarkMapping:(NSError **)error;
+
+/**
+ @abstract Generates the WHERE clause for a three-stipulation
+ query once per row.
+ */
+- (BOOL)benchmarkStipulationSQLGeneration:(NSError **)error;
+
+/**
+ @abstract Inserts rowCount objects into an empty copy of the
+ table in one transaction, then empties it again.
+ */
+- (BOOL)benchmarkBulkInsert:(NSError **)error;
+
+#pragma mark - Suite
+
+/**
+ @abstract Times one pass of every layer.
+
+ @return An array of result dictionaries, one per layer, or
+ nil if a layer failed.
+ */
+- (NSArray *)runAllLayers:(NSError **)error;
+
+/**
+ @abstract Generates a data set of each provided size, times
+ every layer against it and removes it again.
+ */
++ (NSArray *)runSuiteWithRowCounts:(NSArray *)rowCounts
+                             error:(NSError **)error;
+
+/**
+ @abstract Renders results as a fixed-width table.
+ */
++ (NSString *)reportForResults:(NSArray *)results;
+
+@end
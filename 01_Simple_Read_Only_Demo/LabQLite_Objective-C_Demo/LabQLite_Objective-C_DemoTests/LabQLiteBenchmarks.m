@@ -0,0 +1,469 @@
+/*
+ This is free and unencumbered software released into the public domain.
+ 
+ Anyone is free to copy, modify, publish, use, compile, sell, or
+ distribute this software, either in source code form or as a compiled
+ binary, for any purpose, commercial or non-commercial, and by any
+ means.
+ 
+ In jurisdictions that recognize copyright laws, the author or authors
+ of this software dedicate any and all copyright interest in the
+ software to the public domain. We make this dedication for the benefit
+ of the public at large and to the detriment of our heirs and
+ successors. We intend this dedication to be an overt act of
+ relinquishment in perpetuity of all present and future rights to this
+ software under copyright law.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ OTHER DEALINGS IN THE SOFTWARE.
+ 
+ For more information, please refer to <http://unlicense.org>
+ */
+
+#import <time.h>
+#import "LabQLiteBenchmarks.h"
+
+
+
+#pragma mark - Benchmark Result Keys
+
+NSString *const LabQLiteBenchmarkLayerKey                   = @"layer";
+NSString *const LabQLiteBenchmarkRowCountKey                = @"rowCount";
+NSString *const LabQLiteBenchmarkOperationsKey              = @"operations";
+NSString *const LabQLiteBenchmarkSecondsKey                 = @"seconds";
+NSString *const LabQLiteBenchmarkNanosecondsPerOperationKey = @"nanosecondsPerOperation";
+
+static NSString *const LabQLiteBenchmarkTableName          = @"benchmark_row";
+static NSString *const LabQLiteBenchmarkInsertionTableName = @"benchmark_row_insert";
+
+
+
+#pragma mark - Private LabQLite Methods Under Benchmark
+
+@interface LabQLiteDatabase (SQLStatementHelperMethods)
+
+- (int)resultCodeFromPreparingStatement:(NSString *)sqlStatement
+       addressOfLowLevelSQLiteStatement:(sqlite3_stmt **)address;
+
+- (BOOL)bindValues:(NSArray *)bindableValues
+ withAffinityTypes:(NSArray *)affinityTypes
+       toStatement:(sqlite3_stmt *)lowLevelStatement
+             error:(NSError **)error;
+
+- (NSArray *)resultsFromPreparedStatement:(sqlite3_stmt *)lowLevelSQLStatement
+                                    error:(NSError **)error;
+
+@end
+
+@interface LabQLiteDatabaseController (PrivateMethods)
+
+- (NSString *)appendStipulations:(NSArray *)arrayOfStipulations
+                     toSQLString:(NSString *)sqlString;
+
+@end
+
+static uint64_t LabQLiteBenchmarkNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+
+
+#pragma mark - Benchmark Rows
+
+@implementation LabQLiteBenchmarkRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = LabQLiteBenchmarkTableName;
+        _columnNames = @[@"id", @"name", @"weight", @"planted", @"notes"];
+        _propertyKeysMatchingAttributeColumns = @[@"benchmarkRowID", @"name", @"weight", @"planted", @"notes"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_TEXT,
+                                            SQLITE_AFFINITY_TYPE_REAL,
+                                            SQLITE_AFFINITY_TYPE_NUMERIC,
+                                            SQLITE_AFFINITY_TYPE_TEXT];
+    }
+    return self;
+}
+
+@end
+
+/**
+ @abstract Same columns as LabQLiteBenchmarkRow, mapped to the
+ initially empty table which the bulk insertion pass fills.
+ */
+@interface LabQLiteBenchmarkInsertionRow : LabQLiteBenchmarkRow
+@end
+
+@implementation LabQLiteBenchmarkInsertionRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = LabQLiteBenchmarkInsertionTableName;
+    }
+    return self;
+}
+
+@end
+
+
+
+#pragma mark - LabQLiteBenchmarks
+
+@interface LabQLiteBenchmarks () {
+    NSString *_databasePath;
+    NSArray *_bindableValueRows;
+    NSArray *_affinityTypes;
+    NSArray *_decodedRows;
+    NSArray *_insertionRows;
+    NSArray *_stipulations;
+}
+
++ (NSArray *)bindableValuesForRowAtIndex:(NSUInteger)index;
+
+- (BOOL)generateDatabase:(NSError **)error;
+
+@end
+
+@implementation LabQLiteBenchmarks
+
++ (NSArray *)defaultRowCounts {
+    NSString *configured = [[[NSProcessInfo processInfo] environment] objectForKey:@"LABQLITE_BENCHMARK_ROW_COUNTS"];
+    if ([configured length] == 0) {
+        return @[@1000, @100000, @1000000];
+    }
+    NSMutableArray *rowCounts = [NSMutableArray new];
+    for (NSString *component in [configured componentsSeparatedByString:@","]) {
+        long long rowCount = [component longLongValue];
+        if (rowCount > 0) {
+            [rowCounts addObject:[NSNumber numberWithLongLong:rowCount]];
+        }
+    }
+    return rowCounts;
+}
+
++ (NSArray *)bindableValuesForRowAtIndex:(NSUInteger)index {
+    NSNumber *rowID = [NSNumber numberWithUnsignedInteger:(index + 1)];
+    NSString *name = [NSString stringWithFormat:@"plant-%lu", (unsigned long)index];
+    NSNumber *weight = [NSNumber numberWithDouble:((index % 1000) * 0.25)];
+    NSString *planted = [NSString stringWithFormat:@"20%02lu-%02lu-%02lu",
+                         (unsigned long)(10 + index % 10),
+                         (unsigned long)(1 + index % 12),
+                         (unsigned long)(1 + index % 28)];
+    NSString *notes = [NSString stringWithFormat:@"note %lu for bed %lu", (unsigned long)index, (unsigned long)(index % 64)];
+    return @[rowID, name, weight, planted, notes];
+}
+
+- (instancetype)initWithRowCount:(NSUInteger)rowCount
+                           error:(NSError **)error {
+    self = [super init];
+    if (self) {
+        _rowCount = rowCount;
+        _databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                         [NSString stringWithFormat:@"labqlite-benchmark-%lu-%d.sqlite3",
+                          (unsigned long)rowCount, [[NSProcessInfo processInfo] processIdentifier]]];
+        _affinityTypes = [[LabQLiteBenchmarkRow new] columnTypesForAttributeColumns];
+        
+        NSMutableArray *bindableValueRows = [[NSMutableArray alloc] initWithCapacity:rowCount];
+        NSMutableArray *insertionRows = [[NSMutableArray alloc] initWithCapacity:rowCount];
+        NSArray *keys = [[LabQLiteBenchmarkRow new] propertyKeysMatchingAttributeColumns];
+        for (NSUInteger i = 0; i < rowCount; i++) {
+            NSArray *values = [LabQLiteBenchmarks bindableValuesForRowAtIndex:i];
+            LabQLiteBenchmarkInsertionRow *row = [LabQLiteBenchmarkInsertionRow new];
+            for (NSUInteger k = 0; k < [keys count]; k++) {
+                [row setValue:[values objectAtIndex:k] forKey:[keys objectAtIndex:k]];
+            }
+            [bindableValueRows addObject:values];
+            [insertionRows addObject:row];
+        }
+        _bindableValueRows = bindableValueRows;
+        _insertionRows = insertionRows;
+        
+        if (![self generateDatabase:error]) {
+            [self removeDatabase];
+            return nil;
+        }
+        
+        _controller = [[LabQLiteDatabaseController alloc] initWithDatabasePath:_databasePath
+                                                                         error:error];
+        if (!_controller) {
+            [self removeDatabase];
+            return nil;
+        }
+        
+        _decodedRows = [_controller processStatement:[NSString stringWithFormat:@"SELECT * FROM %@", LabQLiteBenchmarkTableName]
+                                      bindableValues:nil
+                                       affinityTypes:nil
+                                         insulatedly:YES
+                                               error:error];
+        if (!_decodedRows) {
+            [self removeDatabase];
+            return nil;
+        }
+        
+        _stipulations = @[[LabQLiteStipulation stipulationWithAttribute:@"name"
+                                                         binaryOperator:SQLite3BinaryOperatorEquals
+                                                                  value:@"plant-42"
+                                                               affinity:SQLITE_AFFINITY_TYPE_TEXT
+                                               precedingLogicalOperator:nil
+                                                                  error:error],
+                          [LabQLiteStipulation stipulationWithAttribute:@"weight"
+                                                         binaryOperator:SQLite3BinaryOperatorNotEquals
+                                                                  value:@"1.5"
+                                                               affinity:SQLITE_AFFINITY_TYPE_REAL
+                                               precedingLogicalOperator:SQLite3LogicalOperatorAND
+                                                                  error:error],
+                          [LabQLiteStipulation stipulationWithAttribute:@"notes"
+                                                         binaryOperator:SQLite3BinaryOperatorLike
+                                                                  value:@"note 4%"
+                                                               affinity:SQLITE_AFFINITY_TYPE_TEXT
+                                               precedingLogicalOperator:SQLite3LogicalOperatorOR
+                                                                  error:error]];
+    }
+    return self;
+}
+
+- (BOOL)generateDatabase:(NSError **)error {
+    [self removeDatabase];
+    
+    sqlite3 *database = NULL;
+    sqlite3_stmt *insertion = NULL;
+    int resultCode = sqlite3_open([_databasePath UTF8String], &database);
+    
+    NSString *schema = [NSString stringWithFormat:
+                        @"CREATE TABLE %1$@ (id INTEGER PRIMARY KEY, name TEXT, weight REAL, planted DATE, notes TEXT);"
+                        @"CREATE TABLE %2$@ (id INTEGER PRIMARY KEY, name TEXT, weight REAL, planted DATE, notes TEXT);"
+                        @"BEGIN TRANSACTION;",
+                        LabQLiteBenchmarkTableName, LabQLiteBenchmarkInsertionTableName];
+    if (resultCode == SQLITE_OK) {
+        resultCode = sqlite3_exec(database, [schema UTF8String], NULL, NULL, NULL);
+    }
+    if (resultCode == SQLITE_OK) {
+        NSString *sql = [NSString stringWithFormat:@"INSERT INTO %@ VALUES (?, ?, ?, ?, ?)", LabQLiteBenchmarkTableName];
+        resultCode = sqlite3_prepare_v2(database, [sql UTF8String], -1, &insertion, NULL);
+    }
+    for (NSUInteger i = 0; resultCode == SQLITE_OK && i < _rowCount; i++) {
+        NSArray *values = [_bindableValueRows objectAtIndex:i];
+        sqlite3_bind_int64(insertion, 1, [[values objectAtIndex:0] longLongValue]);
+        sqlite3_bind_text(insertion, 2, [[values objectAtIndex:1] UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(insertion, 3, [[values objectAtIndex:2] doubleValue]);
+        sqlite3_bind_text(insertion, 4, [[values objectAtIndex:3] UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertion, 5, [[values objectAtIndex:4] UTF8String], -1, SQLITE_TRANSIENT);
+        resultCode = sqlite3_step(insertion);
+        if (resultCode == SQLITE_DONE) {
+            resultCode = sqlite3_reset(insertion);
+        }
+    }
+    sqlite3_finalize(insertion);
+    if (resultCode == SQLITE_OK) {
+        resultCode = sqlite3_exec(database, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    }
+    
+    if (resultCode != SQLITE_OK) {
+        NSString *lowLevelErrorMessage = database ? [NSString stringWithUTF8String:sqlite3_errmsg(database)] : @"";
+        if (error != nil) {
+            *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                         code:resultCode
+                                     userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode],
+                                                @"errorDetails" : @{@"lowLevelErrorMessage" : lowLevelErrorMessage}}];
+        }
+        sqlite3_close(database);
+        return NO;
+    }
+    sqlite3_close(database);
+    return YES;
+}
+
+- (void)removeDatabase {
+    [[NSFileManager defaultManager] removeItemAtPath:_databasePath error:NULL];
+}
+
+
+
+#pragma mark - Layers
+
+- (BOOL)benchmarkPrepare:(NSError **)error {
+    LabQLiteDatabase *database = [_controller database];
+    NSString *sql = [NSString stringWithFormat:@"SELECT * FROM %@ WHERE id = ?", LabQLiteBenchmarkTableName];
+    if (![database openDatabase:error]) return NO;
+    for (NSUInteger i = 0; i < _rowCount; i++) {
+        sqlite3_stmt *statement = NULL;
+        int resultCode = [database resultCodeFromPreparingStatement:sql
+                                   addressOfLowLevelSQLiteStatement:&statement];
+        sqlite3_finalize(statement);
+        if (resultCode != SQLITE_OK) {
+            if (error != nil) {
+                *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                             code:resultCode
+                                         userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode]}];
+            }
+            [database closeDatabase:NULL];
+            return NO;
+        }
+    }
+    return [database closeDatabase:error];
+}
+
+- (BOOL)benchmarkBind:(NSError **)error {
+    LabQLiteDatabase *database = [_controller database];
+    NSString *sql = [NSString stringWithFormat:@"INSERT INTO %@ VALUES (?, ?, ?, ?, ?)", LabQLiteBenchmarkInsertionTableName];
+    if (![database openDatabase:error]) return NO;
+    sqlite3_stmt *statement = NULL;
+    int resultCode = [database resultCodeFromPreparingStatement:sql
+                               addressOfLowLevelSQLiteStatement:&statement];
+    BOOL bound = resultCode == SQLITE_OK;
+    if (!bound && error != nil) {
+        *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                     code:resultCode
+                                 userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode]}];
+    }
+    for (NSUInteger i = 0; bound && i < _rowCount; i++) {
+        bound = [database bindValues:[_bindableValueRows objectAtIndex:i]
+                   withAffinityTypes:_affinityTypes
+                         toStatement:statement
+                               error:error];
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+    }
+    sqlite3_finalize(statement);
+    return [database closeDatabase:(bound ? error : NULL)] && bound;
+}
+
+- (BOOL)benchmarkStepAndDecode:(NSError **)error {
+    LabQLiteDatabase *database = [_controller database];
+    NSString *sql = [NSString stringWithFormat:@"SELECT * FROM %@", LabQLiteBenchmarkTableName];
+    if (![database openDatabase:error]) return NO;
+    sqlite3_stmt *statement = NULL;
+    int resultCode = [database resultCodeFromPreparingStatement:sql
+                               addressOfLowLevelSQLiteStatement:&statement];
+    NSArray *results = nil;
+    if (resultCode == SQLITE_OK) {
+        results = [database resultsFromPreparedStatement:statement
+                                                   error:error];
+    }
+    else if (error != nil) {
+        *error = [NSError errorWithDomain:SQLITE3_LOW_LEVEL_ERROR_DOMAIN
+                                     code:resultCode
+                                 userInfo:@{@"errorMessage" : [LabQLiteDatabase errorMessageForCode:resultCode]}];
+    }
+    sqlite3_finalize(statement);
+    BOOL decoded = results != nil && [results count] == _rowCount;
+    return [database closeDatabase:(decoded ? error : NULL)] && decoded;
+}
+
+- (BOOL)benchmarkMapping:(NSError **)error {
+    // Same loop as -[LabQLiteDatabaseController allRows:SQLite3RowSubclass:error:]
+    NSMutableArray *normalizedRows = [[NSMutableArray alloc] initWithCapacity:[_decodedRows count]];
+    for (NSArray *array in _decodedRows) {
+        id <LabQLiteRowMappable> newRow = [[LabQLiteBenchmarkRow alloc] init];
+        for (NSString *key in [newRow propertyKeysMatchingAttributeColumns]) {
+            [(NSObject *)newRow setValue:[array objectAtIndex:[[newRow propertyKeysMatchingAttributeColumns] indexOfObject:key]]
+                                  forKey:key];
+        }
+        [normalizedRows addObject:newRow];
+    }
+    return [normalizedRows count] == _rowCount;
+}
+
+- (BOOL)benchmarkStipulationSQLGeneration:(NSError **)error {
+    NSString *base = [NSString stringWithFormat:@"SELECT * FROM %@", LabQLiteBenchmarkTableName];
+    for (NSUInteger i = 0; i < _rowCount; i++) {
+        NSString *sql = [_controller appendStipulations:_stipulations
+                                            toSQLString:base];
+        if ([sql length] <= [base length]) return NO;
+    }
+    return YES;
+}
+
+- (BOOL)benchmarkBulkInsert:(NSError **)error {
+    __block BOOL inserted = NO;
+    __block NSError *insertionError = nil;
+    [_controller insertRows:_insertionRows
+                  intoTable:LabQLiteBenchmarkInsertionTableName
+                 completion:^(BOOL success, NSError *err) {
+                     inserted = success;
+                     insertionError = err;
+                 }];
+    if (!inserted) {
+        if (error != nil) *error = insertionError;
+        return NO;
+    }
+    NSString *deletion = [NSString stringWithFormat:@"DELETE FROM %@", LabQLiteBenchmarkInsertionTableName];
+    return [_controller processStatement:deletion
+                          bindableValues:nil
+                           affinityTypes:nil
+                             insulatedly:YES
+                                   error:error] != nil;
+}
+
+
+
+#pragma mark - Suite
+
+- (NSArray *)runAllLayers:(NSError **)error {
+    NSArray *layers = @[@[@"prepare",         NSStringFromSelector(@selector(benchmarkPrepare:))],
+                        @[@"bind",            NSStringFromSelector(@selector(benchmarkBind:))],
+                        @[@"step+decode",     NSStringFromSelector(@selector(benchmarkStepAndDecode:))],
+                        @[@"kvc mapping",     NSStringFromSelector(@selector(benchmarkMapping:))],
+                        @[@"stipulation sql", NSStringFromSelector(@selector(benchmarkStipulationSQLGeneration:))],
+                        @[@"bulk insert",     NSStringFromSelector(@selector(benchmarkBulkInsert:))]];
+    NSMutableArray *results = [NSMutableArray new];
+    for (NSArray *layer in layers) {
+        SEL selector = NSSelectorFromString([layer objectAtIndex:1]);
+        BOOL (*pass)(id, SEL, NSError **) = (BOOL (*)(id, SEL, NSError **))[self methodForSelector:selector];
+        uint64_t start = LabQLiteBenchmarkNow();
+        BOOL succeeded = pass(self, selector, error);
+        uint64_t elapsed = LabQLiteBenchmarkNow() - start;
+        if (!succeeded) {
+            return nil;
+        }
+        NSUInteger operations = MAX(_rowCount, (NSUInteger)1);
+        [results addObject:@{LabQLiteBenchmarkLayerKey                   : [layer objectAtIndex:0],
+                             LabQLiteBenchmarkRowCountKey                : [NSNumber numberWithUnsignedInteger:_rowCount],
+                             LabQLiteBenchmarkOperationsKey              : [NSNumber numberWithUnsignedInteger:_rowCount],
+                             LabQLiteBenchmarkSecondsKey                 : [NSNumber numberWithDouble:(elapsed / 1e9)],
+                             LabQLiteBenchmarkNanosecondsPerOperationKey : [NSNumber numberWithDouble:((double)elapsed / operations)]}];
+    }
+    return results;
+}
+
++ (NSArray *)runSuiteWithRowCounts:(NSArray *)rowCounts
+                             error:(NSError **)error {
+    NSMutableArray *results = [NSMutableArray new];
+    for (NSNumber *rowCount in rowCounts) {
+        @autoreleasepool {
+            LabQLiteBenchmarks *benchmarks = [[LabQLiteBenchmarks alloc] initWithRowCount:[rowCount unsignedIntegerValue]
+                                                                                    error:error];
+            if (!benchmarks) return nil;
+            NSArray *layerResults = [benchmarks runAllLayers:error];
+            [benchmarks removeDatabase];
+            if (!layerResults) return nil;
+            [results addObjectsFromArray:layerResults];
+        }
+    }
+    return results;
+}
+
++ (NSString *)reportForResults:(NSArray *)results {
+    NSMutableString *report = [NSMutableString stringWithFormat:@"%-16s %10s %12s %14s\n",
+                               "layer", "rows", "seconds", "ns/op"];
+    for (NSDictionary *result in results) {
+        [report appendFormat:@"%-16s %10lu %12.4f %14.1f\n",
+         [[result objectForKey:LabQLiteBenchmarkLayerKey] UTF8String],
+         (unsigned long)[[result objectForKey:LabQLiteBenchmarkRowCountKey] unsignedIntegerValue],
+         [[result objectForKey:LabQLiteBenchmarkSecondsKey] doubleValue],
+         [[result objectForKey:LabQLiteBenchmarkNanosecondsPerOperationKey] doubleValue]];
+    }
+    return report;
+}
+
+@end
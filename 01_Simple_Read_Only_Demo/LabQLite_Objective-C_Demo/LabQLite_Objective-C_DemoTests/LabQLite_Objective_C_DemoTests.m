@@ -25,34 +25,110 @@
  For more information, please refer to <http://unlicense.org>
  */
 
+#import "LabQLiteBenchmarks.h"
+
+#if __has_include(<XCTest/XCTest.h>)
+
 #import <XCTest/XCTest.h>
 
 @interface LabQLite_Objective_C_DemoTests : XCTestCase
 
+@property (nonatomic) LabQLiteBenchmarks *benchmarks;
+
 @end
 
 @implementation LabQLite_Objective_C_DemoTests
 
 - (void)setUp {
     [super setUp];
-    // Put setup code here. This method is called before the invocation of each test method in the class.
+    // Each layer is measured against the smallest configured data set;
+    // testBenchmarkSuite covers every configured size.
+    NSError *error;
+    NSNumber *rowCount = [[LabQLiteBenchmarks defaultRowCounts] firstObject];
+    self.benchmarks = [[LabQLiteBenchmarks alloc] initWithRowCount:[rowCount unsignedIntegerValue]
+                                                             error:&error];
+    XCTAssertNotNil(self.benchmarks, @"%@", error);
 }
 
 - (void)tearDown {
-    // Put teardown code here. This method is called after the invocation of each test method in the class.
+    [self.benchmarks removeDatabase];
+    self.benchmarks = nil;
     [super tearDown];
 }
 
-- (void)testExample {
-    // This is an example of a functional test case.
-    // Use XCTAssert and related functions to verify your tests produce the correct results.
+- (void)testPrepare {
+    [self measureBlock:^{
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkPrepare:&error], @"%@", error);
+    }];
+}
+
+- (void)testBind {
+    [self measureBlock:^{
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkBind:&error], @"%@", error);
+    }];
 }
 
-- (void)testPerformanceExample {
-    // This is an example of a performance test case.
+- (void)testStepAndDecode {
     [self measureBlock:^{
-        // Put the code you want to measure the time of here.
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkStepAndDecode:&error], @"%@", error);
     }];
 }
 
+- (void)testMapping {
+    [self measureBlock:^{
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkMapping:&error], @"%@", error);
+    }];
+}
+
+- (void)testStipulationSQLGeneration {
+    [self measureBlock:^{
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkStipulationSQLGeneration:&error], @"%@", error);
+    }];
+}
+
+- (void)testBulkInsert {
+    [self measureBlock:^{
+        NSError *error;
+        XCTAssertTrue([self.benchmarks benchmarkBulkInsert:&error], @"%@", error);
+    }];
+}
+
+- (void)testBenchmarkSuite {
+    // The full suite takes minutes at the default sizes; it only
+    // runs in test runs which configure the sizes to measure.
+    if ([[[NSProcessInfo processInfo] environment] objectForKey:@"LABQLITE_BENCHMARK_ROW_COUNTS"] == nil) {
+        return;
+    }
+    NSError *error;
+    NSArray *results = [LabQLiteBenchmarks runSuiteWithRowCounts:[LabQLiteBenchmarks defaultRowCounts]
+                                                           error:&error];
+    XCTAssertNotNil(results, @"%@", error);
+    NSLog(@"\n%@", [LabQLiteBenchmarks reportForResults:results]);
+}
+
 @end
+
+#else
+
+// Headless entry point for platforms without XCTest (e.g. GNUstep
+// on Linux): runs the whole suite and prints the report.
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        NSError *error;
+        NSArray *results = [LabQLiteBenchmarks runSuiteWithRowCounts:[LabQLiteBenchmarks defaultRowCounts]
+                                                               error:&error];
+        if (!results) {
+            fprintf(stderr, "%s\n", [[error description] UTF8String]);
+            return 1;
+        }
+        printf("%s", [[LabQLiteBenchmarks reportForResults:results] UTF8String]);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "GardenDataGenerator.h"
+
+
+
+static void GardenGeneratorPrintUsage(const char *executable) {
+    fprintf(stderr,
+            "usage: %s --output PATH [options]\n"
+            "  --output PATH        database file to create (replaced if present)\n"
+            "  --schema PATH        schema script (default: ../LabQLite_Objective-C_Demo/Model/garden_database.sql)\n"
+            "  --scale F            scale factor; 1.0 = 1,000 plants, 100 gardens, 10,000 placements (default: 1.0)\n"
+            "  --seed N             generator seed (default: 1)\n"
+            "  --garden-skew S      Zipf exponent of garden popularity (default: 1.0)\n"
+            "  --type-skew S        Zipf exponent of common_type frequency (default: 1.2)\n"
+            "  --icon-bytes N       icon_image payload per plant, 0 for NULL (default: 0)\n",
+            executable);
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        GardenDataGenerator *generator = [GardenDataGenerator new];
+        NSString *schemaPath = @"../LabQLite_Objective-C_Demo/Model/garden_database.sql";
+        NSString *outputPath = nil;
+        
+        for (int i = 1; i < argc; i++) {
+            NSString *option = [NSString stringWithUTF8String:argv[i]];
+            if ([option isEqualToString:@"--help"] || [option isEqualToString:@"-h"] || i + 1 >= argc) {
+                GardenGeneratorPrintUsage(argv[0]);
+                return [option isEqualToString:@"--help"] || [option isEqualToString:@"-h"] ? 0 : 2;
+            }
+            NSString *value = [NSString stringWithUTF8String:argv[++i]];
+            if ([option isEqualToString:@"--output"]) {
+                outputPath = value;
+            }
+            else if ([option isEqualToString:@"--schema"]) {
+                schemaPath = value;
+            }
+            else if ([option isEqualToString:@"--scale"]) {
+                generator.scaleFactor = [value doubleValue];
+            }
+            else if ([option isEqualToString:@"--seed"]) {
+                generator.seed = (uint64_t)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--garden-skew"]) {
+                generator.gardenSkew = [value doubleValue];
+            }
+            else if ([option isEqualToString:@"--type-skew"]) {
+                generator.commonTypeSkew = [value doubleValue];
+            }
+            else if ([option isEqualToString:@"--icon-bytes"]) {
+                generator.iconImageLength = (NSUInteger)[value longLongValue];
+            }
+            else {
+                GardenGeneratorPrintUsage(argv[0]);
+                return 2;
+            }
+        }
+        if (outputPath == nil) {
+            GardenGeneratorPrintUsage(argv[0]);
+            return 2;
+        }
+        
+        NSError *error = nil;
+        NSDictionary *rowCounts = [generator generateDatabaseAtPath:outputPath
+                                                   fromSchemaAtPath:schemaPath
+                                                              error:&error];
+        if (rowCounts == nil) {
+            fprintf(stderr, "generation failed: %s\n", [[error description] UTF8String]);
+            return 1;
+        }
+        NSData *json = [NSJSONSerialization dataWithJSONObject:rowCounts
+                                                       options:NSJSONWritingPrettyPrinted
+                                                         error:&error];
+        fwrite([json bytes], 1, [json length], stdout);
+        fputc('\n', stdout);
+    }
+    return 0;
+}
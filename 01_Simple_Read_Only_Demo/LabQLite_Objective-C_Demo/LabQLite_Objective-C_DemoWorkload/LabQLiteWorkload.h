@@ -0,0 +1,183 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "LabQLiteDatabaseController.h"
+#import "LabQLiteRow.h"
+
+
+
+#pragma mark - Workload Operations
+
+/**
+ @abstract The operations a workload mixes.
+ */
+typedef enum {
+    LabQLiteWorkloadOperationPointRead = 0,
+    LabQLiteWorkloadOperationRangeScan,
+    LabQLiteWorkloadOperationBulkInsert,
+    LabQLiteWorkloadOperationUpdate,
+    LabQLiteWorkloadOperationDelete,
+    LabQLiteWorkloadOperationCount
+} LabQLiteWorkloadOperation;
+
+
+
+#pragma mark - Workload Row
+
+/**
+ @abstract Row of the `workload_row` table the driver reads
+ and writes.
+ */
+@interface LabQLiteWorkloadRow : LabQLiteRow
+
+@property (nonatomic) NSNumber *workloadRowID;
+@property (nonatomic) NSString *name;
+@property (nonatomic) NSNumber *weight;
+@property (nonatomic) NSString *planted;
+@property (nonatomic) NSString *notes;
+
+/**
+ @abstract A row whose values are derived from its id only.
+ */
++ (LabQLiteWorkloadRow *)rowWithID:(uint64_t)rowID
+                          revision:(uint64_t)revision;
+
+@end
+
+
+
+#pragma mark - LabQLiteWorkload Class
+
+/**
+ @abstract Drives a configurable mix of point reads, range scans,
+ bulk inserts, updates and deletes through LabQLiteDatabaseController
+ from several threads, and reports throughput and latency
+ percentiles.
+
+ @discussion Each thread gets its own controller (and therefore its
+ own connection) over the same database file. Keys are drawn
+ uniformly from the ids handed out so far with a per-thread seeded
+ generator, so a run is reproducible given its seed, thread count
+ and operation budget.
+ */
+@interface LabQLiteWorkload : NSObject
+
+/**
+ @abstract Path of the database file. Replaced by a freshly
+ generated database by -prepareDatabase:.
+ */
+@property (nonatomic) NSString *databasePath;
+
+/**
+ @abstract Rows loaded before the run. Defaults to 100000.
+ */
+@property (nonatomic) NSUInteger initialRowCount;
+
+/**
+ @abstract Worker threads. Defaults to 4.
+ */
+@property (nonatomic) NSUInteger threadCount;
+
+/**
+ @abstract Seconds to run for. Ignored when operationsPerThread
+ is non-zero. Defaults to 10.
+ */
+@property (nonatomic) NSTimeInterval duration;
+
+/**
+ @abstract Operations each thread performs, or zero to run for
+ duration instead. Defaults to zero.
+ */
+@property (nonatomic) NSUInteger operationsPerThread;
+
+/**
+ @abstract Rows returned by one range scan. Defaults to 100.
+ */
+@property (nonatomic) NSUInteger rangeScanLength;
+
+/**
+ @abstract Rows inserted by one bulk insert. Defaults to 100.
+ */
+@property (nonatomic) NSUInteger bulkInsertBatchSize;
+
+/**
+ @abstract Milliseconds a statement waits on another thread's
+ lock. Defaults to 5000.
+ */
+@property (nonatomic) int busyTimeout;
+
+/**
+ @abstract Seed of the key and operation generators.
+ */
+@property (nonatomic) uint64_t seed;
+
+/**
+ @abstract The name used for an operation in mixes and reports
+ (e.g. `point_read`).
+ */
++ (NSString *)nameOfOperation:(LabQLiteWorkloadOperation)operation;
+
+/**
+ @abstract Sets the relative weight of an operation in the mix.
+ The default mix is 70 point reads, 10 range scans, 10 bulk
+ inserts, 7 updates and 3 deletes.
+ */
+- (void)setWeight:(double)weight
+     forOperation:(LabQLiteWorkloadOperation)operation;
+
+/**
+ @abstract Parses a mix such as `point_read=90,update=10`.
+ Operations which are not mentioned get a weight of zero.
+
+ @return Whether the mix was understood.
+ */
+- (BOOL)setMixFromString:(NSString *)mix;
+
+/**
+ @abstract Creates the database at databasePath and loads
+ initialRowCount rows.
+
+ @param error Standard error-capturing double
+ indirection pointer.
+ */
+- (BOOL)prepareDatabase:(NSError **)error;
+
+/**
+ @abstract Runs the workload.
+
+ @param error Standard error-capturing double
+ indirection pointer.
+
+ @return A JSON-serializable report: the configuration, overall
+ throughput and, per operation, count, errors, throughput and
+ latency percentiles in microseconds, followed by the
+ LabQLiteMetrics counters.
+ */
+- (NSDictionary *)run:(NSError **)error;
+
+@end
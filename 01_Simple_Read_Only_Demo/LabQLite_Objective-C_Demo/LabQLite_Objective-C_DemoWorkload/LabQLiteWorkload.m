@@ -0,0 +1,461 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <dispatch/dispatch.h>
+#import <stdatomic.h>
+#import <time.h>
+#import "LabQLiteWorkload.h"
+#import "LabQLiteMetrics.h"
+
+
+
+static NSString *const LabQLiteWorkloadTableName = @"workload_row";
+
+/**
+ @abstract Rows per transaction while loading the initial data set.
+ */
+static NSUInteger const LabQLiteWorkloadLoadBatchSize = 10000;
+
+static uint64_t LabQLiteWorkloadNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ @abstract xorshift64* step; state must be non-zero.
+ */
+static uint64_t LabQLiteWorkloadNextRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+
+
+#pragma mark - Workload Row
+
+@implementation LabQLiteWorkloadRow
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _tableName = LabQLiteWorkloadTableName;
+        _columnNames = @[@"id", @"name", @"weight", @"planted", @"notes"];
+        _propertyKeysMatchingAttributeColumns = @[@"workloadRowID", @"name", @"weight", @"planted", @"notes"];
+        _columnTypesForAttributeColumns = @[SQLITE_AFFINITY_TYPE_INTEGER,
+                                            SQLITE_AFFINITY_TYPE_TEXT,
+                                            SQLITE_AFFINITY_TYPE_REAL,
+                                            SQLITE_AFFINITY_TYPE_NUMERIC,
+                                            SQLITE_AFFINITY_TYPE_TEXT];
+    }
+    return self;
+}
+
++ (LabQLiteWorkloadRow *)rowWithID:(uint64_t)rowID
+                          revision:(uint64_t)revision {
+    LabQLiteWorkloadRow *row = [LabQLiteWorkloadRow new];
+    row.workloadRowID = [NSNumber numberWithUnsignedLongLong:rowID];
+    row.name = [NSString stringWithFormat:@"plant-%llu", rowID];
+    row.weight = [NSNumber numberWithDouble:(((rowID + revision) % 1000) * 0.25)];
+    row.planted = [NSString stringWithFormat:@"20%02llu-%02llu-%02llu",
+                   10 + rowID % 10, 1 + rowID % 12, 1 + rowID % 28];
+    row.notes = [NSString stringWithFormat:@"note %llu, revision %llu", rowID, revision];
+    return row;
+}
+
+@end
+
+
+
+#pragma mark - Worker
+
+/**
+ @abstract Per-thread state: a private controller, generator
+ and results, so workers share nothing but the row id counter.
+ */
+@interface LabQLiteWorkloadWorker : NSObject {
+@public
+    uint64_t _randomState;
+    uint64_t _errors[LabQLiteWorkloadOperationCount];
+}
+
+@property (nonatomic) LabQLiteDatabaseController *controller;
+@property (nonatomic) NSArray *histograms;
+@property (nonatomic) NSError *firstError;
+
+@end
+
+@implementation LabQLiteWorkloadWorker
+@end
+
+
+
+#pragma mark - LabQLiteWorkload
+
+@interface LabQLiteWorkload () {
+    double _weights[LabQLiteWorkloadOperationCount];
+    atomic_uint_fast64_t _nextRowID;
+    uint64_t _deadline;
+    dispatch_group_t _workers;
+}
+
+- (void)runWorker:(LabQLiteWorkloadWorker *)worker;
+
+- (BOOL)performOperation:(LabQLiteWorkloadOperation)operation
+                  worker:(LabQLiteWorkloadWorker *)worker
+                   error:(NSError **)error;
+
+- (LabQLiteStipulation *)stipulationMatchingRowID:(uint64_t)rowID
+                                            error:(NSError **)error;
+
+- (NSDictionary *)configuration;
+
+@end
+
+@implementation LabQLiteWorkload
+
++ (NSString *)nameOfOperation:(LabQLiteWorkloadOperation)operation {
+    switch (operation) {
+        case LabQLiteWorkloadOperationPointRead:  return @"point_read";
+        case LabQLiteWorkloadOperationRangeScan:  return @"range_scan";
+        case LabQLiteWorkloadOperationBulkInsert: return @"bulk_insert";
+        case LabQLiteWorkloadOperationUpdate:     return @"update";
+        case LabQLiteWorkloadOperationDelete:     return @"delete";
+        default:                                  return nil;
+    }
+}
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        _databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"labqlite-workload.sqlite3"];
+        _initialRowCount = 100000;
+        _threadCount = 4;
+        _duration = 10;
+        _rangeScanLength = 100;
+        _bulkInsertBatchSize = 100;
+        _busyTimeout = 5000;
+        _seed = 42;
+        _weights[LabQLiteWorkloadOperationPointRead] = 70;
+        _weights[LabQLiteWorkloadOperationRangeScan] = 10;
+        _weights[LabQLiteWorkloadOperationBulkInsert] = 10;
+        _weights[LabQLiteWorkloadOperationUpdate] = 7;
+        _weights[LabQLiteWorkloadOperationDelete] = 3;
+    }
+    return self;
+}
+
+- (void)setWeight:(double)weight
+     forOperation:(LabQLiteWorkloadOperation)operation {
+    if (operation < LabQLiteWorkloadOperationCount && weight >= 0) {
+        _weights[operation] = weight;
+    }
+}
+
+- (BOOL)setMixFromString:(NSString *)mix {
+    double weights[LabQLiteWorkloadOperationCount] = {0};
+    double totalWeight = 0;
+    for (NSString *component in [mix componentsSeparatedByString:@","]) {
+        NSArray *pair = [component componentsSeparatedByString:@"="];
+        if ([pair count] != 2) return NO;
+        NSString *name = [[pair objectAtIndex:0] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        double weight = [[pair objectAtIndex:1] doubleValue];
+        int operation = 0;
+        while (operation < LabQLiteWorkloadOperationCount &&
+               ![[LabQLiteWorkload nameOfOperation:(LabQLiteWorkloadOperation)operation] isEqualToString:name]) {
+            operation++;
+        }
+        if (operation == LabQLiteWorkloadOperationCount || weight < 0) return NO;
+        weights[operation] = weight;
+        totalWeight += weight;
+    }
+    if (totalWeight <= 0) return NO;
+    memcpy(_weights, weights, sizeof(_weights));
+    return YES;
+}
+
+- (BOOL)prepareDatabase:(NSError **)error {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    [fileManager removeItemAtPath:_databasePath error:NULL];
+    [fileManager removeItemAtPath:[_databasePath stringByAppendingString:@"-journal"] error:NULL];
+    
+    LabQLiteDatabaseController *controller = [[LabQLiteDatabaseController alloc] initWithDatabasePath:_databasePath
+                                                                                               error:error];
+    if (!controller) return NO;
+    
+    NSString *schema = [NSString stringWithFormat:@"CREATE TABLE %@ (id INTEGER PRIMARY KEY, name TEXT, weight REAL, planted DATE, notes TEXT)",
+                        LabQLiteWorkloadTableName];
+    if (![controller processStatement:schema
+                       bindableValues:nil
+                        affinityTypes:nil
+                          insulatedly:YES
+                                error:error]) {
+        return NO;
+    }
+    
+    for (NSUInteger first = 1; first <= _initialRowCount; first += LabQLiteWorkloadLoadBatchSize) {
+        @autoreleasepool {
+            NSUInteger last = MIN(first + LabQLiteWorkloadLoadBatchSize - 1, _initialRowCount);
+            NSMutableArray *rows = [[NSMutableArray alloc] initWithCapacity:(last - first + 1)];
+            for (NSUInteger rowID = first; rowID <= last; rowID++) {
+                [rows addObject:[LabQLiteWorkloadRow rowWithID:rowID revision:0]];
+            }
+            __block BOOL inserted = NO;
+            __block NSError *insertionError = nil;
+            [controller insertRows:rows
+                         intoTable:LabQLiteWorkloadTableName
+                        completion:^(BOOL success, NSError *err) {
+                            inserted = success;
+                            insertionError = err;
+                        }];
+            if (!inserted) {
+                if (error != nil) *error = insertionError;
+                return NO;
+            }
+        }
+    }
+    atomic_store(&_nextRowID, (uint_fast64_t)_initialRowCount + 1);
+    return YES;
+}
+
+- (NSDictionary *)run:(NSError **)error {
+    if (atomic_load(&_nextRowID) == 0 && ![self prepareDatabase:error]) {
+        return nil;
+    }
+    
+    NSUInteger threadCount = MAX(_threadCount, (NSUInteger)1);
+    NSMutableArray *workers = [[NSMutableArray alloc] initWithCapacity:threadCount];
+    for (NSUInteger i = 0; i < threadCount; i++) {
+        LabQLiteWorkloadWorker *worker = [LabQLiteWorkloadWorker new];
+        worker.controller = [[LabQLiteDatabaseController alloc] initWithDatabasePath:_databasePath
+                                                                               error:error];
+        if (!worker.controller) return nil;
+        [[worker.controller database] setBusyTimeout:_busyTimeout];
+        NSMutableArray *histograms = [NSMutableArray new];
+        for (int operation = 0; operation < LabQLiteWorkloadOperationCount; operation++) {
+            [histograms addObject:[LabQLiteLatencyHistogram new]];
+        }
+        worker.histograms = histograms;
+        worker->_randomState = (_seed ^ (0x9E3779B97F4A7C15ull * (i + 1))) | 1;
+        [workers addObject:worker];
+    }
+    
+    [LabQLiteMetrics reset];
+    _workers = dispatch_group_create();
+    uint64_t start = LabQLiteWorkloadNow();
+    _deadline = start + (uint64_t)(_duration * 1e9);
+    for (LabQLiteWorkloadWorker *worker in workers) {
+        dispatch_group_enter(_workers);
+        [NSThread detachNewThreadSelector:@selector(runWorker:)
+                                 toTarget:self
+                               withObject:worker];
+    }
+    dispatch_group_wait(_workers, DISPATCH_TIME_FOREVER);
+    double elapsedSeconds = (LabQLiteWorkloadNow() - start) / 1e9;
+    
+    // Combine the per-thread results
+    NSMutableDictionary *operations = [NSMutableDictionary new];
+    uint64_t operationsTotal = 0;
+    uint64_t errorsTotal = 0;
+    NSError *firstError = nil;
+    for (int operation = 0; operation < LabQLiteWorkloadOperationCount; operation++) {
+        LabQLiteLatencyHistogram *latencies = [LabQLiteLatencyHistogram new];
+        uint64_t errors = 0;
+        for (LabQLiteWorkloadWorker *worker in workers) {
+            [latencies addHistogram:[worker.histograms objectAtIndex:operation]];
+            errors += worker->_errors[operation];
+            if (firstError == nil) firstError = worker.firstError;
+        }
+        if (_weights[operation] == 0 && [latencies count] == 0 && errors == 0) continue;
+        operationsTotal += [latencies count];
+        errorsTotal += errors;
+        double mean = [latencies count] > 0 ? (double)[latencies totalValue] / [latencies count] : 0;
+        NSDictionary *latency = @{@"mean" : [NSNumber numberWithDouble:(mean / 1000.0)],
+                                  @"p50"  : [NSNumber numberWithDouble:([latencies valueAtPercentile:50.0] / 1000.0)],
+                                  @"p90"  : [NSNumber numberWithDouble:([latencies valueAtPercentile:90.0] / 1000.0)],
+                                  @"p95"  : [NSNumber numberWithDouble:([latencies valueAtPercentile:95.0] / 1000.0)],
+                                  @"p99"  : [NSNumber numberWithDouble:([latencies valueAtPercentile:99.0] / 1000.0)],
+                                  @"p999" : [NSNumber numberWithDouble:([latencies valueAtPercentile:99.9] / 1000.0)],
+                                  @"max"  : [NSNumber numberWithDouble:([latencies maxValue] / 1000.0)]};
+        [operations setObject:@{@"count"                     : [NSNumber numberWithUnsignedLongLong:[latencies count]],
+                                @"errors"                    : [NSNumber numberWithUnsignedLongLong:errors],
+                                @"throughput_ops_per_second" : [NSNumber numberWithDouble:([latencies count] / elapsedSeconds)],
+                                @"latency_us"                : latency}
+                       forKey:[LabQLiteWorkload nameOfOperation:(LabQLiteWorkloadOperation)operation]];
+    }
+    
+    NSMutableDictionary *report = [@{@"configuration"             : [self configuration],
+                                     @"elapsed_seconds"           : [NSNumber numberWithDouble:elapsedSeconds],
+                                     @"operations_total"          : [NSNumber numberWithUnsignedLongLong:operationsTotal],
+                                     @"errors_total"              : [NSNumber numberWithUnsignedLongLong:errorsTotal],
+                                     @"throughput_ops_per_second" : [NSNumber numberWithDouble:(operationsTotal / elapsedSeconds)],
+                                     @"operations"                : operations,
+                                     @"metrics"                   : [LabQLiteMetrics snapshot]} mutableCopy];
+    if (firstError != nil) {
+        [report setObject:[firstError description] forKey:@"first_error"];
+    }
+    return report;
+}
+
+- (void)runWorker:(LabQLiteWorkloadWorker *)worker {
+    @autoreleasepool {
+        double totalWeight = 0;
+        for (int operation = 0; operation < LabQLiteWorkloadOperationCount; operation++) {
+            totalWeight += _weights[operation];
+        }
+        for (NSUInteger performed = 0; ; performed++) {
+            if (_operationsPerThread > 0 ? performed >= _operationsPerThread : LabQLiteWorkloadNow() >= _deadline) {
+                break;
+            }
+            @autoreleasepool {
+                // Pick an operation according to the mix
+                double pick = (LabQLiteWorkloadNextRandom(&worker->_randomState) >> 11) * 0x1.0p-53 * totalWeight;
+                int operation = 0;
+                while (operation < LabQLiteWorkloadOperationCount - 1 && pick >= _weights[operation]) {
+                    pick -= _weights[operation];
+                    operation++;
+                }
+                
+                NSError *error = nil;
+                uint64_t start = LabQLiteWorkloadNow();
+                BOOL succeeded = [self performOperation:(LabQLiteWorkloadOperation)operation
+                                                 worker:worker
+                                                  error:&error];
+                uint64_t elapsed = LabQLiteWorkloadNow() - start;
+                if (succeeded) {
+                    [[worker.histograms objectAtIndex:operation] recordValue:elapsed];
+                }
+                else {
+                    worker->_errors[operation]++;
+                    if (worker.firstError == nil) worker.firstError = error;
+                }
+            }
+        }
+    }
+    dispatch_group_leave(_workers);
+}
+
+- (BOOL)performOperation:(LabQLiteWorkloadOperation)operation
+                  worker:(LabQLiteWorkloadWorker *)worker
+                   error:(NSError **)error {
+    LabQLiteDatabaseController *controller = worker.controller;
+    uint64_t highestRowID = atomic_load_explicit(&_nextRowID, memory_order_relaxed) - 1;
+    uint64_t rowID = 1 + LabQLiteWorkloadNextRandom(&worker->_randomState) % MAX(highestRowID, (uint64_t)1);
+    
+    switch (operation) {
+        case LabQLiteWorkloadOperationPointRead: {
+            LabQLiteStipulation *stipulation = [self stipulationMatchingRowID:rowID error:error];
+            return stipulation != nil && [controller rowsFromTable:LabQLiteWorkloadTableName
+                                         asSQLite3RowsWithSubclass:[LabQLiteWorkloadRow class]
+                                                      stipulations:@[stipulation]
+                                                            offset:0
+                                        andMaxNumberOfRowsToReturn:1
+                                                         orderedBy:nil
+                                                             error:error] != nil;
+        }
+        case LabQLiteWorkloadOperationRangeScan: {
+            // Stipulations only offer =, != and LIKE, so the range
+            // is expressed directly.
+            NSString *scan = [NSString stringWithFormat:@"SELECT * FROM %@ WHERE id BETWEEN ? AND ?", LabQLiteWorkloadTableName];
+            return [controller processStatement:scan
+                                 bindableValues:@[[NSNumber numberWithUnsignedLongLong:rowID],
+                                                  [NSNumber numberWithUnsignedLongLong:(rowID + _rangeScanLength - 1)]]
+                                  affinityTypes:@[SQLITE_AFFINITY_TYPE_INTEGER, SQLITE_AFFINITY_TYPE_INTEGER]
+                                    insulatedly:YES
+                                          error:error] != nil;
+        }
+        case LabQLiteWorkloadOperationBulkInsert: {
+            NSUInteger batchSize = MAX(_bulkInsertBatchSize, (NSUInteger)1);
+            uint64_t firstRowID = atomic_fetch_add_explicit(&_nextRowID, batchSize, memory_order_relaxed);
+            NSMutableArray *rows = [[NSMutableArray alloc] initWithCapacity:batchSize];
+            for (NSUInteger i = 0; i < batchSize; i++) {
+                [rows addObject:[LabQLiteWorkloadRow rowWithID:(firstRowID + i) revision:0]];
+            }
+            __block BOOL inserted = NO;
+            __block NSError *insertionError = nil;
+            [controller insertRows:rows
+                         intoTable:LabQLiteWorkloadTableName
+                        completion:^(BOOL success, NSError *err) {
+                            inserted = success;
+                            insertionError = err;
+                        }];
+            if (!inserted && error != nil) *error = insertionError;
+            return inserted;
+        }
+        case LabQLiteWorkloadOperationUpdate: {
+            LabQLiteStipulation *stipulation = [self stipulationMatchingRowID:rowID error:error];
+            LabQLiteWorkloadRow *row = [LabQLiteWorkloadRow rowWithID:rowID
+                                                             revision:LabQLiteWorkloadNextRandom(&worker->_randomState) % 1000];
+            return stipulation != nil && [controller updateRow:row
+                                                            to:row
+                                                         where:@[stipulation]
+                                                         error:error];
+        }
+        case LabQLiteWorkloadOperationDelete: {
+            LabQLiteStipulation *stipulation = [self stipulationMatchingRowID:rowID error:error];
+            return stipulation != nil && [controller deleteRowsFromTable:LabQLiteWorkloadTableName
+                                                        withStipulations:@[stipulation]
+                                                                   error:error];
+        }
+        default:
+            return NO;
+    }
+}
+
+- (LabQLiteStipulation *)stipulationMatchingRowID:(uint64_t)rowID
+                                            error:(NSError **)error {
+    return [LabQLiteStipulation stipulationWithAttribute:@"id"
+                                          binaryOperator:SQLite3BinaryOperatorEquals
+                                                   value:[NSString stringWithFormat:@"%llu", rowID]
+                                                affinity:SQLITE_AFFINITY_TYPE_INTEGER
+                                precedingLogicalOperator:nil
+                                                   error:error];
+}
+
+- (NSDictionary *)configuration {
+    NSMutableDictionary *mix = [NSMutableDictionary new];
+    for (int operation = 0; operation < LabQLiteWorkloadOperationCount; operation++) {
+        [mix setObject:[NSNumber numberWithDouble:_weights[operation]]
+                forKey:[LabQLiteWorkload nameOfOperation:(LabQLiteWorkloadOperation)operation]];
+    }
+    return @{@"database"               : _databasePath,
+             @"initial_rows"           : [NSNumber numberWithUnsignedInteger:_initialRowCount],
+             @"threads"                : [NSNumber numberWithUnsignedInteger:_threadCount],
+             @"duration_seconds"       : [NSNumber numberWithDouble:_duration],
+             @"operations_per_thread"  : [NSNumber numberWithUnsignedInteger:_operationsPerThread],
+             @"range_scan_length"      : [NSNumber numberWithUnsignedInteger:_rangeScanLength],
+             @"bulk_insert_batch_size" : [NSNumber numberWithUnsignedInteger:_bulkInsertBatchSize],
+             @"busy_timeout_ms"        : [NSNumber numberWithInt:_busyTimeout],
+             @"seed"                   : [NSNumber numberWithUnsignedLongLong:_seed],
+             @"mix"                    : mix};
+}
+
+@end
@@ -0,0 +1,137 @@
+/**
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org>
+ */
+
+#import <Foundation/Foundation.h>
+#import "LabQLiteWorkload.h"
+
+
+
+static void LabQLiteWorkloadPrintUsage(const char *executable) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --database PATH      database file to generate (default: $TMPDIR/labqlite-workload.sqlite3)\n"
+            "  --rows N             rows loaded before the run (default: 100000)\n"
+            "  --threads N          worker threads, one connection each (default: 4)\n"
+            "  --duration SECONDS   how long to run (default: 10)\n"
+            "  --operations N       operations per thread; overrides --duration\n"
+            "  --mix SPEC           weights, e.g. point_read=70,range_scan=10,bulk_insert=10,update=7,delete=3\n"
+            "  --scan-length N      rows per range scan (default: 100)\n"
+            "  --batch-size N       rows per bulk insert (default: 100)\n"
+            "  --busy-timeout MS    wait on locks held by other threads (default: 5000)\n"
+            "  --seed N             generator seed (default: 42)\n"
+            "  --output PATH        write the JSON report to PATH instead of stdout\n",
+            executable);
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        LabQLiteWorkload *workload = [LabQLiteWorkload new];
+        NSString *outputPath = nil;
+        
+        for (int i = 1; i < argc; i++) {
+            NSString *option = [NSString stringWithUTF8String:argv[i]];
+            if ([option isEqualToString:@"--help"] || [option isEqualToString:@"-h"]) {
+                LabQLiteWorkloadPrintUsage(argv[0]);
+                return 0;
+            }
+            if (i + 1 >= argc) {
+                LabQLiteWorkloadPrintUsage(argv[0]);
+                return 2;
+            }
+            NSString *value = [NSString stringWithUTF8String:argv[++i]];
+            if ([option isEqualToString:@"--database"]) {
+                workload.databasePath = value;
+            }
+            else if ([option isEqualToString:@"--rows"]) {
+                workload.initialRowCount = (NSUInteger)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--threads"]) {
+                workload.threadCount = (NSUInteger)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--duration"]) {
+                workload.duration = [value doubleValue];
+            }
+            else if ([option isEqualToString:@"--operations"]) {
+                workload.operationsPerThread = (NSUInteger)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--mix"]) {
+                if (![workload setMixFromString:value]) {
+                    fprintf(stderr, "invalid mix: %s\n", [value UTF8String]);
+                    return 2;
+                }
+            }
+            else if ([option isEqualToString:@"--scan-length"]) {
+                workload.rangeScanLength = (NSUInteger)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--batch-size"]) {
+                workload.bulkInsertBatchSize = (NSUInteger)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--busy-timeout"]) {
+                workload.busyTimeout = [value intValue];
+            }
+            else if ([option isEqualToString:@"--seed"]) {
+                workload.seed = (uint64_t)[value longLongValue];
+            }
+            else if ([option isEqualToString:@"--output"]) {
+                outputPath = value;
+            }
+            else {
+                LabQLiteWorkloadPrintUsage(argv[0]);
+                return 2;
+            }
+        }
+        
+        NSError *error = nil;
+        NSDictionary *report = nil;
+        if ([workload prepareDatabase:&error]) {
+            report = [workload run:&error];
+        }
+        if (report == nil) {
+            fprintf(stderr, "workload failed: %s\n", [[error description] UTF8String]);
+            return 1;
+        }
+        
+        NSData *json = [NSJSONSerialization dataWithJSONObject:report
+                                                       options:NSJSONWritingPrettyPrinted
+                                                         error:&error];
+        if (json == nil) {
+            fprintf(stderr, "could not serialize report: %s\n", [[error description] UTF8String]);
+            return 1;
+        }
+        if (outputPath != nil) {
+            if (![json writeToFile:outputPath options:NSDataWritingAtomic error:&error]) {
+                fprintf(stderr, "could not write %s: %s\n", [outputPath UTF8String], [[error description] UTF8String]);
+                return 1;
+            }
+        }
+        else {
+            fwrite([json bytes], 1, [json length], stdout);
+            fputc('\n', stdout);
+        }
+    }
+    return 0;
+}